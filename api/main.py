@@ -51,6 +51,14 @@ _socket_lock = threading.Lock()
 _socket_cache: Dict[str, Tuple[float, Any]] = {}
 _SOCKET_CACHE_TTL = 5.0
 
+# Comandos revalidados a cada chamada com "IF-NEWER": o daemon responde
+# STATUS 304 (corpo de poucos bytes) enquanto a versão não muda
+_CONDITIONAL_COMMANDS = {
+    "GET CURRENT": "seq",
+    "GET DYNAMIC": "seq",
+    "GET STATIC": "generation_id",
+}
+
 
 def first_numeric(d: Dict[str, Any], keys: List[str]) -> Optional[float]:
     for k in keys:
@@ -63,57 +71,95 @@ def first_numeric(d: Dict[str, Any], keys: List[str]) -> Optional[float]:
     return None
 
 
-def send_command(command: str) -> Dict[str, Any]:
-    with _socket_lock:
-        now = time.time()
-        if command in _socket_cache:
-            ts, cached = _socket_cache[command]
-            if now - ts < _SOCKET_CACHE_TTL:
-                return cached
-
-        path = sfp_socket_path()
-        timeout = float(os.getenv("SFP_SOCKET_TIMEOUT", "3"))
-        last_exc: Exception = RuntimeError("no attempts")
-        data = ""
-        for attempt in range(3):
-            try:
-                with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as s:
-                    s.settimeout(timeout)
-                    s.connect(path)
-                    s.sendall((command + "\n").encode("utf-8"))
-                    chunks: List[bytes] = []
-                    while True:
-                        b = s.recv(4096)
-                        if not b:
-                            break
-                        chunks.append(b)
-                        if b.endswith(b"\n"):
-                            break
-                    data = b"".join(chunks).decode("utf-8", errors="replace")
-                break
-            except (FileNotFoundError, ConnectionRefusedError, TimeoutError, socket.error, BlockingIOError) as e:
-                last_exc = e
-                if attempt < 2:
-                    time.sleep(0.3 * (attempt + 1))
-        else:
-            raise HTTPException(status_code=503, detail=f"Socket error: {last_exc}")
-
-        lines = data.split("\n", 1)
-        if not lines:
-            raise HTTPException(status_code=502, detail="Empty daemon response")
-        status_line = lines[0].strip()
-        body = lines[1] if len(lines) > 1 else ""
-        if not body.strip():
-            raise HTTPException(status_code=502, detail="Missing JSON body")
+def _recv_framed_responses(s: socket.socket, count: int) -> List[Dict[str, Any]]:
+    """
+    Lê `count` respostas no modo FRAMING LENGTH: a status line termina com o
+    tamanho exato do corpo (JSON + "\\n"), lido sem esperar timeout.
+    """
+    buf = b""
+    payloads: List[Dict[str, Any]] = []
+    while len(payloads) < count:
+        nl = buf.find(b"\n")
+        if nl < 0:
+            chunk = s.recv(4096)
+            if not chunk:
+                raise HTTPException(status_code=502, detail="Empty daemon response")
+            buf += chunk
+            continue
+        parts = buf[:nl].decode("utf-8", errors="replace").split()
+        if len(parts) < 3 or parts[0] != "STATUS" or not parts[-1].isdigit():
+            raise HTTPException(status_code=502, detail="Invalid status line")
+        end = nl + 1 + int(parts[-1])
+        while len(buf) < end:
+            chunk = s.recv(max(4096, end - len(buf)))
+            if not chunk:
+                raise HTTPException(status_code=502, detail="Missing JSON body")
+            buf += chunk
         try:
-            payload = json.loads(body)
+            payloads.append(json.loads(buf[nl + 1:end]))
         except json.JSONDecodeError:
             raise HTTPException(status_code=502, detail="Invalid JSON from daemon")
-        if not status_line.startswith("STATUS"):
-            raise HTTPException(status_code=502, detail="Invalid status line")
+        buf = buf[end:]
+    return payloads
 
-        _socket_cache[command] = (time.time(), payload)
-        return payload
+
+def send_commands(commands: List[str]) -> List[Dict[str, Any]]:
+    """
+    Envia vários comandos ao daemon em um único write (pipelining) e
+    devolve as respostas na mesma ordem. Comandos em cache não vão ao socket,
+    exceto os condicionais, que só confirmam a versão (304) com o daemon.
+    """
+    with _socket_lock:
+        now = time.time()
+        results: Dict[str, Any] = {}
+        pending: List[str] = []
+        wire: Dict[str, str] = {}
+        for command in commands:
+            if command in _socket_cache:
+                ts, cached = _socket_cache[command]
+                version_key = _CONDITIONAL_COMMANDS.get(command)
+                version = cached.get(version_key) if version_key and isinstance(cached, dict) else None
+                if isinstance(version, int):
+                    wire[command] = f"{command} IF-NEWER {version}"
+                elif now - ts < _SOCKET_CACHE_TTL:
+                    results[command] = cached
+                    continue
+            if command not in pending:
+                pending.append(command)
+
+        if pending:
+            path = sfp_socket_path()
+            timeout = float(os.getenv("SFP_SOCKET_TIMEOUT", "3"))
+            last_exc: Exception = RuntimeError("no attempts")
+            payloads: Optional[List[Dict[str, Any]]] = None
+            for attempt in range(3):
+                try:
+                    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as s:
+                        s.settimeout(timeout)
+                        s.connect(path)
+                        request = "FRAMING LENGTH\n" + "".join(wire.get(c, c) + "\n" for c in pending)
+                        s.sendall(request.encode("utf-8"))
+                        payloads = _recv_framed_responses(s, len(pending) + 1)[1:]
+                    break
+                except (FileNotFoundError, ConnectionRefusedError, TimeoutError, socket.error, BlockingIOError) as e:
+                    last_exc = e
+                    if attempt < 2:
+                        time.sleep(0.3 * (attempt + 1))
+            else:
+                raise HTTPException(status_code=503, detail=f"Socket error: {last_exc}")
+
+            received_at = time.time()
+            for command, payload in zip(pending, payloads or []):
+                if isinstance(payload, dict) and payload.get("status") == "not_modified" and command in _socket_cache:
+                    payload = _socket_cache[command][1]
+                _socket_cache[command] = (received_at, payload)
+                results[command] = payload
+
+        return [results[c] for c in commands]
+
+
+def send_command(command: str) -> Dict[str, Any]:
+    return send_commands([command])[0]
 
 
 def map_current(payload: Dict[str, Any], dynamic_payload: Optional[Dict[str, Any]] = None) -> CurrentReading:
@@ -367,18 +413,24 @@ def api_raw_cmd(cmd: str) -> Dict[str, Any]:
 @app.get("/api/v1/debug/all")
 def api_debug_all() -> Dict[str, Any]:
     result: Dict[str, Any] = {}
-    for key, alias in (
-        ("current", "current"),
-        ("static", "static"),
-        ("dynamic", "dynamic"),
-        ("state", "state"),
-    ):
+    mapped = {key: _cmd_from_alias(key) for key in ("current", "static", "dynamic", "state")}
+    pairs = [(key, command) for key, command in mapped.items() if command]
+    batch: Dict[str, Any] = {}
+    try:
+        # Um único round trip: os comandos vão no mesmo write
+        batch = dict(zip((key for key, _ in pairs), send_commands([command for _, command in pairs])))
+    except Exception:
+        # Lote falhou: repete um a um abaixo para o erro sair por chave
+        pass
+    for key, command in mapped.items():
+        if not command:
+            result[key] = {"error": "invalid"}
+            continue
+        if key in batch:
+            result[key] = batch[key]
+            continue
         try:
-            mapped = _cmd_from_alias(alias)
-            if mapped:
-                result[key] = send_command(mapped)
-            else:
-                result[key] = {"error": "invalid"}
+            result[key] = send_command(command)
         except HTTPException as he:
             result[key] = {"error": he.detail}
         except Exception as e:
@@ -55,46 +55,42 @@ class SFPReader:
         except Exception:
             pass
         try:
-            if not os.path.exists(SFPReader.SOCKET_PATH):
-                return None
-            with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as s:
-                s.settimeout(1.0)
-                s.connect(SFPReader.SOCKET_PATH)
-                s.sendall(b"PING\n")
-                buf = b""
-                while True:
-                    chunk = s.recv(4096)
-                    if not chunk:
-                        break
-                    buf += chunk
-                    if buf.strip().endswith(b"}"):
-                        break
-                raw = buf.decode("utf-8", errors="replace")
-                if "{" in raw:
-                    return json.loads(raw[raw.find("{"):])
+            return SFPReader._socket_request("PING")
         except Exception:
             pass
         return None
 
     @staticmethod
-    def _fetch_socket():
-        try:
-            if not os.path.exists(SFPReader.SOCKET_PATH):
-                return None
-            with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as s:
-                s.settimeout(1.0)
-                s.connect(SFPReader.SOCKET_PATH)
-                s.sendall(b"GET CURRENT\n")
-                buf = ""
-                while True:
-                    chunk = s.recv(4096).decode("utf-8", errors="replace")
+    def _socket_request(command: str):
+        """Envia um comando em modo FRAMING LENGTH e lê a resposta com tamanho exato."""
+        if not os.path.exists(SFPReader.SOCKET_PATH):
+            return None
+        with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as s:
+            s.settimeout(1.0)
+            s.connect(SFPReader.SOCKET_PATH)
+            s.sendall(b"FRAMING LENGTH\n" + command.encode() + b"\n")
+            buf = b""
+            payload = None
+            for _ in range(2):  # confirmação do FRAMING, depois a resposta
+                while b"\n" not in buf:
+                    chunk = s.recv(4096)
                     if not chunk:
-                        break
+                        return None
                     buf += chunk
-                    if buf.strip().endswith("}"):
-                        break
-                if "{" in buf:
-                    return json.loads(buf[buf.find("{"):])
+                head, buf = buf.split(b"\n", 1)
+                size = int(head.split()[-1])
+                while len(buf) < size:
+                    chunk = s.recv(size - len(buf))
+                    if not chunk:
+                        return None
+                    buf += chunk
+                payload, buf = json.loads(buf[:size]), buf[size:]
+            return payload
+
+    @staticmethod
+    def _fetch_socket():
+        try:
+            return SFPReader._socket_request("GET CURRENT")
         except Exception as e:
             print(f"SFP socket erro: {e}")
         return None
@@ -1295,13 +1295,16 @@ void sfp_parse_a0_extended_calibration(const uint8_t *a0_data,sfp_a0h_extended_t
 
   uint8_t byte92 = a0_data[A0_DIAG_MONITORING_TYPE];
 
-  if (byte92 & (1 << SFP_A0_BIT_INTERNAL_CAL)) {
-        a0->calibration = SFP_CAL_INTERNAL;
-    }
+  /* Externa tem precedência: as constantes em A2h 56-91 são obrigatórias */
   if (byte92 & (1 << SFP_A0_BIT_EXTERNAL_CAL)) {
         a0->calibration = SFP_CAL_EXTERNAL;
     }
-  a0->calibration = SFP_CAL_NOT_SUPPORTED;
+  else if (byte92 & (1 << SFP_A0_BIT_INTERNAL_CAL)) {
+        a0->calibration = SFP_CAL_INTERNAL;
+    }
+  else {
+        a0->calibration = SFP_CAL_NOT_SUPPORTED;
+    }
 }
 
 /* ============================================
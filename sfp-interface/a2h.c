@@ -1,5 +1,7 @@
 #include "a2h.h"
+#include "sfp_dbm.h"
 #include <math.h>
+#include <string.h>
 
 /* ============================================
  * Byte 00-01 -High Temperature Alarm
@@ -607,14 +609,166 @@ float sfp_a2h_get_rx_power_dbm(const sfp_a2h_t *a2){
   if (!a2) {
     return -1;
   }
-  float power_uW = a2->rx_power_realtime;
-  if (power_uW <=0.0f) {
-    return -40.0f;/*Piso condizente com a sensibilidade do Módulo*/
-  }else {
-    return 10.0f * log10f(power_uW /1000.0f);
+  /* Tabela de sfp_dbm.c: mesmo resultado de 10*log10f(uW/1000), piso -40 */
+  return sfp_dbm_from_uw(a2->rx_power_realtime);
+}
+
+
+/* ============================================
+ * Bytes 56-91 - Calibração Externa
+ * ============================================ */
+
+static uint16_t be16(const uint8_t *p)
+{
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+/* Float IEEE-754 armazenado em big-endian */
+static float be_float(const uint8_t *p)
+{
+  uint32_t bits = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16)
+                | ((uint32_t)p[2] << 8) | p[3];
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return isfinite(value) ? value : 0.0f;
+}
+
+void sfp_parse_a2h_calibration(const uint8_t *a2_data, bool external, sfp_a2h_cal_t *cal){
+  if (!a2_data || !cal) {
+    return;
+  }
+
+  memset(cal, 0, sizeof(*cal));
+  cal->external = external;
+  if (!external) {
+    return;
   }
+
+  /* Rx_PWR(4) vem primeiro na memória */
+  cal->rx_pwr[4] = be_float(&a2_data[A2_EXT_CAL_RX_PWR_4]);
+  cal->rx_pwr[3] = be_float(&a2_data[A2_EXT_CAL_RX_PWR_3]);
+  cal->rx_pwr[2] = be_float(&a2_data[A2_EXT_CAL_RX_PWR_2]);
+  cal->rx_pwr[1] = be_float(&a2_data[A2_EXT_CAL_RX_PWR_1]);
+  cal->rx_pwr[0] = be_float(&a2_data[A2_EXT_CAL_RX_PWR_0]);
+
+  /* A maioria dos módulos usa só Rx_PWR(1) e Rx_PWR(0): Horner encurta */
+  cal->rx_pwr_degree = 4;
+  while (cal->rx_pwr_degree > 0 && cal->rx_pwr[cal->rx_pwr_degree] == 0.0f) {
+    cal->rx_pwr_degree--;
+  }
+
+  cal->tx_i_slope = be16(&a2_data[A2_EXT_CAL_TX_I_SLOPE]);
+  cal->tx_i_offset = (int16_t)be16(&a2_data[A2_EXT_CAL_TX_I_OFFSET]);
+  cal->tx_pwr_slope = be16(&a2_data[A2_EXT_CAL_TX_PWR_SLOPE]);
+  cal->tx_pwr_offset = (int16_t)be16(&a2_data[A2_EXT_CAL_TX_PWR_OFFSET]);
+  cal->t_slope = be16(&a2_data[A2_EXT_CAL_T_SLOPE]);
+  cal->t_offset = (int16_t)be16(&a2_data[A2_EXT_CAL_T_OFFSET]);
+  cal->v_slope = be16(&a2_data[A2_EXT_CAL_V_SLOPE]);
+  cal->v_offset = (int16_t)be16(&a2_data[A2_EXT_CAL_V_OFFSET]);
 }
 
+/* slope (u8.8) * AD + offset, saturado em 16 bits sem sinal */
+static uint16_t cal_unsigned(uint16_t ad, uint16_t slope, int16_t offset)
+{
+  int32_t value = (int32_t)(((uint32_t)ad * slope) >> 8) + offset;
+  if (value < 0) return 0;
+  if (value > UINT16_MAX) return UINT16_MAX;
+  return (uint16_t)value;
+}
+
+/* Temperatura: AD e resultado em complemento de 2 */
+static int16_t cal_signed(int16_t ad, uint16_t slope, int16_t offset)
+{
+  int32_t value = ((int32_t)ad * slope) / 256 + offset;
+  if (value < INT16_MIN) return INT16_MIN;
+  if (value > INT16_MAX) return INT16_MAX;
+  return (int16_t)value;
+}
+
+/* Conversão de um valor bruto (medida ou limiar) para a unidade final */
+static double cal_temp(uint16_t raw, const sfp_a2h_cal_t *cal)
+{
+  if (!cal->external) return TEMP_TO_DEGC(raw);
+  return TEMP_TO_DEGC(cal_signed((int16_t)raw, cal->t_slope, cal->t_offset));
+}
+
+static double cal_vcc(uint16_t raw, const sfp_a2h_cal_t *cal)
+{
+  if (!cal->external) return VCC_TO_VOLTS(raw);
+  return VCC_TO_VOLTS(cal_unsigned(raw, cal->v_slope, cal->v_offset));
+}
+
+static double cal_bias(uint16_t raw, const sfp_a2h_cal_t *cal)
+{
+  if (!cal->external) return BIAS_TO_MA(raw);
+  return BIAS_TO_MA(cal_unsigned(raw, cal->tx_i_slope, cal->tx_i_offset));
+}
+
+static double cal_tx_power(uint16_t raw, const sfp_a2h_cal_t *cal)
+{
+  if (!cal->external) return POWER_TO_UW(raw);
+  return POWER_TO_UW(cal_unsigned(raw, cal->tx_pwr_slope, cal->tx_pwr_offset));
+}
+
+static double cal_rx_power(uint16_t raw, const sfp_a2h_cal_t *cal)
+{
+  if (!cal->external) return POWER_TO_UW(raw);
+
+  /* Rx_PWR = Rx_PWR(4)*AD^4 + ... + Rx_PWR(0), em 0.1 uW */
+  float ad = (float)raw;
+  float rx = cal->rx_pwr[cal->rx_pwr_degree];
+  for (int i = (int)cal->rx_pwr_degree - 1; i >= 0; i--) {
+    rx = rx * ad + cal->rx_pwr[i];
+  }
+  return rx > 0.0f ? rx * 0.1f : 0.0f;
+}
+
+void sfp_parse_a2h_realtime(const uint8_t *a2_data, const sfp_a2h_cal_t *cal, sfp_a2h_t *a2){
+  if (!a2_data || !cal || !a2) {
+    return;
+  }
+
+  a2->temp_realtime = cal_temp(be16(&a2_data[A2_TEMP_CURR]), cal);
+  a2->vcc_realtime = cal_vcc(be16(&a2_data[A2_VCC_CURR]), cal);
+  a2->tx_bias_realtime = cal_bias(be16(&a2_data[A2_TX_BIAS_CURR]), cal);
+  a2->tx_power_realtime = cal_tx_power(be16(&a2_data[A2_TX_POWER_CURR]), cal);
+  a2->rx_power_realtime = cal_rx_power(be16(&a2_data[A2_RX_POWER]), cal);
+}
+
+/* ============================================
+ * Bytes 00-39 - Limiares (com a calibração do módulo)
+ * ============================================ */
+
+void sfp_parse_a2h_thresholds(const uint8_t *a2_data, const sfp_a2h_cal_t *cal, sfp_a2h_thresholds_t *th){
+  if (!a2_data || !cal || !th) {
+    return;
+  }
+
+  th->temp_high_alarm = cal_temp(be16(&a2_data[A2_TEMP_HIGH_ALARM]), cal);
+  th->temp_low_alarm = cal_temp(be16(&a2_data[A2_TEMP_LOW_ALARM]), cal);
+  th->temp_high_warning = cal_temp(be16(&a2_data[A2_TEMP_HIGH_WARNING]), cal);
+  th->temp_low_warning = cal_temp(be16(&a2_data[A2_TEMP_LOW_WARNING]), cal);
+
+  th->vcc_high_alarm = cal_vcc(be16(&a2_data[A2_VCC_HIGH_ALARM]), cal);
+  th->vcc_low_alarm = cal_vcc(be16(&a2_data[A2_VCC_LOW_ALARM]), cal);
+  th->vcc_high_warning = cal_vcc(be16(&a2_data[A2_VCC_HIGH_WARNING]), cal);
+  th->vcc_low_warning = cal_vcc(be16(&a2_data[A2_VCC_LOW_WARNING]), cal);
+
+  th->tx_bias_high_alarm = cal_bias(be16(&a2_data[A2_TX_BIAS_HIGH_ALARM]), cal);
+  th->tx_bias_low_alarm = cal_bias(be16(&a2_data[A2_TX_BIAS_LOW_ALARM]), cal);
+  th->tx_bias_high_warning = cal_bias(be16(&a2_data[A2_TX_BIAS_HIGH_WARNING]), cal);
+  th->tx_bias_low_warning = cal_bias(be16(&a2_data[A2_TX_BIAS_LOW_WARNING]), cal);
+
+  th->tx_power_high_alarm = cal_tx_power(be16(&a2_data[A2_TX_POWER_HIGH_ALARM]), cal);
+  th->tx_power_low_alarm = cal_tx_power(be16(&a2_data[A2_TX_POWER_LOW_ALARM]), cal);
+  th->tx_power_high_warning = cal_tx_power(be16(&a2_data[A2_TX_POWER_HIGH_WARNING]), cal);
+  th->tx_power_low_warning = cal_tx_power(be16(&a2_data[A2_TX_POWER_LOW_WARNING]), cal);
+
+  th->rx_power_high_alarm = cal_rx_power(be16(&a2_data[A2_RX_POWER_HIGH_ALARM]), cal);
+  th->rx_power_low_alarm = cal_rx_power(be16(&a2_data[A2_RX_POWER_LOW_ALARM]), cal);
+  th->rx_power_high_warning = cal_rx_power(be16(&a2_data[A2_RX_POWER_HIGH_WARNING]), cal);
+  th->rx_power_low_warning = cal_rx_power(be16(&a2_data[A2_RX_POWER_LOW_WARNING]), cal);
+}
 
 /* ============================================
  * Byte 110 -Data_Not_Ready
@@ -634,3 +788,55 @@ bool sfp_a2h_get_data_ready(const sfp_a2h_t *a2){
   }
   return a2->data_ready;
 }
+
+/* ============================================
+ * Bytes 110, 112-113, 116-117 - Status e Flags
+ * ============================================ */
+
+/* Byte 112 (temp..tx_power) e bits 7-6 do Byte 113 (rx_power): 10 bits */
+static uint32_t flags_group(uint8_t first, uint8_t second)
+{
+  return ((uint32_t)first << 2) | ((uint32_t)second >> 6);
+}
+
+uint32_t sfp_a2h_decode_flags(const uint8_t *a2_data)
+{
+  if (!a2_data) {
+    return 0;
+  }
+
+  uint8_t alarm_ext = a2_data[A2_ALARM_FLAGS + 1];
+  uint8_t warning_ext = a2_data[A2_WARNING_FLAGS + 1];
+
+  uint32_t flags = a2_data[STATUS_CONTROL];
+  flags |= flags_group(a2_data[A2_ALARM_FLAGS], alarm_ext) << SFP_A2_FLAG_ALARM_SHIFT;
+  flags |= flags_group(a2_data[A2_WARNING_FLAGS], warning_ext) << SFP_A2_FLAG_WARNING_SHIFT;
+
+  /* Bits 5-4: laser temp high/low, bits 3-2: TEC high/low */
+  if (alarm_ext & 0x30) flags |= SFP_A2_FLAG_LASER_TEMP_ALARM;
+  if (alarm_ext & 0x0C) flags |= SFP_A2_FLAG_TEC_ALARM;
+  if (warning_ext & 0x30) flags |= SFP_A2_FLAG_LASER_TEMP_WARNING;
+  if (warning_ext & 0x0C) flags |= SFP_A2_FLAG_TEC_WARNING;
+
+  return flags;
+}
+
+void sfp_parse_a2h_flags(const uint8_t *a2_data, sfp_a2h_t *a2)
+{
+  if (!a2_data || !a2) {
+    return;
+  }
+  a2->flags = sfp_a2h_decode_flags(a2_data);
+  a2->alarm_flags[0] = a2_data[A2_ALARM_FLAGS];
+  a2->alarm_flags[1] = a2_data[A2_ALARM_FLAGS + 1];
+  a2->warning_flags[0] = a2_data[A2_WARNING_FLAGS];
+  a2->warning_flags[1] = a2_data[A2_WARNING_FLAGS + 1];
+}
+
+uint32_t sfp_a2h_get_flags(const sfp_a2h_t *a2)
+{
+  if (!a2) {
+    return 0;
+  }
+  return a2->flags;
+}
@@ -53,8 +53,8 @@ typedef struct {
     // 56-91: Área Dinâmica (Calibração Externa ou Recursos Avançados)
     // Depende do Byte 92, bit 4 do endereço A0h
     union {
-        uint8_t external_cal_constants[8]; // Se Calibração Externa = 1
-        uint8_t enhanced_features[8];      // Se Calibração Externa = 0
+        uint8_t external_cal_constants[36]; // Se Calibração Externa = 1
+        uint8_t enhanced_features[36];      // Se Calibração Externa = 0
     } calibration_enhanced;
 
     //uint8_t reserved_92_94[9];      Bytes 92-94 [10]
@@ -71,6 +71,7 @@ typedef struct {
 
    /* uint8_t status_control;         // Byte 110 */
     bool data_ready;
+    uint32_t flags;                 // Bytes 110, 112-113, 116-117 (SFP_A2_FLAG_*)
     //uint8_t reserved_111;          Byte 111
     uint8_t alarm_flags[15];         // Bytes 112-113
     uint8_t tx_input_eq_ctrl;       // Byte 114
@@ -95,6 +96,50 @@ typedef struct {
 } sfp_a2h_t;
 
 
+/* ============================================
+ * Calibração Externa (Bytes 56-91)
+ * ============================================ */
+
+/*
+ * Constantes decodificadas uma vez por módulo. Com external = false a
+ * conversão é a da calibração interna (macros de defs.h).
+ * Os pares slope/offset convertem o A/D bruto para a mesma unidade da
+ * calibração interna: valor = slope * AD / 256 + offset.
+ */
+typedef struct {
+    bool external;
+    uint8_t rx_pwr_degree;    // Maior i com Rx_PWR(i) != 0
+    float rx_pwr[5];          // Rx_PWR(0)..Rx_PWR(4), em 0.1 uW
+    uint16_t tx_i_slope;      // 76-77
+    int16_t tx_i_offset;      // 78-79
+    uint16_t tx_pwr_slope;    // 80-81
+    int16_t tx_pwr_offset;    // 82-83
+    uint16_t t_slope;         // 84-85
+    int16_t t_offset;         // 86-87
+    uint16_t v_slope;         // 88-89
+    int16_t v_offset;         // 90-91
+} sfp_a2h_cal_t;
+
+/**
+ * Decodifica as constantes de calibração externa (chamar uma vez por inserção).
+ * Coeficientes não finitos são zerados.
+ * @param external true se A0h Byte 92 bit 4 estiver ligado
+ */
+void sfp_parse_a2h_calibration(const uint8_t *a2_data, bool external, sfp_a2h_cal_t *cal);
+
+/**
+ * Converte os valores em tempo real (Bytes 96-105) aplicando cal:
+ * temp, vcc, tx_bias, tx_power e rx_power.
+ */
+void sfp_parse_a2h_realtime(const uint8_t *a2_data, const sfp_a2h_cal_t *cal, sfp_a2h_t *a2);
+
+/**
+ * Converte os limiares de alarme/aviso (Bytes 0-39) para as mesmas unidades
+ * de sfp_parse_a2h_realtime. Com calibração externa os limiares estão em
+ * unidades do A/D e passam pela mesma conversão das medidas.
+ */
+void sfp_parse_a2h_thresholds(const uint8_t *a2_data, const sfp_a2h_cal_t *cal, sfp_a2h_thresholds_t *th);
+
 bool check_sfp_a2h_exists(const uint8_t *a2_data);
 bool get_sfp_vcc(const uint8_t *a2_data, float *vcc);
 
@@ -102,6 +147,64 @@ bool get_sfp_vcc(const uint8_t *a2_data, float *vcc);
 void sfp_parse_a2h_data_ready(const uint8_t *a2_data,sfp_a2h_t *a2);
 bool sfp_a2h_get_data_ready(const sfp_a2h_t *a2);
 
+/* ============================================
+ * Status e Flags (Bytes 110, 112-113, 116-117)
+ * ============================================ */
+
+/*
+ * Máscara compacta de 32 bits com o estado do módulo numa amostra:
+ *
+ *  bits  0-7   Byte 110 como lido (mesma numeração de SFP_A2_BIT_*)
+ *  bits  8-17  Flags de alarme (Bytes 112-113): RX/TX power, bias, Vcc, temp
+ *  bits 18-27  Flags de aviso (Bytes 116-117), mesma ordem
+ *  bits 28-31  Canais opcionais (laser temp e TEC), high ou low juntos
+ *
+ * Bytes 114-115 são controles de equalização/ênfase, não flags.
+ */
+#define SFP_A2_FLAG_DATA_NOT_READY     (1u << SFP_A2_BIT_DATA_NOT_READY)
+#define SFP_A2_FLAG_RX_LOS             (1u << SFP_A2_BIT_RX_LOS_STATE)
+#define SFP_A2_FLAG_TX_FAULT           (1u << SFP_A2_BIT_TX_FAULT_STATE)
+#define SFP_A2_FLAG_SOFT_RS0_SELECT    (1u << SFP_A2_BIT_SOFT_RS0_SELECT)
+#define SFP_A2_FLAG_RS0_STATE          (1u << SFP_A2_BIT_RS0_STATE)
+#define SFP_A2_FLAG_RS1_STATE          (1u << SFP_A2_BIT_RS1_STATE)
+#define SFP_A2_FLAG_SOFT_TX_DISABLE    (1u << SFP_A2_BIT_SOFT_TX_DISABLE)
+#define SFP_A2_FLAG_TX_DISABLE         (1u << SFP_A2_BIT_TX_DISABLE_STATE)
+
+#define SFP_A2_FLAG_ALARM_SHIFT        8
+#define SFP_A2_FLAG_WARNING_SHIFT      18
+
+/* Posição dentro do grupo de alarme ou aviso (somar o SHIFT) */
+#define SFP_A2_FLAG_RX_POWER_LOW       (1u << 0)
+#define SFP_A2_FLAG_RX_POWER_HIGH      (1u << 1)
+#define SFP_A2_FLAG_TX_POWER_LOW       (1u << 2)
+#define SFP_A2_FLAG_TX_POWER_HIGH      (1u << 3)
+#define SFP_A2_FLAG_TX_BIAS_LOW        (1u << 4)
+#define SFP_A2_FLAG_TX_BIAS_HIGH       (1u << 5)
+#define SFP_A2_FLAG_VCC_LOW            (1u << 6)
+#define SFP_A2_FLAG_VCC_HIGH           (1u << 7)
+#define SFP_A2_FLAG_TEMP_LOW           (1u << 8)
+#define SFP_A2_FLAG_TEMP_HIGH          (1u << 9)
+
+#define SFP_A2_FLAG_LASER_TEMP_ALARM   (1u << 28)
+#define SFP_A2_FLAG_TEC_ALARM          (1u << 29)
+#define SFP_A2_FLAG_LASER_TEMP_WARNING (1u << 30)
+#define SFP_A2_FLAG_TEC_WARNING        (1u << 31)
+
+#define SFP_A2_FLAGS_STATUS_MASK       0x000000FFu
+#define SFP_A2_FLAGS_ALARM_MASK        (0x3FFu << SFP_A2_FLAG_ALARM_SHIFT | SFP_A2_FLAG_LASER_TEMP_ALARM | SFP_A2_FLAG_TEC_ALARM)
+#define SFP_A2_FLAGS_WARNING_MASK      (0x3FFu << SFP_A2_FLAG_WARNING_SHIFT | SFP_A2_FLAG_LASER_TEMP_WARNING | SFP_A2_FLAG_TEC_WARNING)
+
+/**
+ * Monta a máscara SFP_A2_FLAG_* a partir dos bytes brutos.
+ */
+uint32_t sfp_a2h_decode_flags(const uint8_t *a2_data);
+
+/**
+ * Preenche a2->flags e os bytes brutos de alarm_flags/warning_flags.
+ */
+void sfp_parse_a2h_flags(const uint8_t *a2_data, sfp_a2h_t *a2);
+uint32_t sfp_a2h_get_flags(const sfp_a2h_t *a2);
+
 /* ============================================
  * Temperatura (Alarms and Warnings)
  * ============================================ */
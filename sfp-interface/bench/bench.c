@@ -0,0 +1,140 @@
+/**
+ * @file bench.c
+ * @brief Implementação dos utilitários de benchmark
+ */
+
+#define _DEFAULT_SOURCE
+#include "bench.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* ============================================
+ * Contagem de Alocações
+ * ============================================ */
+
+/* Intercepta o malloc da glibc: conta chamadas de qualquer biblioteca
+ * (atômico: o benchmark de socket tem várias threads) */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static _Atomic unsigned long g_allocs = 0;
+
+void *malloc(size_t size)
+{
+    atomic_fetch_add_explicit(&g_allocs, 1, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    atomic_fetch_add_explicit(&g_allocs, 1, memory_order_relaxed);
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    atomic_fetch_add_explicit(&g_allocs, 1, memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+unsigned long bench_allocs(void)
+{
+    return atomic_load_explicit(&g_allocs, memory_order_relaxed);
+}
+
+/* ============================================
+ * Medição
+ * ============================================ */
+uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+unsigned bench_iterations(int argc, char *argv[], unsigned fallback)
+{
+    unsigned iterations = argc > 1 ? (unsigned)strtoul(argv[1], NULL, 10) : fallback;
+    return iterations ? iterations : 1;
+}
+
+void bench_run(const char *name, bench_fn fn, void *ctx, unsigned iterations)
+{
+    size_t bytes = 0;
+
+    /* Aquecimento: enche o pool de chunks e os caches */
+    for (unsigned i = 0; i < BENCH_WARMUP; i++) {
+        bytes = fn(ctx);
+    }
+
+    size_t batches = (iterations + BENCH_BATCH - 1) / BENCH_BATCH;
+    uint64_t *samples = __libc_malloc(batches * sizeof(uint64_t));
+    if (!samples) {
+        return;
+    }
+
+    unsigned long allocs_before = bench_allocs();
+    uint64_t start = bench_now_ns();
+    unsigned done = 0;
+    for (size_t b = 0; b < batches; b++) {
+        unsigned n = iterations - done < BENCH_BATCH ? iterations - done : BENCH_BATCH;
+        uint64_t t0 = bench_now_ns();
+        for (unsigned i = 0; i < n; i++) {
+            fn(ctx);
+        }
+        samples[b] = (bench_now_ns() - t0) / n;
+        done += n;
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+    unsigned long allocs = bench_allocs() - allocs_before;
+
+    bench_report(name, iterations, elapsed, allocs, samples, batches, bytes, NULL);
+    __libc_free(samples);
+}
+
+/* ============================================
+ * Relatório
+ * ============================================ */
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Percentil por posto mais próximo (amostras ordenadas) */
+static uint64_t percentile(const uint64_t *sorted, size_t n, unsigned pct)
+{
+    if (n == 0) {
+        return 0;
+    }
+    size_t rank = ((size_t)pct * n + 99) / 100;
+    return sorted[rank ? rank - 1 : 0];
+}
+
+void bench_report(const char *name, unsigned iterations, uint64_t elapsed_ns, unsigned long allocs,
+                  uint64_t *samples_ns, size_t n_samples, size_t bytes, const char *extra)
+{
+    qsort(samples_ns, n_samples, sizeof(uint64_t), compare_u64);
+
+    printf("{\"bench\":\"%s\",\"iterations\":%u,\"ns_per_op\":%.1f,"
+           "\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,\"max_ns\":%llu,"
+           "\"allocs_per_op\":%.3f,\"bytes\":%zu%s}\n",
+           name, iterations, (double)elapsed_ns / iterations,
+           (unsigned long long)percentile(samples_ns, n_samples, 50),
+           (unsigned long long)percentile(samples_ns, n_samples, 90),
+           (unsigned long long)percentile(samples_ns, n_samples, 99),
+           (unsigned long long)(n_samples ? samples_ns[n_samples - 1] : 0),
+           (double)allocs / iterations, bytes, extra ? extra : "");
+    fflush(stdout);
+}
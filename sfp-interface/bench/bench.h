@@ -0,0 +1,53 @@
+/**
+ * @file bench.h
+ * @brief Utilitários comuns dos benchmarks (tempo, alocações, relatório)
+ *
+ * Cada benchmark imprime uma linha JSON:
+ *   {"bench":…,"iterations":…,"ns_per_op":…,"p50_ns":…,"p90_ns":…,
+ *    "p99_ns":…,"max_ns":…,"allocs_per_op":…,"bytes":…}
+ * Os percentis vêm de lotes de BENCH_BATCH operações (ns/op de cada lote),
+ * para que o custo do relógio não domine operações de poucos ns.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define BENCH_BATCH 64
+#define BENCH_WARMUP 1000
+
+/**
+ * @brief Operação medida
+ * @param ctx Contexto do benchmark
+ * @return Bytes produzidos (informativo; vai no campo "bytes")
+ */
+typedef size_t (*bench_fn)(void *ctx);
+
+uint64_t bench_now_ns(void);
+
+/**
+ * @brief Alocações (malloc/calloc/realloc) feitas pelo processo até agora
+ */
+unsigned long bench_allocs(void);
+
+/**
+ * @brief Iterações pedidas na linha de comando (argv[1]), ou o padrão
+ */
+unsigned bench_iterations(int argc, char *argv[], unsigned fallback);
+
+/**
+ * @brief Aquece e mede fn em lotes, imprime a linha JSON
+ */
+void bench_run(const char *name, bench_fn fn, void *ctx, unsigned iterations);
+
+/**
+ * @brief Imprime a linha JSON a partir de amostras já coletadas
+ * @param samples_ns Latência de cada amostra (é reordenado)
+ * @param extra Campos extras já formatados (",\"clients\":4"...) ou NULL
+ */
+void bench_report(const char *name, unsigned iterations, uint64_t elapsed_ns, unsigned long allocs,
+                  uint64_t *samples_ns, size_t n_samples, size_t bytes, const char *extra);
+
+#endif /* BENCH_H */
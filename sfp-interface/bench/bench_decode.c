@@ -0,0 +1,233 @@
+/**
+ * @file bench_decode.c
+ * @brief Benchmark do caminho de aquisição: decode A0h/A2h, dBm e cópia do estado
+ *
+ * Mede o que o loop principal e cada resposta do socket pagam antes de
+ * serializar: o decode A2h sozinho (tempo real, data ready e flags), a
+ * publicação das imagens de referência como o daemon faz
+ * (daemon_state_publish_*, com estatística, alarmes, tendência e medida no
+ * caso do A2h), a conversão µW → dBm sobre todos os valores
+ * brutos de RX, a entrada de uma amostra nas janelas de estatística
+ * (daemon_stats.h, janelas padrão) e nas camadas de tendência
+ * (daemon_trend.h, camadas padrão) e a cópia do estado sob o mutex.
+ * Saída: uma linha JSON por benchmark (ver bench.h), precedida pelo
+ * relatório de exatidão da tabela de dBm (sfp_dbm.h):
+ *   {"check":"dbm_table","values":65536,"mismatches":…,"max_err_db":…}
+ * mismatches compara bit a bit com 10*log10f(); max_err_db é o maior erro
+ * absoluto (dB) em relação a log10 em double.
+ *
+ * Uso: bench-decode [iterações]
+ */
+
+#define _DEFAULT_SOURCE
+#include "bench.h"
+#include "daemon_state.h"
+#include "daemon_stats.h"
+#include "daemon_trend.h"
+#include "bench_images.h"
+#include "sfp_dbm.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Impede que o compilador descarte o resultado */
+static volatile float g_sink;
+
+/* ============================================
+ * Operações
+ * ============================================ */
+static size_t decode_a0h(void *ctx)
+{
+    daemon_state_publish_a0h(ctx, bench_a0h_sr, 1);
+    return SFP_A0_SIZE;
+}
+
+typedef struct {
+    sfp_a2h_cal_t cal;
+    sfp_a2h_t a2;
+} a2h_ctx_t;
+
+/* Só o decode por amostra: calibração e limiares são uma vez por módulo */
+static size_t decode_a2h(void *ctx)
+{
+    a2h_ctx_t *c = ctx;
+    sfp_parse_a2h_realtime(bench_a2h_sr, &c->cal, &c->a2);
+    sfp_parse_a2h_data_ready(bench_a2h_sr, &c->a2);
+    sfp_parse_a2h_flags(bench_a2h_sr, &c->a2);
+    g_sink = (float)c->a2.rx_power_realtime;
+    return SFP_A2_SIZE;
+}
+
+/* Caminho completo do loop principal por amostra */
+static size_t publish_a2h(void *ctx)
+{
+    daemon_state_publish_a2h(ctx, bench_a2h_sr, 1);
+    return SFP_A2_SIZE;
+}
+
+typedef struct {
+    uint8_t a2_raw[SFP_A2_SIZE];
+    sfp_a2h_t a2;
+    uint16_t raw;
+} dbm_ctx_t;
+
+/* Parse do RX (bytes 104–105) + dBm, percorrendo todos os valores brutos */
+static size_t rx_power_dbm(void *ctx)
+{
+    dbm_ctx_t *c = ctx;
+    c->raw++;
+    c->a2_raw[A2_RX_POWER] = (uint8_t)(c->raw >> 8);
+    c->a2_raw[A2_RX_POWER + 1] = (uint8_t)c->raw;
+    sfp_parse_a2h_rx_power(c->a2_raw, &c->a2);
+    g_sink = sfp_a2h_get_rx_power_dbm(&c->a2);
+    return sizeof(float);
+}
+
+/* Caminho antigo: log10f da libm a cada valor */
+static size_t dbm_log10f(void *ctx)
+{
+    uint16_t *raw = ctx;
+    (*raw)++;
+    float uw = POWER_TO_UW(*raw);
+    g_sink = uw > 0.0f ? 10.0f * log10f(uw / 1000.0f) : SFP_DBM_FLOOR;
+    return sizeof(float);
+}
+
+static size_t dbm_table(void *ctx)
+{
+    uint16_t *raw = ctx;
+    (*raw)++;
+    g_sink = sfp_dbm_from_raw(*raw);
+    return sizeof(float);
+}
+
+#define BENCH_DBM_BURST 1024
+
+typedef struct {
+    uint16_t raw[BENCH_DBM_BURST];
+    float dbm[BENCH_DBM_BURST];
+} dbm_burst_ctx_t;
+
+/* Um buffer de burst inteiro por operação */
+static size_t dbm_burst(void *ctx)
+{
+    dbm_burst_ctx_t *c = ctx;
+    sfp_dbm_from_raw_array(c->raw, c->dbm, BENCH_DBM_BURST);
+    return sizeof(c->dbm);
+}
+
+/* ============================================
+ * Exatidão da Tabela de dBm
+ * ============================================ */
+static void dbm_accuracy_report(void)
+{
+    unsigned mismatches = 0;
+    double max_err = 0.0;
+    uint16_t worst = 0;
+
+    for (uint32_t raw = 1; raw <= UINT16_MAX; raw++) {
+        float uw = POWER_TO_UW(raw);
+        float expected = 10.0f * log10f(uw / 1000.0f);
+        float table = sfp_dbm_from_raw((uint16_t)raw);
+        float via_uw = sfp_dbm_from_uw(uw);
+        if (memcmp(&table, &expected, sizeof(float)) != 0 || memcmp(&via_uw, &expected, sizeof(float)) != 0) {
+            mismatches++;
+        }
+        double err = fabs((double)table - 10.0 * log10((double)raw * 0.1 / 1000.0));
+        if (err > max_err) {
+            max_err = err;
+            worst = (uint16_t)raw;
+        }
+    }
+    mismatches += sfp_dbm_from_raw(0) != SFP_DBM_FLOOR;
+
+    printf("{\"check\":\"dbm_table\",\"values\":%u,\"mismatches\":%u,"
+           "\"max_err_db\":%.3g,\"max_err_raw\":%u}\n",
+           UINT16_MAX + 1u, mismatches, max_err, worst);
+}
+
+/* Uma amostra por segundo simulado nas janelas padrão */
+static size_t stats_add(void *ctx)
+{
+    uint64_t *timestamp_ms = ctx;
+    static const float values[DAEMON_STATS_CH_COUNT] = {35.1f, 3.3f, 6.0f, 500.0f, -3.01f, 211.0f, -6.76f};
+    *timestamp_ms += 1000;
+    daemon_stats_add(1, *timestamp_ms, values);
+    return sizeof(values);
+}
+
+/* Idem nas camadas de tendência padrão: fecha um balde a cada 60 amostras */
+static size_t trend_add(void *ctx)
+{
+    uint64_t *timestamp_ms = ctx;
+    static const float values[DAEMON_ALARM_CH_COUNT] = {35.1f, 3.3f, 6.0f, -3.01f, -6.76f};
+    *timestamp_ms += 1000;
+    daemon_trend_add(1, *timestamp_ms, values);
+    return sizeof(values);
+}
+
+static size_t snapshot_copy(void *ctx)
+{
+    static sfp_daemon_state_data_t copy;
+    daemon_state_get_copy(ctx, &copy);
+    return sizeof(copy);
+}
+
+/* ============================================
+ * Main
+ * ============================================ */
+int main(int argc, char *argv[])
+{
+    unsigned iterations = bench_iterations(argc, argv, 100000);
+
+    sfp_dbm_init();
+    dbm_accuracy_report();
+
+    daemon_stats_window_cfg_t windows[DAEMON_STATS_MAX_WINDOWS];
+    uint32_t window_count = 0;
+    daemon_stats_parse_windows("60,300,900:tumbling", windows, &window_count);
+    daemon_stats_init(windows, window_count);
+
+    daemon_trend_tier_cfg_t tiers[DAEMON_TREND_MAX_TIERS];
+    uint32_t tier_count = 0;
+    daemon_trend_parse_tiers("60x60,900x96,21600x120", tiers, &tier_count);
+    daemon_trend_init(tiers, tier_count);
+
+    static sfp_daemon_state_data_t state;
+    daemon_state_init(&state);
+    state.state = SFP_STATE_PRESENT;
+    state.generation_id = 1;
+    state.first_detected = time(NULL);
+    daemon_state_publish_a0h(&state, bench_a0h_sr, state.first_detected);
+    daemon_state_publish_a2h(&state, bench_a2h_sr, state.first_detected);
+
+    static dbm_ctx_t dbm;
+    memcpy(dbm.a2_raw, bench_a2h_sr, sizeof(dbm.a2_raw));
+
+    bench_run("decode_a0h", decode_a0h, &state, iterations);
+    static a2h_ctx_t a2h;
+    sfp_parse_a2h_calibration(bench_a2h_sr, false, &a2h.cal);
+    bench_run("decode_a2h", decode_a2h, &a2h, iterations);
+    bench_run("publish_a2h", publish_a2h, &state, iterations);
+    bench_run("rx_power_dbm", rx_power_dbm, &dbm, iterations);
+
+    static uint16_t dbm_raw;
+    bench_run("dbm_log10f", dbm_log10f, &dbm_raw, iterations);
+    bench_run("dbm_table", dbm_table, &dbm_raw, iterations);
+
+    static dbm_burst_ctx_t burst;
+    for (unsigned i = 0; i < BENCH_DBM_BURST; i++) {
+        burst.raw[i] = (uint16_t)(i * 61u + 1u);
+    }
+    bench_run("dbm_burst_1024", dbm_burst, &burst, iterations / 100 ? iterations / 100 : 1);
+
+    static uint64_t stats_ts_ms = 1700000000000ull;
+    bench_run("stats_add", stats_add, &stats_ts_ms, iterations);
+    static uint64_t trend_ts_ms = 1700000000000ull;
+    bench_run("trend_add", trend_add, &trend_ts_ms, iterations);
+    bench_run("snapshot_copy", snapshot_copy, &state, iterations);
+
+    daemon_state_cleanup(&state);
+    return 0;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file bench_images.h
+ * @brief Imagens de EEPROM de referência para os benchmarks
+ *
+ * SFP+ 10GBASE-SR (850 nm, LC, calibração interna, DDM), com A2h em
+ * condição normal de operação: 35.5 °C, 3.30 V, 6.5 mA, TX 0.5 mW, RX 0.4 mW.
+ */
+
+#ifndef BENCH_IMAGES_H
+#define BENCH_IMAGES_H
+
+#include <stdint.h>
+
+static const uint8_t bench_a0h_sr[128] = {
+    0x03, 0x04, 0x07, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x67, 0x00, 0x00, 0x00,  /*   0 */
+    0x08, 0x03, 0x1E, 0x00, 0x46, 0x49, 0x4E, 0x49, 0x53, 0x41, 0x52, 0x20, 0x43, 0x4F, 0x52, 0x50,  /*  16 */
+    0x2E, 0x20, 0x20, 0x20, 0x00, 0x00, 0x90, 0x65, 0x46, 0x54, 0x4C, 0x58, 0x38, 0x35, 0x37, 0x31,  /*  32 */
+    0x44, 0x33, 0x42, 0x43, 0x4C, 0x20, 0x20, 0x20, 0x41, 0x20, 0x20, 0x20, 0x03, 0x52, 0x00, 0x48,  /*  48 */
+    0x00, 0x1A, 0x00, 0x00, 0x41, 0x4C, 0x4A, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x20, 0x20,  /*  64 */
+    0x20, 0x20, 0x20, 0x20, 0x32, 0x30, 0x30, 0x31, 0x31, 0x35, 0x20, 0x20, 0x68, 0xF0, 0x03, 0xE1,  /*  80 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /*  96 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* 112 */
+};
+
+static const uint8_t bench_a2h_sr[128] = {
+    0x4B, 0x00, 0xFB, 0x00, 0x46, 0x00, 0x00, 0x00, 0x8C, 0xA0, 0x75, 0x30, 0x88, 0xB8, 0x79, 0x18,  /*   0 */
+    0x17, 0x70, 0x03, 0xE8, 0x15, 0x7C, 0x05, 0xDC, 0x3D, 0xE9, 0x04, 0x62, 0x31, 0x2D, 0x05, 0x85,  /*  16 */
+    0x27, 0x10, 0x00, 0x64, 0x1F, 0x07, 0x00, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /*  32 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /*  48 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /*  64 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC5,  /*  80 */
+    0x23, 0x80, 0x80, 0xE8, 0x0C, 0xB2, 0x13, 0x88, 0x0F, 0xA0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /*  96 */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  /* 112 */
+};
+
+#endif /* BENCH_IMAGES_H */
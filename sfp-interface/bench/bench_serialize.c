@@ -0,0 +1,91 @@
+/**
+ * @file bench_serialize.c
+ * @brief Benchmark dos serializadores do daemon (ns/op e alocações/op)
+ *
+ * Monta o estado a partir das imagens de referência e mede cada resposta
+ * do socket como o daemon a gera: chunk do pool + escrita do JSON.
+ * Saída: uma linha JSON por benchmark (ver bench.h).
+ *
+ * Uso: bench-serialize [iterações]
+ */
+
+#define _DEFAULT_SOURCE
+#include "bench.h"
+#include "daemon_socket.h"
+#include "daemon_state.h"
+#include "daemon_outq.h"
+#include "bench_images.h"
+#include "sfp_dbm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* ============================================
+ * Medição
+ * ============================================ */
+typedef size_t (*serialize_fn)(const sfp_daemon_state_data_t *state, char *buf, size_t cap);
+
+typedef struct {
+    serialize_fn fn;
+    const sfp_daemon_state_data_t *state;
+} serialize_ctx_t;
+
+/* Uma resposta como o daemon a gera: chunk do pool + escrita do JSON */
+static size_t serialize_op(void *ctx)
+{
+    serialize_ctx_t *c = ctx;
+    daemon_chunk_t *chunk = daemon_chunk_new(DAEMON_CHUNK_POOL_CAP);
+    chunk->len = c->fn(c->state, chunk->data, chunk->cap);
+    size_t bytes = chunk->len;
+    daemon_chunk_unref(chunk);
+    return bytes;
+}
+
+static void run(const char *name, serialize_fn fn, const sfp_daemon_state_data_t *state, unsigned iterations)
+{
+    serialize_ctx_t ctx = { fn, state };
+    bench_run(name, serialize_op, &ctx, iterations);
+}
+
+/* Projeção usada pelo display/widget de RX */
+static size_t serialize_fields(const sfp_daemon_state_data_t *state, char *buf, size_t cap)
+{
+    bool bad_fields;
+    return daemon_socket_serialize_fields(state, "rx_power_dbm,temp_c", buf, cap, &bad_fields);
+}
+
+static size_t serialize_ping(const sfp_daemon_state_data_t *state, char *buf, size_t cap)
+{
+    (void)state;
+    return daemon_socket_serialize_ping(12345, buf, cap);
+}
+
+/* ============================================
+ * Main
+ * ============================================ */
+int main(int argc, char *argv[])
+{
+    unsigned iterations = bench_iterations(argc, argv, 100000);
+
+    /* Como no daemon: a tabela de dBm é montada antes do primeiro sample */
+    sfp_dbm_init();
+
+    static sfp_daemon_state_data_t state;
+    daemon_state_init(&state);
+    state.state = SFP_STATE_PRESENT;
+    state.generation_id = 1;
+    state.first_detected = time(NULL);
+    daemon_state_publish_a0h(&state, bench_a0h_sr, state.first_detected);
+    daemon_state_publish_a2h(&state, bench_a2h_sr, state.first_detected);
+
+    run("serialize_current", daemon_socket_serialize_current, &state, iterations);
+    run("serialize_static", daemon_socket_serialize_static, &state, iterations);
+    run("serialize_dynamic", daemon_socket_serialize_dynamic, &state, iterations);
+    run("serialize_fields", serialize_fields, &state, iterations);
+    run("serialize_state", daemon_socket_serialize_state, &state, iterations);
+    run("serialize_ping", serialize_ping, &state, iterations);
+
+    daemon_state_cleanup(&state);
+    return 0;
+}
@@ -0,0 +1,247 @@
+/**
+ * @file bench_socket.c
+ * @brief Benchmark ponta a ponta do socket: requisição/resposta com 1..N clientes
+ *
+ * Sobe o servidor do daemon (daemon_socket_poll) numa thread, com o estado
+ * montado a partir das imagens de referência, e abre N clientes Unix
+ * socket, cada um em sua thread, fazendo requisições bloqueantes em
+ * sequência. Para cada comando e cada número de clientes imprime uma linha
+ * JSON (ver bench.h) com os percentis da latência de cada requisição, mais
+ * "clients" e "req_per_s". ns_per_op é o tempo de parede dividido pelo
+ * total de requisições; allocs_per_op conta o processo todo.
+ *
+ * Uso: bench-socket [requisições por rodada] [máximo de clientes]
+ */
+
+#define _DEFAULT_SOURCE
+#include "bench.h"
+#include "daemon_socket.h"
+#include "daemon_state.h"
+#include "daemon_config.h"
+#include "bench_images.h"
+#include "sfp_dbm.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define BENCH_SOCKET_DEFAULT_CLIENTS 8
+#define BENCH_SOCKET_RX_SIZE 65536
+
+/* ============================================
+ * Servidor
+ * ============================================ */
+static daemon_socket_server_t g_server;
+static sfp_daemon_state_data_t g_state;
+static atomic_bool g_server_stop;
+
+static void *server_thread(void *arg)
+{
+    (void)arg;
+    while (!atomic_load(&g_server_stop)) {
+        daemon_socket_poll(&g_server, &g_state, 0, 5);
+    }
+    return NULL;
+}
+
+/* ============================================
+ * Clientes
+ * ============================================ */
+typedef struct {
+    pthread_t thread;
+    int fd;
+    const char *command;
+    size_t command_len;
+    unsigned requests;
+    uint64_t *samples_ns;
+    size_t bytes;                 /* Tamanho da última resposta */
+    bool failed;
+    char rx[BENCH_SOCKET_RX_SIZE];
+} client_t;
+
+static pthread_barrier_t g_start;
+
+static int client_connect(const char *path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    size_t path_len = strlen(path);
+    if (path_len >= sizeof(addr.sun_path)) {
+        return -1;
+    }
+    memcpy(addr.sun_path, path, path_len);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Resposta em modo linha: status line + uma linha de corpo */
+static bool client_roundtrip(client_t *c)
+{
+    if (write(c->fd, c->command, c->command_len) != (ssize_t)c->command_len) {
+        return false;
+    }
+
+    size_t len = 0;
+    int newlines = 0;
+    while (newlines < 2) {
+        if (len == sizeof(c->rx)) {
+            return false;
+        }
+        ssize_t n = read(c->fd, c->rx + len, sizeof(c->rx) - len);
+        if (n <= 0) {
+            return false;
+        }
+        for (ssize_t i = 0; i < n; i++) {
+            newlines += c->rx[len + (size_t)i] == '\n';
+        }
+        len += (size_t)n;
+    }
+    c->bytes = len;
+    return true;
+}
+
+static void *client_thread(void *arg)
+{
+    client_t *c = arg;
+
+    /* Uma volta fora da medição: conexão aceita e caches quentes */
+    c->failed = !client_roundtrip(c);
+    pthread_barrier_wait(&g_start);
+
+    for (unsigned i = 0; i < c->requests && !c->failed; i++) {
+        uint64_t t0 = bench_now_ns();
+        c->failed = !client_roundtrip(c);
+        c->samples_ns[i] = bench_now_ns() - t0;
+    }
+    return NULL;
+}
+
+/* ============================================
+ * Rodada
+ * ============================================ */
+static void run(const char *name, const char *command, unsigned clients, unsigned requests)
+{
+    static client_t pool[DAEMON_MAX_CONNECTIONS];
+    unsigned per_client = (requests + clients - 1) / clients;
+    size_t total = (size_t)per_client * clients;
+
+    uint64_t *samples = malloc(total * sizeof(uint64_t));
+    if (!samples) {
+        return;
+    }
+
+    pthread_barrier_init(&g_start, NULL, clients + 1);
+    for (unsigned i = 0; i < clients; i++) {
+        client_t *c = &pool[i];
+        c->fd = client_connect(g_server.socket_path);
+        c->command = command;
+        c->command_len = strlen(command);
+        c->requests = per_client;
+        c->samples_ns = &samples[(size_t)i * per_client];
+        c->failed = c->fd < 0;
+        pthread_create(&c->thread, NULL, client_thread, c);
+    }
+
+    pthread_barrier_wait(&g_start);
+    unsigned long allocs_before = bench_allocs();
+    uint64_t start = bench_now_ns();
+
+    bool failed = false;
+    size_t bytes = 0;
+    for (unsigned i = 0; i < clients; i++) {
+        pthread_join(pool[i].thread, NULL);
+        failed |= pool[i].failed;
+        bytes = pool[i].bytes;
+        if (pool[i].fd >= 0) {
+            close(pool[i].fd);
+        }
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+    unsigned long allocs = bench_allocs() - allocs_before;
+    pthread_barrier_destroy(&g_start);
+
+    char bench_name[64];
+    char extra[96];
+    snprintf(bench_name, sizeof(bench_name), "socket_%s", name);
+    snprintf(extra, sizeof(extra), ",\"clients\":%u,\"req_per_s\":%.0f%s",
+             clients, (double)total * 1e9 / (double)elapsed, failed ? ",\"failed\":true" : "");
+    bench_report(bench_name, (unsigned)total, elapsed, allocs, samples, total, bytes, extra);
+    free(samples);
+
+    /* Dá tempo ao servidor de fechar as conexões antes da próxima rodada */
+    usleep(20000);
+}
+
+/* ============================================
+ * Main
+ * ============================================ */
+int main(int argc, char *argv[])
+{
+    unsigned requests = bench_iterations(argc, argv, 20000);
+    unsigned max_clients = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 10) : BENCH_SOCKET_DEFAULT_CLIENTS;
+    if (max_clients == 0) {
+        max_clients = 1;
+    }
+    if (max_clients > DAEMON_MAX_CONNECTIONS) {
+        max_clients = DAEMON_MAX_CONNECTIONS;
+    }
+
+    sfp_dbm_init();
+    daemon_state_init(&g_state);
+    g_state.state = SFP_STATE_PRESENT;
+    g_state.generation_id = 1;
+    g_state.first_detected = time(NULL);
+    daemon_state_publish_a0h(&g_state, bench_a0h_sr, g_state.first_detected);
+    daemon_state_publish_a2h(&g_state, bench_a2h_sr, g_state.first_detected);
+
+    daemon_config_t config;
+    daemon_config_get_defaults(&config);
+    snprintf(config.socket_path, sizeof(config.socket_path), "/tmp/sfp-bench-%d.sock", (int)getpid());
+    if (!daemon_socket_init(&g_server, &config)) {
+        fprintf(stderr, "bench-socket: failed to listen on %s\n", config.socket_path);
+        return 1;
+    }
+
+    pthread_t server;
+    pthread_create(&server, NULL, server_thread, NULL);
+
+    static const struct {
+        const char *name;
+        const char *command;
+    } commands[] = {
+        { "get_current", "GET CURRENT\n" },
+        { "get_dynamic", "GET DYNAMIC\n" },
+        { "get_fields", "GET FIELDS rx_power_dbm,temp_c\n" },
+        { "ping", "PING\n" },
+    };
+
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        /* 1, 2, 4, … e por fim o máximo pedido */
+        for (unsigned clients = 1; ; clients = clients * 2 < max_clients ? clients * 2 : max_clients) {
+            run(commands[i].name, commands[i].command, clients, requests);
+            if (clients == max_clients) {
+                break;
+            }
+        }
+    }
+
+    atomic_store(&g_server_stop, true);
+    pthread_join(server, NULL);
+    daemon_socket_cleanup(&g_server);
+    daemon_state_cleanup(&g_state);
+    return 0;
+}
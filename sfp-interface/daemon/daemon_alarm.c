@@ -0,0 +1,418 @@
+/**
+ * @file daemon_alarm.c
+ * @brief Implementação do motor de alarmes (histerese + fila de eventos)
+ */
+
+#define _DEFAULT_SOURCE
+#include "daemon_alarm.h"
+#include "../sfp_dbm.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+
+/* ============================================
+ * Nomes
+ * ============================================ */
+static const char *const k_channel_names[DAEMON_ALARM_CH_COUNT] = {
+    "temp_c",
+    "voltage_v",
+    "tx_bias_ma",
+    "tx_power_dbm",
+    "rx_power_dbm",
+};
+
+static const char *const k_condition_names[DAEMON_ALARM_COND_COUNT] = {
+    "high_alarm",
+    "low_alarm",
+    "high_warning",
+    "low_warning",
+};
+
+static const char *const k_source_names[DAEMON_ALARM_SRC_COUNT] = {
+    "module",
+    "user",
+};
+
+/* Histerese padrão, na unidade de cada canal (tx_bias_ma segue o valor
+ * reportado pelo daemon) */
+static const float k_default_hysteresis[DAEMON_ALARM_CH_COUNT] = {
+    1.0f,     /* °C */
+    0.02f,    /* V */
+    100.0f,   /* tx_bias_ma */
+    0.5f,     /* dB */
+    0.5f,     /* dB */
+};
+
+const char *daemon_alarm_channel_name(daemon_alarm_channel_t channel)
+{
+    return (unsigned)channel < DAEMON_ALARM_CH_COUNT ? k_channel_names[channel] : "unknown";
+}
+
+const char *daemon_alarm_condition_name(daemon_alarm_condition_t condition)
+{
+    return (unsigned)condition < DAEMON_ALARM_COND_COUNT ? k_condition_names[condition] : "unknown";
+}
+
+const char *daemon_alarm_source_name(daemon_alarm_source_t source)
+{
+    return (unsigned)source < DAEMON_ALARM_SRC_COUNT ? k_source_names[source] : "unknown";
+}
+
+float daemon_alarm_default_hysteresis(daemon_alarm_channel_t channel)
+{
+    return (unsigned)channel < DAEMON_ALARM_CH_COUNT ? k_default_hysteresis[channel] : 0.0f;
+}
+
+/* ============================================
+ * Estado
+ * ============================================ */
+typedef struct {
+    bool enabled;
+    float threshold;
+    bool active;
+    daemon_alarm_event_t raised;   /* Evento que ligou a condição */
+} condition_t;
+
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static condition_t g_cond[DAEMON_ALARM_SRC_COUNT][DAEMON_ALARM_CH_COUNT][DAEMON_ALARM_COND_COUNT];
+static float g_hysteresis[DAEMON_ALARM_CH_COUNT];
+static bool g_use_module = true;
+static uint64_t g_generation_id = 0;
+static float g_last_value[DAEMON_ALARM_SRC_COUNT][DAEMON_ALARM_CH_COUNT];
+/* Limiares do módulo utilizáveis, mesmo com alarm_module_thresholds=false */
+static bool g_module_valid[DAEMON_ALARM_CH_COUNT];
+
+/* Fila de eventos: seq s fica em g_events[(s - 1) % DAEMON_ALARM_QUEUE_SIZE] */
+static daemon_alarm_event_t g_events[DAEMON_ALARM_QUEUE_SIZE];
+static uint64_t g_last_seq = 0;
+
+static bool is_high(daemon_alarm_condition_t condition)
+{
+    return condition == DAEMON_ALARM_HIGH_ALARM || condition == DAEMON_ALARM_HIGH_WARNING;
+}
+
+/* Chamado com g_mutex travado */
+static daemon_alarm_event_t *push_event(uint64_t timestamp_ms, daemon_alarm_source_t src,
+                                        daemon_alarm_channel_t ch, daemon_alarm_condition_t cond,
+                                        bool raised, float value, float threshold)
+{
+    daemon_alarm_event_t *e = &g_events[g_last_seq % DAEMON_ALARM_QUEUE_SIZE];
+    e->seq = ++g_last_seq;
+    e->timestamp_ms = timestamp_ms;
+    e->generation_id = g_generation_id;
+    e->channel = ch;
+    e->condition = cond;
+    e->source = src;
+    e->raised = raised;
+    e->value = value;
+    e->threshold = threshold;
+    return e;
+}
+
+/* Encerra as condições ativas de uma fonte (troca de módulo) */
+static void clear_source(daemon_alarm_source_t src, uint64_t timestamp_ms)
+{
+    for (int ch = 0; ch < DAEMON_ALARM_CH_COUNT; ch++) {
+        for (int cond = 0; cond < DAEMON_ALARM_COND_COUNT; cond++) {
+            condition_t *c = &g_cond[src][ch][cond];
+            if (c->active) {
+                c->active = false;
+                push_event(timestamp_ms, src, (daemon_alarm_channel_t)ch, (daemon_alarm_condition_t)cond,
+                           false, g_last_value[src][ch], c->threshold);
+            }
+        }
+    }
+}
+
+/* Chamado com g_mutex travado */
+static void new_generation(uint64_t generation_id, uint64_t timestamp_ms)
+{
+    if (generation_id == g_generation_id) {
+        return;
+    }
+    for (int src = 0; src < DAEMON_ALARM_SRC_COUNT; src++) {
+        clear_source((daemon_alarm_source_t)src, timestamp_ms);
+    }
+    g_generation_id = generation_id;
+}
+
+/* ============================================
+ * Configuração
+ * ============================================ */
+static bool lookup_name(const char *const *names, int count, const char *s, size_t len, int *out)
+{
+    for (int i = 0; i < count; i++) {
+        if (strlen(names[i]) == len && strncmp(names[i], s, len) == 0) {
+            *out = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Próxima palavra de *p (separada por espaço/tab) */
+static const char *next_word(const char **p, size_t *len)
+{
+    while (**p == ' ' || **p == '\t') (*p)++;
+    const char *word = *p;
+    *len = strcspn(word, " \t");
+    *p += *len;
+    return word;
+}
+
+static bool parse_value(const char *p, float *value)
+{
+    char *end;
+    while (*p == ' ' || *p == '\t') p++;
+    float v = strtof(p, &end);
+    if (end == p) {
+        return false;
+    }
+    while (*end == ' ' || *end == '\t') end++;
+    if (*end != '\0' || !(v > -1e9f && v < 1e9f)) {
+        return false;
+    }
+    *value = v;
+    return true;
+}
+
+bool daemon_alarm_parse_limit(const char *spec, daemon_alarm_limit_t *out)
+{
+    if (!spec || !out) {
+        return false;
+    }
+
+    const char *p = spec;
+    size_t len;
+    const char *word = next_word(&p, &len);
+    int ch, cond;
+    if (!lookup_name(k_channel_names, DAEMON_ALARM_CH_COUNT, word, len, &ch)) {
+        return false;
+    }
+    word = next_word(&p, &len);
+    if (!lookup_name(k_condition_names, DAEMON_ALARM_COND_COUNT, word, len, &cond)) {
+        return false;
+    }
+    if (!parse_value(p, &out->value)) {
+        return false;
+    }
+    out->channel = (daemon_alarm_channel_t)ch;
+    out->condition = (daemon_alarm_condition_t)cond;
+    return true;
+}
+
+bool daemon_alarm_parse_hysteresis(const char *spec, daemon_alarm_channel_t *channel, float *value)
+{
+    if (!spec || !channel || !value) {
+        return false;
+    }
+
+    const char *p = spec;
+    size_t len;
+    const char *word = next_word(&p, &len);
+    int ch;
+    float v;
+    if (!lookup_name(k_channel_names, DAEMON_ALARM_CH_COUNT, word, len, &ch) || !parse_value(p, &v) || v < 0.0f) {
+        return false;
+    }
+    *channel = (daemon_alarm_channel_t)ch;
+    *value = v;
+    return true;
+}
+
+void daemon_alarm_init(const daemon_alarm_limit_t *limits, size_t count,
+                       const float hysteresis[DAEMON_ALARM_CH_COUNT], bool use_module)
+{
+    pthread_mutex_lock(&g_mutex);
+
+    memset(g_cond, 0, sizeof(g_cond));
+    memset(g_events, 0, sizeof(g_events));
+    g_last_seq = 0;
+    g_generation_id = 0;
+    g_use_module = use_module;
+
+    for (int ch = 0; ch < DAEMON_ALARM_CH_COUNT; ch++) {
+        g_hysteresis[ch] = hysteresis ? hysteresis[ch] : k_default_hysteresis[ch];
+    }
+
+    /* Linha repetida para o mesmo canal/condição: vale a última */
+    for (size_t i = 0; limits && i < count; i++) {
+        condition_t *c = &g_cond[DAEMON_ALARM_SRC_USER][limits[i].channel][limits[i].condition];
+        c->enabled = true;
+        c->threshold = limits[i].value;
+    }
+
+    pthread_mutex_unlock(&g_mutex);
+
+    if (count > 0) {
+        syslog(LOG_INFO, "Alarm limits loaded: %zu", count);
+    }
+}
+
+/* ============================================
+ * Limiares do Módulo
+ * ============================================ */
+static void set_module_channel(daemon_alarm_channel_t ch, float high_alarm, float low_alarm,
+                               float high_warning, float low_warning)
+{
+    /* Limiares zerados ou invertidos: módulo não preencheu */
+    bool valid = high_alarm > low_alarm;
+    const float values[DAEMON_ALARM_COND_COUNT] = { high_alarm, low_alarm, high_warning, low_warning };
+    g_module_valid[ch] = valid;
+    for (int cond = 0; cond < DAEMON_ALARM_COND_COUNT; cond++) {
+        condition_t *c = &g_cond[DAEMON_ALARM_SRC_MODULE][ch][cond];
+        c->enabled = valid && g_use_module;
+        c->threshold = values[cond];
+        c->active = false;
+    }
+}
+
+void daemon_alarm_set_module(uint64_t generation_id, uint64_t timestamp_ms, const sfp_a2h_thresholds_t *th)
+{
+    pthread_mutex_lock(&g_mutex);
+
+    new_generation(generation_id, timestamp_ms);
+    clear_source(DAEMON_ALARM_SRC_MODULE, timestamp_ms);
+
+    if (!th) {
+        for (int ch = 0; ch < DAEMON_ALARM_CH_COUNT; ch++) {
+            set_module_channel((daemon_alarm_channel_t)ch, 0, 0, 0, 0);
+        }
+        pthread_mutex_unlock(&g_mutex);
+        return;
+    }
+
+    set_module_channel(DAEMON_ALARM_CH_TEMP_C, th->temp_high_alarm, th->temp_low_alarm,
+                       th->temp_high_warning, th->temp_low_warning);
+    set_module_channel(DAEMON_ALARM_CH_VOLTAGE_V, th->vcc_high_alarm, th->vcc_low_alarm,
+                       th->vcc_high_warning, th->vcc_low_warning);
+    set_module_channel(DAEMON_ALARM_CH_TX_BIAS_MA, th->tx_bias_high_alarm, th->tx_bias_low_alarm,
+                       th->tx_bias_high_warning, th->tx_bias_low_warning);
+
+    /* Potências: limiares em µW, comparados em dBm */
+    set_module_channel(DAEMON_ALARM_CH_TX_POWER_DBM,
+                       sfp_dbm_from_uw(th->tx_power_high_alarm), sfp_dbm_from_uw(th->tx_power_low_alarm),
+                       sfp_dbm_from_uw(th->tx_power_high_warning), sfp_dbm_from_uw(th->tx_power_low_warning));
+    set_module_channel(DAEMON_ALARM_CH_RX_POWER_DBM,
+                       sfp_dbm_from_uw(th->rx_power_high_alarm), sfp_dbm_from_uw(th->rx_power_low_alarm),
+                       sfp_dbm_from_uw(th->rx_power_high_warning), sfp_dbm_from_uw(th->rx_power_low_warning));
+
+    pthread_mutex_unlock(&g_mutex);
+}
+
+/* ============================================
+ * Avaliação por Amostra
+ * ============================================ */
+static void evaluate_source(daemon_alarm_source_t src, uint64_t timestamp_ms, const float values[DAEMON_ALARM_CH_COUNT])
+{
+    for (int ch = 0; ch < DAEMON_ALARM_CH_COUNT; ch++) {
+        float v = values[ch];
+        float h = g_hysteresis[ch];
+        g_last_value[src][ch] = v;
+
+        for (int cond = 0; cond < DAEMON_ALARM_COND_COUNT; cond++) {
+            condition_t *c = &g_cond[src][ch][cond];
+            if (!c->enabled) {
+                continue;
+            }
+
+            bool high = is_high((daemon_alarm_condition_t)cond);
+            bool transition;
+            if (!c->active) {
+                transition = high ? v > c->threshold : v < c->threshold;
+            } else {
+                transition = high ? v < c->threshold - h : v > c->threshold + h;
+            }
+            if (!transition) {
+                continue;
+            }
+
+            c->active = !c->active;
+            daemon_alarm_event_t *e = push_event(timestamp_ms, src, (daemon_alarm_channel_t)ch,
+                                                 (daemon_alarm_condition_t)cond, c->active, v, c->threshold);
+            if (c->active) {
+                c->raised = *e;
+            }
+        }
+    }
+}
+
+void daemon_alarm_evaluate(uint64_t generation_id, uint64_t timestamp_ms,
+                           const float module_values[DAEMON_ALARM_CH_COUNT],
+                           const float values[DAEMON_ALARM_CH_COUNT])
+{
+    if (!module_values || !values) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_mutex);
+    new_generation(generation_id, timestamp_ms);
+    evaluate_source(DAEMON_ALARM_SRC_MODULE, timestamp_ms, module_values);
+    evaluate_source(DAEMON_ALARM_SRC_USER, timestamp_ms, values);
+    pthread_mutex_unlock(&g_mutex);
+}
+
+/* ============================================
+ * Consulta
+ * ============================================ */
+uint64_t daemon_alarm_last_seq(void)
+{
+    pthread_mutex_lock(&g_mutex);
+    uint64_t seq = g_last_seq;
+    pthread_mutex_unlock(&g_mutex);
+    return seq;
+}
+
+size_t daemon_alarm_events_since(uint64_t since, daemon_alarm_event_t *out, size_t max, bool *lost)
+{
+    pthread_mutex_lock(&g_mutex);
+
+    uint64_t oldest = g_last_seq > DAEMON_ALARM_QUEUE_SIZE ? g_last_seq - DAEMON_ALARM_QUEUE_SIZE + 1 : 1;
+    uint64_t first = since + 1 > oldest ? since + 1 : oldest;
+    if (lost) {
+        *lost = since + 1 < oldest;
+    }
+
+    size_t n = 0;
+    for (uint64_t seq = first; seq <= g_last_seq && n < max; seq++) {
+        out[n++] = g_events[(seq - 1) % DAEMON_ALARM_QUEUE_SIZE];
+    }
+
+    pthread_mutex_unlock(&g_mutex);
+    return n;
+}
+
+bool daemon_alarm_module_threshold(daemon_alarm_channel_t channel, daemon_alarm_condition_t condition, float *threshold)
+{
+    if ((unsigned)channel >= DAEMON_ALARM_CH_COUNT || (unsigned)condition >= DAEMON_ALARM_COND_COUNT) {
+        return false;
+    }
+
+    pthread_mutex_lock(&g_mutex);
+    bool valid = g_module_valid[channel];
+    if (valid && threshold) {
+        *threshold = g_cond[DAEMON_ALARM_SRC_MODULE][channel][condition].threshold;
+    }
+    pthread_mutex_unlock(&g_mutex);
+    return valid;
+}
+
+size_t daemon_alarm_active(daemon_alarm_event_t *out, size_t max)
+{
+    pthread_mutex_lock(&g_mutex);
+
+    size_t n = 0;
+    for (int src = 0; src < DAEMON_ALARM_SRC_COUNT; src++) {
+        for (int ch = 0; ch < DAEMON_ALARM_CH_COUNT; ch++) {
+            for (int cond = 0; cond < DAEMON_ALARM_COND_COUNT && n < max; cond++) {
+                if (g_cond[src][ch][cond].active) {
+                    out[n++] = g_cond[src][ch][cond].raised;
+                }
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&g_mutex);
+    return n;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file daemon_alarm.h
+ * @brief Avaliação de alarmes/avisos por amostra, com histerese e fila de eventos
+ *
+ * A cada amostra A2h válida, cada canal é comparado com duas fontes de
+ * limiares: os do próprio módulo (A2h bytes 0–39, ver
+ * sfp_parse_a2h_thresholds) e os configurados pelo usuário (alarm_limit=).
+ * Uma condição "high" liga quando o valor passa do limiar e só desliga
+ * quando volta abaixo de limiar - histerese ("low": o espelho), então um
+ * valor oscilando em cima do limiar não gera uma rajada de eventos.
+ *
+ * Só as transições (raised/cleared) entram na fila, um anel de
+ * DAEMON_ALARM_QUEUE_SIZE eventos com seq crescente; o socket entrega cada
+ * evento aos assinantes (EVENT ALARM) e GET ALARMS devolve as condições
+ * ativas e os eventos recentes.
+ */
+
+#ifndef DAEMON_ALARM_H
+#define DAEMON_ALARM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../a2h.h"
+
+#define DAEMON_ALARM_QUEUE_SIZE 64
+#define DAEMON_ALARM_MAX_LIMITS 32
+
+/* ============================================
+ * Canais, Condições e Fontes
+ * ============================================ */
+typedef enum {
+    DAEMON_ALARM_CH_TEMP_C,
+    DAEMON_ALARM_CH_VOLTAGE_V,
+    DAEMON_ALARM_CH_TX_BIAS_MA,
+    DAEMON_ALARM_CH_TX_POWER_DBM,
+    DAEMON_ALARM_CH_RX_POWER_DBM,
+    DAEMON_ALARM_CH_COUNT
+} daemon_alarm_channel_t;
+
+typedef enum {
+    DAEMON_ALARM_HIGH_ALARM,
+    DAEMON_ALARM_LOW_ALARM,
+    DAEMON_ALARM_HIGH_WARNING,
+    DAEMON_ALARM_LOW_WARNING,
+    DAEMON_ALARM_COND_COUNT
+} daemon_alarm_condition_t;
+
+typedef enum {
+    DAEMON_ALARM_SRC_MODULE,    /* Limiares gravados no módulo */
+    DAEMON_ALARM_SRC_USER,      /* alarm_limit= */
+    DAEMON_ALARM_SRC_COUNT
+} daemon_alarm_source_t;
+
+/* Linha alarm_limit=<canal> <condição> <valor> */
+typedef struct {
+    daemon_alarm_channel_t channel;
+    daemon_alarm_condition_t condition;
+    float value;
+} daemon_alarm_limit_t;
+
+typedef struct {
+    uint64_t seq;
+    uint64_t timestamp_ms;     /* Amostra que causou a transição (epoch, ms) */
+    uint64_t generation_id;
+    daemon_alarm_channel_t channel;
+    daemon_alarm_condition_t condition;
+    daemon_alarm_source_t source;
+    bool raised;               /* true = ligou, false = desligou */
+    float value;
+    float threshold;
+} daemon_alarm_event_t;
+
+/* ============================================
+ * Configuração
+ * ============================================ */
+
+/**
+ * @brief Parse de "rx_power_dbm low_alarm -25"
+ */
+bool daemon_alarm_parse_limit(const char *spec, daemon_alarm_limit_t *out);
+
+/**
+ * @brief Parse de "rx_power_dbm 0.5" (alarm_hysteresis=)
+ */
+bool daemon_alarm_parse_hysteresis(const char *spec, daemon_alarm_channel_t *channel, float *value);
+
+/**
+ * @brief Histerese padrão de cada canal
+ */
+float daemon_alarm_default_hysteresis(daemon_alarm_channel_t channel);
+
+/**
+ * @brief Registra limites do usuário e histerese; zera condições e fila
+ * @param use_module false ignora os limiares do módulo
+ */
+void daemon_alarm_init(const daemon_alarm_limit_t *limits, size_t count,
+                       const float hysteresis[DAEMON_ALARM_CH_COUNT], bool use_module);
+
+/* ============================================
+ * Avaliação
+ * ============================================ */
+
+/**
+ * @brief Limiares do módulo (uma vez por generation_id). Condições ativas
+ *        da geração anterior são encerradas com eventos cleared.
+ * @param th NULL se o módulo não implementa DMI
+ */
+void daemon_alarm_set_module(uint64_t generation_id, uint64_t timestamp_ms, const sfp_a2h_thresholds_t *th);
+
+/**
+ * @brief Avalia uma amostra
+ * @param module_values Valores na calibração do módulo (comparados com os
+ *        limiares do módulo)
+ * @param values Valores reportados aos clientes, com rx_cal (comparados
+ *        com alarm_limit=)
+ */
+void daemon_alarm_evaluate(uint64_t generation_id, uint64_t timestamp_ms,
+                           const float module_values[DAEMON_ALARM_CH_COUNT],
+                           const float values[DAEMON_ALARM_CH_COUNT]);
+
+/* ============================================
+ * Consulta
+ * ============================================ */
+
+/**
+ * @brief seq do último evento (0 = nenhum)
+ */
+uint64_t daemon_alarm_last_seq(void);
+
+/**
+ * @brief Eventos com seq > since, do mais antigo para o mais novo
+ * @param lost Recebe true se eventos depois de since já saíram do anel
+ * @return Quantidade copiada (até max)
+ */
+size_t daemon_alarm_events_since(uint64_t since, daemon_alarm_event_t *out, size_t max, bool *lost);
+
+/**
+ * @brief Condições ativas agora (evento que as ligou)
+ */
+size_t daemon_alarm_active(daemon_alarm_event_t *out, size_t max);
+
+/**
+ * @brief Limiar gravado no módulo atual (na unidade do canal)
+ * @return false se o módulo não tem DMI ou o par alto/baixo não faz sentido;
+ *         não depende de alarm_module_thresholds
+ */
+bool daemon_alarm_module_threshold(daemon_alarm_channel_t channel, daemon_alarm_condition_t condition, float *threshold);
+
+const char *daemon_alarm_channel_name(daemon_alarm_channel_t channel);
+const char *daemon_alarm_condition_name(daemon_alarm_condition_t condition);
+const char *daemon_alarm_source_name(daemon_alarm_source_t source);
+
+#endif /* DAEMON_ALARM_H */
@@ -74,12 +74,59 @@ bool daemon_config_load(daemon_config_t *config, const char *config_file)
             config->poll_error_ms = (uint32_t)atoi(eq);
         } else if (strcmp(p, "max_i2c_errors") == 0) {
             config->max_i2c_errors = (uint32_t)atoi(eq);
+        } else if (strcmp(p, "min_bus_health") == 0) {
+            config->min_bus_health = (uint32_t)atoi(eq);
         } else if (strcmp(p, "max_recovery_attempts") == 0) {
             config->max_recovery_attempts = (uint32_t)atoi(eq);
         } else if (strcmp(p, "max_connections") == 0) {
             config->max_connections = (uint32_t)atoi(eq);
         } else if (strcmp(p, "daemonize") == 0) {
             config->daemonize = (strcmp(eq, "true") == 0 || strcmp(eq, "1") == 0);
+        } else if (strcmp(p, "rx_cal") == 0) {
+            /* Uma tabela por linha: <nm>[:<pn>] <lido>:<ref> ... */
+            if (config->rx_cal_count >= DAEMON_RXCAL_MAX_TABLES) {
+                syslog(LOG_WARNING, "Too many rx_cal tables, ignoring: %s", eq);
+            } else if (daemon_rxcal_parse(eq, &config->rx_cal[config->rx_cal_count])) {
+                config->rx_cal_count++;
+            } else {
+                syslog(LOG_WARNING, "Invalid rx_cal entry: %s", eq);
+            }
+        } else if (strcmp(p, "rx_temp_comp") == 0) {
+            /* Um modelo por linha: <pn> <t_ref> <t_min>:<t_max> <c1> [<c2> [<c3>]] */
+            if (config->rx_temp_comp_count >= DAEMON_RXCAL_MAX_TEMP_COMP) {
+                syslog(LOG_WARNING, "Too many rx_temp_comp models, ignoring: %s", eq);
+            } else if (daemon_rxcal_parse_temp_comp(eq, &config->rx_temp_comp[config->rx_temp_comp_count])) {
+                config->rx_temp_comp_count++;
+            } else {
+                syslog(LOG_WARNING, "Invalid rx_temp_comp entry: %s", eq);
+            }
+        } else if (strcmp(p, "stats_windows") == 0) {
+            if (!daemon_stats_parse_windows(eq, config->stats_windows, &config->stats_window_count)) {
+                syslog(LOG_WARNING, "Invalid stats_windows, keeping %s", DAEMON_STATS_DEFAULT_WINDOWS);
+            }
+        } else if (strcmp(p, "trend_tiers") == 0) {
+            if (!daemon_trend_parse_tiers(eq, config->trend_tiers, &config->trend_tier_count)) {
+                syslog(LOG_WARNING, "Invalid trend_tiers, keeping %s", DAEMON_TREND_DEFAULT_TIERS);
+            }
+        } else if (strcmp(p, "alarm_limit") == 0) {
+            /* Um limite por linha: <canal> <condição> <valor> */
+            if (config->alarm_limit_count >= DAEMON_ALARM_MAX_LIMITS) {
+                syslog(LOG_WARNING, "Too many alarm_limit entries, ignoring: %s", eq);
+            } else if (daemon_alarm_parse_limit(eq, &config->alarm_limits[config->alarm_limit_count])) {
+                config->alarm_limit_count++;
+            } else {
+                syslog(LOG_WARNING, "Invalid alarm_limit entry: %s", eq);
+            }
+        } else if (strcmp(p, "alarm_hysteresis") == 0) {
+            daemon_alarm_channel_t channel;
+            float value;
+            if (daemon_alarm_parse_hysteresis(eq, &channel, &value)) {
+                config->alarm_hysteresis[channel] = value;
+            } else {
+                syslog(LOG_WARNING, "Invalid alarm_hysteresis entry: %s", eq);
+            }
+        } else if (strcmp(p, "alarm_module_thresholds") == 0) {
+            config->alarm_module_thresholds = (strcmp(eq, "true") == 0 || strcmp(eq, "1") == 0);
         }
     }
 
@@ -111,8 +158,18 @@ void daemon_config_get_defaults(daemon_config_t *config)
     config->poll_present_ms = DAEMON_POLL_PRESENT_MS;
     config->poll_error_ms = DAEMON_POLL_ERROR_MS;
     config->max_i2c_errors = DAEMON_MAX_I2C_ERRORS;
+    config->min_bus_health = DAEMON_MIN_BUS_HEALTH;
     config->max_recovery_attempts = DAEMON_MAX_RECOVERY_ATTEMPTS;
     config->max_connections = DAEMON_MAX_CONNECTIONS;
     config->daemonize = true;
+    config->rx_cal_count = 0;
+    config->rx_temp_comp_count = 0;
+    daemon_stats_parse_windows(DAEMON_STATS_DEFAULT_WINDOWS, config->stats_windows, &config->stats_window_count);
+    config->alarm_limit_count = 0;
+    for (int ch = 0; ch < DAEMON_ALARM_CH_COUNT; ch++) {
+        config->alarm_hysteresis[ch] = daemon_alarm_default_hysteresis((daemon_alarm_channel_t)ch);
+    }
+    config->alarm_module_thresholds = true;
+    daemon_trend_parse_tiers(DAEMON_TREND_DEFAULT_TIERS, config->trend_tiers, &config->trend_tier_count);
 }
 
@@ -9,6 +9,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <syslog.h>
+#include "daemon_rxcal.h"
+#include "daemon_stats.h"
+#include "daemon_alarm.h"
+#include "daemon_trend.h"
 
 /* ============================================
  * Configurações de I²C
@@ -24,6 +28,17 @@
 #define DAEMON_DEFAULT_SOCKET_PATH "/run/sfp-daemon/sfp.sock"
 #define DAEMON_DEFAULT_SOCKET_PERMISSIONS 0666
 #define DAEMON_MAX_CONNECTIONS 10
+#define DAEMON_CLIENT_RX_BUFFER_SIZE 4096   /* Buffer de entrada por cliente (comandos pipelined) */
+#define DAEMON_MAX_COMMAND_LENGTH 256       /* Tamanho máximo de uma linha de comando */
+#define DAEMON_CLIENT_TX_HIGH_WATERMARK (256 * 1024)  /* Acima disso para de ler comandos do cliente */
+#define DAEMON_CLIENT_TX_MAX_BYTES (1024 * 1024)       /* Acima disso o cliente é desconectado */
+#define DAEMON_CLIENT_STALL_TIMEOUT_MS 10000           /* Fila parada por mais que isso: desconecta */
+#define DAEMON_SUBSCRIBE_MAX_DECIMATION 10000          /* SUBSCRIBE DYNAMIC <n>: maior n aceito */
+#define DAEMON_FIELDS_MAX 32                           /* GET FIELDS: nomes por comando */
+#define DAEMON_A0H_CACHE_SIZE 4096                     /* JSON do A0h renderizado (cache por generation_id) */
+#define DAEMON_STATS_BUFFER_SIZE 65536                 /* Resposta de STATS (JSON ou Prometheus) */
+#define DAEMON_STATS_DEFAULT_WINDOWS "60,300,900:tumbling" /* GET STATS WINDOW (ver daemon_stats.h) */
+#define DAEMON_TREND_DEFAULT_TIERS "60x60,900x96,21600x120" /* GET TREND: 1 h, 1 dia, 30 dias (ver daemon_trend.h) */
 
 /* ============================================
  * Configurações de Polling
@@ -37,6 +52,9 @@
  * Configurações de Erro e Recuperação
  * ============================================ */
 #define DAEMON_MAX_I2C_ERRORS 3
+#define DAEMON_MIN_BUS_HEALTH 50        /* Falha com nota abaixo disso: PRESENT → ERROR (0 desliga) */
+#define DAEMON_I2C_HEALTH_SHIFT 3       /* Peso da média móvel da nota: 1/2^shift por leitura */
+#define DAEMON_I2C_SLOW_US_PER_BYTE 250 /* Leitura de bloco mais lenta que isso por byte conta meia falha */
 #define DAEMON_MAX_RECOVERY_ATTEMPTS 10
 #define DAEMON_RECOVERY_TIMEOUT_SEC 30
 
@@ -61,9 +79,32 @@ typedef struct {
     uint32_t poll_present_ms;
     uint32_t poll_error_ms;
     uint32_t max_i2c_errors;
+    uint32_t min_bus_health;
     uint32_t max_recovery_attempts;
     uint32_t max_connections;
     bool daemonize;
+
+    /* Tabelas de calibração de RX power (linhas rx_cal=, ver daemon_rxcal.h) */
+    daemon_rxcal_table_t rx_cal[DAEMON_RXCAL_MAX_TABLES];
+    uint32_t rx_cal_count;
+
+    /* Compensação de temperatura do RX por PN (linhas rx_temp_comp=) */
+    daemon_rxcal_temp_comp_t rx_temp_comp[DAEMON_RXCAL_MAX_TEMP_COMP];
+    uint32_t rx_temp_comp_count;
+
+    /* Janelas de GET STATS WINDOW (stats_windows=) */
+    daemon_stats_window_cfg_t stats_windows[DAEMON_STATS_MAX_WINDOWS];
+    uint32_t stats_window_count;
+
+    /* Alarmes (alarm_limit=, alarm_hysteresis=, alarm_module_thresholds=) */
+    daemon_alarm_limit_t alarm_limits[DAEMON_ALARM_MAX_LIMITS];
+    uint32_t alarm_limit_count;
+    float alarm_hysteresis[DAEMON_ALARM_CH_COUNT];
+    bool alarm_module_thresholds;
+
+    /* Camadas de GET TREND (trend_tiers=) */
+    daemon_trend_tier_cfg_t trend_tiers[DAEMON_TREND_MAX_TIERS];
+    uint32_t trend_tier_count;
 } daemon_config_t;
 
 /* ============================================
@@ -4,10 +4,19 @@
  */
 
 #include "daemon_fsm.h"
+#include "daemon_metrics.h"
+#include "../sfp_probes.h"
 #include <string.h>
 #include <time.h>
 #include <syslog.h>
 
+/* Métrica + ponto USDT sfp:fsm__transition(from, to) */
+static void record_transition(sfp_daemon_state_t from, sfp_daemon_state_t to)
+{
+    daemon_metrics_fsm_transition(from, to);
+    SFP_PROBE2(fsm__transition, (int)from, (int)to);
+}
+
 /* ============================================
  * INIT → ABSENT
  * ============================================ */
@@ -31,6 +40,7 @@ bool daemon_fsm_init_to_absent(sfp_daemon_state_data_t *state, bool presence_det
      * quando detectar presença de SFP. */
     state->state = SFP_STATE_ABSENT;
     syslog(LOG_INFO, "State transition: INIT -> ABSENT");
+    record_transition(SFP_STATE_INIT, SFP_STATE_ABSENT);
     
     pthread_mutex_unlock(&state->mutex);
     return true;
@@ -60,6 +70,7 @@ bool daemon_fsm_absent_to_present(sfp_daemon_state_data_t *state)
     
     syslog(LOG_INFO, "State transition: ABSENT -> PRESENT (generation_id: %lu)", 
            (unsigned long)state->generation_id);
+    record_transition(SFP_STATE_ABSENT, SFP_STATE_PRESENT);
     
     pthread_mutex_unlock(&state->mutex);
     return true;
@@ -91,6 +102,7 @@ bool daemon_fsm_present_to_absent(sfp_daemon_state_data_t *state)
     state->recovery_attempts = 0;
     
     syslog(LOG_INFO, "State transition: PRESENT -> ABSENT");
+    record_transition(SFP_STATE_PRESENT, SFP_STATE_ABSENT);
     
     pthread_mutex_unlock(&state->mutex);
     return true;
@@ -117,6 +129,7 @@ bool daemon_fsm_present_to_error(sfp_daemon_state_data_t *state)
     
     syslog(LOG_WARNING, "State transition: PRESENT -> ERROR (i2c_error_count: %u)", 
            state->i2c_error_count);
+    record_transition(SFP_STATE_PRESENT, SFP_STATE_ERROR);
     
     pthread_mutex_unlock(&state->mutex);
     return true;
@@ -143,6 +156,7 @@ bool daemon_fsm_error_to_present(sfp_daemon_state_data_t *state)
     state->recovery_attempts = 0;
     
     syslog(LOG_INFO, "State transition: ERROR -> PRESENT (recovered)");
+    record_transition(SFP_STATE_ERROR, SFP_STATE_PRESENT);
     
     pthread_mutex_unlock(&state->mutex);
     return true;
@@ -175,6 +189,7 @@ bool daemon_fsm_error_to_absent(sfp_daemon_state_data_t *state, bool presence_de
         state->recovery_attempts = 0;
         
         syslog(LOG_INFO, "State transition: ERROR -> ABSENT (SFP removed)");
+        record_transition(SFP_STATE_ERROR, SFP_STATE_ABSENT);
         pthread_mutex_unlock(&state->mutex);
         return true;
     }
@@ -4,11 +4,75 @@
  */
 
 #include "daemon_i2c.h"
+#include "daemon_config.h"
+#include "daemon_metrics.h"
+#include <errno.h>
+#include <string.h>
 #include <sys/ioctl.h>
 #include <linux/i2c-dev.h>
 #include <unistd.h>
 #include <syslog.h>
 
+/* ============================================
+ * Saúde do Barramento
+ * ============================================ */
+
+/* Fração "ruim" recente em ponto fixo (0 .. DAEMON_I2C_HEALTH_ONE) */
+#define DAEMON_I2C_HEALTH_ONE 65536u
+
+static uint32_t g_health_bad = 0;
+
+static void health_observe(uint32_t bad)
+{
+    /* ewma += (amostra - ewma) / 2^shift */
+    int64_t delta = (int64_t)bad - (int64_t)g_health_bad;
+    g_health_bad = (uint32_t)((int64_t)g_health_bad + delta / (1 << DAEMON_I2C_HEALTH_SHIFT));
+    daemon_metrics_i2c_health(daemon_i2c_health_score());
+}
+
+unsigned daemon_i2c_health_score(void)
+{
+    return 100u - (unsigned)(((uint64_t)g_health_bad * 100u + DAEMON_I2C_HEALTH_ONE / 2) / DAEMON_I2C_HEALTH_ONE);
+}
+
+void daemon_i2c_health_reset(void)
+{
+    g_health_bad = 0;
+    daemon_metrics_i2c_health(100);
+}
+
+static daemon_i2c_result_t classify_errno(int err)
+{
+    switch (err) {
+        case EREMOTEIO: return DAEMON_I2C_NACK;
+        case ETIMEDOUT: return DAEMON_I2C_TIMEOUT;
+        default:        return DAEMON_I2C_OTHER;
+    }
+}
+
+/* Leitura de bloco: classifica, mede e alimenta a nota de saúde */
+static bool read_block(int i2c_fd, uint8_t addr, uint8_t *buf, uint8_t len)
+{
+    uint64_t start_ns = daemon_metrics_now_ns();
+    ssize_t n = sfp_read_block_n(i2c_fd, addr, 0x00, buf, len);
+    uint64_t elapsed_ns = daemon_metrics_now_ns() - start_ns;
+
+    daemon_i2c_result_t result = n == len ? DAEMON_I2C_OK :
+                                 n >= 0 ? DAEMON_I2C_SHORT_READ : classify_errno((int)-n);
+    daemon_metrics_i2c(addr, len, result, elapsed_ns);
+
+    if (result != DAEMON_I2C_OK) {
+        health_observe(DAEMON_I2C_HEALTH_ONE);
+        syslog(LOG_DEBUG, "I2C read 0x%02x failed: %s", addr,
+               n >= 0 ? "short read" : strerror((int)-n));
+    } else if (elapsed_ns > (uint64_t)len * DAEMON_I2C_SLOW_US_PER_BYTE * 1000u) {
+        health_observe(DAEMON_I2C_HEALTH_ONE / 2);
+    } else {
+        health_observe(0);
+    }
+    return result == DAEMON_I2C_OK;
+}
+
 /* ============================================
  * Detecta Presença de Endereço
  * ============================================ */
@@ -18,23 +82,33 @@ bool daemon_i2c_detect_address(int i2c_fd, uint8_t addr)
         return false;
     }
     
+    uint64_t start_ns = daemon_metrics_now_ns();
+    daemon_i2c_result_t result = DAEMON_I2C_OTHER;
+
     /* Tenta configurar endereço do dispositivo I²C */
-    if (ioctl(i2c_fd, I2C_SLAVE, addr) < 0) {
-        return false;  /* Dispositivo não responde */
+    if (ioctl(i2c_fd, I2C_SLAVE, addr) >= 0) {
+        /* Tenta ler 1 byte (qualquer offset) */
+        uint8_t dummy;
+        uint8_t offset = 0;
+
+        /* Escreve offset e lê */
+        ssize_t n = write(i2c_fd, &offset, 1);
+        if (n == 1) {
+            n = read(i2c_fd, &dummy, 1);
+        }
+        result = n == 1 ? DAEMON_I2C_OK :
+                 n >= 0 ? DAEMON_I2C_SHORT_READ : classify_errno(errno);
+    } else {
+        result = classify_errno(errno);
     }
-    
-    /* Tenta ler 1 byte (qualquer offset) */
-    uint8_t dummy;
-    uint8_t offset = 0;
-    
-    /* Escreve offset */
-    if (write(i2c_fd, &offset, 1) != 1) {
-        return false;
+
+    daemon_metrics_i2c(addr, 1, result, daemon_metrics_now_ns() - start_ns);
+
+    /* NACK aqui é módulo ausente, não barramento ruim */
+    if (result == DAEMON_I2C_TIMEOUT) {
+        health_observe(DAEMON_I2C_HEALTH_ONE);
     }
-    
-    /* Tenta ler */
-    ssize_t bytes_read = read(i2c_fd, &dummy, 1);
-    return (bytes_read == 1);
+    return result == DAEMON_I2C_OK;
 }
 
 /* ============================================
@@ -63,14 +137,7 @@ bool daemon_i2c_read_a0h(int i2c_fd, uint8_t *a0_raw)
         return false;
     }
     
-    /* Usa função existente da biblioteca i2c */
-    bool success = sfp_read_block(
-        i2c_fd,
-        SFP_I2C_ADDR_A0,
-        0x00,
-        a0_raw,
-        SFP_A0_SIZE
-    );
+    bool success = read_block(i2c_fd, SFP_I2C_ADDR_A0, a0_raw, SFP_A0_SIZE);
     
     if (!success) {
         syslog(LOG_DEBUG, "Failed to read A0h");
@@ -88,14 +155,7 @@ bool daemon_i2c_read_a2h(int i2c_fd, uint8_t *a2_raw)
         return false;
     }
     
-    /* Usa função existente da biblioteca i2c */
-    bool success = sfp_read_block(
-        i2c_fd,
-        SFP_I2C_ADDR_A2,
-        0x00,
-        a2_raw,
-        SFP_A2_SIZE
-    );
+    bool success = read_block(i2c_fd, SFP_I2C_ADDR_A2, a2_raw, SFP_A2_SIZE);
     
     if (!success) {
         syslog(LOG_DEBUG, "Failed to read A2h");
@@ -12,6 +12,18 @@
 #include "../a0h.h"
 #include "../a2h.h"
 
+/* ============================================
+ * Resultado de Transação
+ * ============================================ */
+typedef enum {
+    DAEMON_I2C_OK,
+    DAEMON_I2C_NACK,          /* EREMOTEIO: dispositivo não deu ACK */
+    DAEMON_I2C_TIMEOUT,       /* ETIMEDOUT: barramento travado / clock stretching */
+    DAEMON_I2C_SHORT_READ,    /* Menos bytes que o pedido */
+    DAEMON_I2C_OTHER,         /* Demais errno */
+    DAEMON_I2C_RESULT_COUNT
+} daemon_i2c_result_t;
+
 /* ============================================
  * Funções de Detecção de Presença
  * ============================================ */
@@ -51,4 +63,24 @@ bool daemon_i2c_read_a0h(int i2c_fd, uint8_t *a0_raw);
  */
 bool daemon_i2c_read_a2h(int i2c_fd, uint8_t *a2_raw);
 
+/* ============================================
+ * Saúde do Barramento
+ * ============================================ */
+
+/**
+ * @brief Nota de saúde do barramento (0–100)
+ *
+ * Média móvel exponencial das leituras de bloco: falha conta 1, leitura
+ * lenta (acima de DAEMON_I2C_SLOW_US_PER_BYTE por byte) conta 1/2. Probes
+ * de presença só entram quando dão timeout; NACK ali é módulo ausente.
+ *
+ * @return 100 = nenhuma falha recente
+ */
+unsigned daemon_i2c_health_score(void);
+
+/**
+ * @brief Zera o histórico (módulo novo inserido)
+ */
+void daemon_i2c_health_reset(void);
+
 #endif /* DAEMON_I2C_H */
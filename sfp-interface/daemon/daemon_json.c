@@ -0,0 +1,250 @@
+/**
+ * @file daemon_json.c
+ * @brief Implementação do escritor JSON em streaming
+ */
+
+#include "daemon_json.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* ============================================
+ * Escrita Bruta
+ * ============================================ */
+static void put(daemon_json_t *w, const char *data, size_t len)
+{
+    if (w->overflow || len > w->cap - w->len) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->len, data, len);
+    w->len += len;
+}
+
+static void put_char(daemon_json_t *w, char c)
+{
+    if (w->overflow || w->len >= w->cap) {
+        w->overflow = true;
+        return;
+    }
+    w->buf[w->len++] = c;
+}
+
+static void put_escaped(daemon_json_t *w, const char *s)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    put_char(w, '"');
+    const char *run = s;
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        /* Copia o trecho sem escape de uma vez */
+        put(w, run, (size_t)(s - run));
+        run = s + 1;
+
+        switch (c) {
+            case '"':  put(w, "\\\"", 2); break;
+            case '\\': put(w, "\\\\", 2); break;
+            case '\n': put(w, "\\n", 2); break;
+            case '\r': put(w, "\\r", 2); break;
+            case '\t': put(w, "\\t", 2); break;
+            case '\b': put(w, "\\b", 2); break;
+            case '\f': put(w, "\\f", 2); break;
+            default: {
+                char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+                put(w, esc, sizeof(esc));
+                break;
+            }
+        }
+    }
+    put(w, run, (size_t)(s - run));
+    put_char(w, '"');
+}
+
+/* Vírgula entre elementos e "chave": antes do valor */
+static void begin_value(daemon_json_t *w, const char *key)
+{
+    if (w->depth > 0) {
+        if (w->need_comma[w->depth - 1]) {
+            put_char(w, ',');
+        }
+        w->need_comma[w->depth - 1] = true;
+    }
+    if (key) {
+        put_escaped(w, key);
+        put_char(w, ':');
+    }
+}
+
+static void put_uint(daemon_json_t *w, uint64_t v)
+{
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[sizeof(digits) - 1 - n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    put(w, &digits[sizeof(digits) - n], n);
+}
+
+/* ============================================
+ * API
+ * ============================================ */
+void daemon_json_init(daemon_json_t *w, char *buf, size_t cap)
+{
+    w->buf = buf;
+    w->cap = cap;
+    w->len = 0;
+    w->overflow = false;
+    w->depth = 0;
+}
+
+size_t daemon_json_finish(daemon_json_t *w)
+{
+    if (w->overflow || w->depth != 0) {
+        return 0;
+    }
+    return w->len;
+}
+
+void daemon_json_object_begin(daemon_json_t *w, const char *key)
+{
+    begin_value(w, key);
+    put_char(w, '{');
+    if (w->depth >= DAEMON_JSON_MAX_DEPTH) {
+        w->overflow = true;
+        return;
+    }
+    w->need_comma[w->depth++] = false;
+}
+
+void daemon_json_object_end(daemon_json_t *w)
+{
+    put_char(w, '}');
+    if (w->depth > 0) {
+        w->depth--;
+    }
+}
+
+void daemon_json_array_begin(daemon_json_t *w, const char *key)
+{
+    begin_value(w, key);
+    put_char(w, '[');
+    if (w->depth >= DAEMON_JSON_MAX_DEPTH) {
+        w->overflow = true;
+        return;
+    }
+    w->need_comma[w->depth++] = false;
+}
+
+void daemon_json_array_end(daemon_json_t *w)
+{
+    put_char(w, ']');
+    if (w->depth > 0) {
+        w->depth--;
+    }
+}
+
+void daemon_json_string(daemon_json_t *w, const char *key, const char *value)
+{
+    begin_value(w, key);
+    if (!value) {
+        put(w, "null", 4);
+        return;
+    }
+    put_escaped(w, value);
+}
+
+void daemon_json_number(daemon_json_t *w, const char *key, double value)
+{
+    begin_value(w, key);
+
+    if (!isfinite(value)) {
+        put(w, "null", 4);
+        return;
+    }
+
+    /* Inteiros saem sem casas decimais, como no cJSON */
+    if (value == floor(value) && fabs(value) < 1e15) {
+        if (value < 0) {
+            put_char(w, '-');
+            put_uint(w, (uint64_t)(-value));
+        } else {
+            put_uint(w, (uint64_t)value);
+        }
+        return;
+    }
+
+    /* 15 dígitos quando bastam para ida e volta, senão 17 */
+    char num[32];
+    int n = snprintf(num, sizeof(num), "%1.15g", value);
+    if (strtod(num, NULL) != value) {
+        n = snprintf(num, sizeof(num), "%1.17g", value);
+    }
+    put(w, num, (size_t)n);
+}
+
+void daemon_json_float(daemon_json_t *w, const char *key, float value)
+{
+    if (!isfinite(value) || value == floorf(value)) {
+        daemon_json_number(w, key, value);
+        return;
+    }
+
+    begin_value(w, key);
+
+    /* Um float tem 6 a 9 dígitos significativos; %.9g sempre volta */
+    char num[32];
+    int n = 0;
+    for (int digits = 6; digits <= 9; digits++) {
+        n = snprintf(num, sizeof(num), "%.*g", digits, value);
+        if (strtof(num, NULL) == value) {
+            break;
+        }
+    }
+    put(w, num, (size_t)n);
+}
+
+void daemon_json_int(daemon_json_t *w, const char *key, int64_t value)
+{
+    begin_value(w, key);
+    if (value < 0) {
+        put_char(w, '-');
+        put_uint(w, (uint64_t)0 - (uint64_t)value);
+    } else {
+        put_uint(w, (uint64_t)value);
+    }
+}
+
+void daemon_json_uint(daemon_json_t *w, const char *key, uint64_t value)
+{
+    begin_value(w, key);
+    put_uint(w, value);
+}
+
+void daemon_json_bool(daemon_json_t *w, const char *key, bool value)
+{
+    begin_value(w, key);
+    if (value) {
+        put(w, "true", 4);
+    } else {
+        put(w, "false", 5);
+    }
+}
+
+void daemon_json_null(daemon_json_t *w, const char *key)
+{
+    begin_value(w, key);
+    put(w, "null", 4);
+}
+
+void daemon_json_raw(daemon_json_t *w, const char *key, const char *json, size_t len)
+{
+    begin_value(w, key);
+    put(w, json, len);
+}
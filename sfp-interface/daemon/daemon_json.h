@@ -0,0 +1,81 @@
+/**
+ * @file daemon_json.h
+ * @brief Escritor JSON compacto em streaming (sem alocação)
+ *
+ * Escreve direto num buffer fornecido pelo chamador. Se o buffer acabar,
+ * o escritor marca overflow e ignora o resto; o chamador confere com
+ * daemon_json_finish().
+ */
+
+#ifndef DAEMON_JSON_H
+#define DAEMON_JSON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define DAEMON_JSON_MAX_DEPTH 8
+
+typedef struct {
+    char *buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+    unsigned depth;
+    bool need_comma[DAEMON_JSON_MAX_DEPTH];
+} daemon_json_t;
+
+/**
+ * @brief Inicializa escritor sobre um buffer
+ * @param w Escritor
+ * @param buf Buffer de saída
+ * @param cap Capacidade do buffer
+ */
+void daemon_json_init(daemon_json_t *w, char *buf, size_t cap);
+
+/**
+ * @brief Termina a escrita
+ * @param w Escritor
+ * @return Tamanho do JSON, ou 0 se o buffer estourou ou há objeto aberto
+ */
+size_t daemon_json_finish(daemon_json_t *w);
+
+/* Em todas as funções abaixo, key é o nome do campo dentro de um objeto,
+ * ou NULL para a raiz e elementos de array */
+
+void daemon_json_object_begin(daemon_json_t *w, const char *key);
+void daemon_json_object_end(daemon_json_t *w);
+void daemon_json_array_begin(daemon_json_t *w, const char *key);
+void daemon_json_array_end(daemon_json_t *w);
+
+/**
+ * @brief Escreve string com escape (value NULL vira null)
+ */
+void daemon_json_string(daemon_json_t *w, const char *key, const char *value);
+
+/**
+ * @brief Escreve número (mesma formatação do cJSON; NaN/Inf viram null)
+ */
+void daemon_json_number(daemon_json_t *w, const char *key, double value);
+
+/**
+ * @brief Escreve número calculado em float com o menor decimal que volta ao
+ *        mesmo float (-3.0103, não -3.0103001594543457)
+ */
+void daemon_json_float(daemon_json_t *w, const char *key, float value);
+
+void daemon_json_int(daemon_json_t *w, const char *key, int64_t value);
+void daemon_json_uint(daemon_json_t *w, const char *key, uint64_t value);
+void daemon_json_bool(daemon_json_t *w, const char *key, bool value);
+void daemon_json_null(daemon_json_t *w, const char *key);
+
+/**
+ * @brief Insere um valor JSON já renderizado (objeto, array, número...)
+ * @param w Escritor
+ * @param key Nome do campo (ou NULL)
+ * @param json Valor completo e válido
+ * @param len Tamanho de json
+ */
+void daemon_json_raw(daemon_json_t *w, const char *key, const char *json, size_t len);
+
+#endif /* DAEMON_JSON_H */
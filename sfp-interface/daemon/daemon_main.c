@@ -20,18 +20,15 @@
 #include "daemon_fsm.h"
 #include "daemon_i2c.h"
 #include "daemon_socket.h"
+#include "daemon_metrics.h"
+#include "daemon_rxcal.h"
+#include "daemon_stats.h"
+#include "daemon_alarm.h"
+#include "daemon_trend.h"
+#include "../sfp_dbm.h"
 #include "../sfp_init.h"
 #include "../defs.h"
 
-/* ============================================
- * Função Auxiliar: Sleep em Milissegundos
- * ============================================ */
-static void msleep(uint32_t ms)
-{
-    /* Usa usleep que é mais comum e funciona bem no Raspberry Pi */
-    usleep(ms * 1000);
-}
-
 /* ============================================
  * Variáveis Globais
  * ============================================ */
@@ -98,16 +95,17 @@ static void main_loop(void)
 {
     time_t last_presence_check = 0;
     time_t last_a2_read = 0;
+    uint64_t last_step_ns = 0;
 
     while (g_running) {
-        uint32_t poll_delay_ms = 100; /* Polling mais rápido para o socket */
+        uint32_t poll_delay_ms = 100; /* Intervalo entre passos da FSM */
 
-        /* Aceita todas as novas conexões socket pendentes */
-        while (daemon_socket_accept(&g_socket_server));
-
-        /* Processa comandos socket */
-        time_t daemon_uptime = time(NULL) - g_start_time;
-        daemon_socket_process_commands(&g_socket_server, &g_state, daemon_uptime);
+        /* Jitter do loop: período real entre passos contra o esperado */
+        uint64_t step_ns = daemon_metrics_now_ns();
+        if (last_step_ns != 0) {
+            daemon_metrics_loop((uint64_t)poll_delay_ms * 1000, (step_ns - last_step_ns) / 1000);
+        }
+        last_step_ns = step_ns;
 
         /* Obtém estado atual (thread-safe) */
         pthread_mutex_lock(&g_state.mutex);
@@ -132,48 +130,13 @@ static void main_loop(void)
                 if (presence_detected) {
                     /* Transição ABSENT → PRESENT */
                     if (daemon_fsm_absent_to_present(&g_state)) {
+                        /* Módulo novo: a nota de saúde recomeça */
+                        daemon_i2c_health_reset();
+
                         /* Lê A0h completo */
                         uint8_t a0_raw[SFP_A0_SIZE];
                         if (daemon_i2c_read_a0h(g_i2c_fd, a0_raw)) {
-                            pthread_mutex_lock(&g_state.mutex);
-
-                            memcpy(g_state.a0_raw, a0_raw, SFP_A0_SIZE);
-                            uint32_t new_hash = daemon_state_calculate_a0_hash(a0_raw, SFP_A0_SIZE);
-
-                            /* Parse A0h */
-                            sfp_parse_a0_base_identifier(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_ext_identifier(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_connector(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_compliance(g_state.a0_raw, &g_state.a0_parsed.cc);
-                            sfp_parse_a0_base_encoding(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_nominal_rate(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_rate_identifier(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_smf_km(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_smf_m(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_om2(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_om1(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_om4_or_copper(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_om3_or_cable(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_vendor_name(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_ext_compliance(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_vendor_oui(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_vendor_pn(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_vendor_rev(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_media(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_fc_speed_2(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_parse_a0_base_cc_base(g_state.a0_raw, &g_state.a0_parsed);
-                            sfp_a0_decode_compliance(&g_state.a0_parsed.cc, &g_state.a0_parsed.dc);
-
-                            /* Parse Extended A0h (Byte 92 etc) */
-                            sfp_parse_a0_extended_dmi(g_state.a0_raw, &g_state.a0_extended);
-                            sfp_parse_a0_extended_change_addr_req(g_state.a0_raw, &g_state.a0_extended);
-                            sfp_parse_a0_extended_calibration(g_state.a0_raw, &g_state.a0_extended);
-
-                            g_state.a0_valid = true;
-                            g_state.a0_hash = new_hash;
-                            g_state.last_a0_read = now;
-
-                            pthread_mutex_unlock(&g_state.mutex);
+                            daemon_state_publish_a0h(&g_state, a0_raw, now);
 
                             syslog(LOG_INFO, "A0h read successfully (generation_id: %lu)",
                                    (unsigned long)g_state.generation_id);
@@ -199,51 +162,23 @@ static void main_loop(void)
                 if (now - last_a2_read >= (g_config.poll_present_ms / 1000)) {
                     uint8_t a2_raw[SFP_A2_SIZE];
                     if (daemon_i2c_read_a2h(g_i2c_fd, a2_raw)) {
-                        pthread_mutex_lock(&g_state.mutex);
-
-                        memcpy(g_state.a2_raw, a2_raw, SFP_A2_SIZE);
-
-                        /* Parse tempo real A2h: temp, vcc, tx_bias, tx_power, rx_power */
-                        float vcc;
-                        if (get_sfp_vcc(g_state.a2_raw, &vcc)) {
-                            g_state.a2_parsed.vcc_realtime = vcc;
-                        }
-
-                        /* Temperatura interna */
-                        uint16_t raw_temp = (uint16_t)(g_state.a2_raw[A2_TEMP_CURR] << 8)
-                                          | g_state.a2_raw[A2_TEMP_CURR + 1];
-                        g_state.a2_parsed.temp_realtime = TEMP_TO_DEGC(raw_temp);
-
-                        /* Corrente de bias TX */
-                        uint16_t raw_bias = (uint16_t)(g_state.a2_raw[A2_TX_BIAS_CURR] << 8)
-                                          | g_state.a2_raw[A2_TX_BIAS_CURR + 1];
-                        g_state.a2_parsed.tx_bias_realtime = BIAS_TO_MA(raw_bias);
-
-                        /* Potência TX */
-                        uint16_t raw_tx_pwr = (uint16_t)(g_state.a2_raw[A2_TX_POWER_CURR] << 8)
-                                            | g_state.a2_raw[A2_TX_POWER_CURR + 1];
-                        g_state.a2_parsed.tx_power_realtime = POWER_TO_UW(raw_tx_pwr);
-
-                        sfp_parse_a2h_rx_power(g_state.a2_raw, &g_state.a2_parsed);
-                        sfp_parse_a2h_data_ready(g_state.a2_raw, &g_state.a2_parsed);
-
-                        g_state.a2_valid = true;
-                        g_state.last_a2_read = now;
-                        g_state.i2c_error_count = 0;
-
-                        pthread_mutex_unlock(&g_state.mutex);
-
+                        /* Publica a amostra (parse + sample_seq) */
+                        daemon_state_publish_a2h(&g_state, a2_raw, now);
                         last_a2_read = now;
                     } else {
-                        /* Erro ao ler A2h */
+                        /* Erro ao ler A2h: erros seguidos ou barramento degradado */
+                        unsigned health = daemon_i2c_health_score();
                         pthread_mutex_lock(&g_state.mutex);
                         g_state.i2c_error_count++;
+                        bool too_many_errors = g_state.i2c_error_count >= g_config.max_i2c_errors;
+                        pthread_mutex_unlock(&g_state.mutex);
 
-                        if (g_state.i2c_error_count >= g_config.max_i2c_errors) {
-                            pthread_mutex_unlock(&g_state.mutex);
+                        bool unhealthy = health < g_config.min_bus_health;
+                        if (unhealthy && !too_many_errors) {
+                            syslog(LOG_WARNING, "I2C bus health %u below %u", health, g_config.min_bus_health);
+                        }
+                        if (too_many_errors || unhealthy) {
                             daemon_fsm_present_to_error(&g_state);
-                        } else {
-                            pthread_mutex_unlock(&g_state.mutex);
                         }
                     }
                 }
@@ -266,36 +201,7 @@ static void main_loop(void)
                     /* Tenta ler A2h novamente */
                     uint8_t a2_raw[SFP_A2_SIZE];
                     if (daemon_i2c_read_a2h(g_i2c_fd, a2_raw)) {
-                        pthread_mutex_lock(&g_state.mutex);
-
-                        memcpy(g_state.a2_raw, a2_raw, SFP_A2_SIZE);
-
-                        /* Parse tempo real A2h */
-                        float vcc;
-                        if (get_sfp_vcc(g_state.a2_raw, &vcc)) {
-                            g_state.a2_parsed.vcc_realtime = vcc;
-                        }
-
-                        uint16_t raw_temp = (uint16_t)(g_state.a2_raw[A2_TEMP_CURR] << 8)
-                                          | g_state.a2_raw[A2_TEMP_CURR + 1];
-                        g_state.a2_parsed.temp_realtime = TEMP_TO_DEGC(raw_temp);
-
-                        uint16_t raw_bias = (uint16_t)(g_state.a2_raw[A2_TX_BIAS_CURR] << 8)
-                                          | g_state.a2_raw[A2_TX_BIAS_CURR + 1];
-                        g_state.a2_parsed.tx_bias_realtime = BIAS_TO_MA(raw_bias);
-
-                        uint16_t raw_tx_pwr = (uint16_t)(g_state.a2_raw[A2_TX_POWER_CURR] << 8)
-                                            | g_state.a2_raw[A2_TX_POWER_CURR + 1];
-                        g_state.a2_parsed.tx_power_realtime = POWER_TO_UW(raw_tx_pwr);
-
-                        sfp_parse_a2h_rx_power(g_state.a2_raw, &g_state.a2_parsed);
-                        sfp_parse_a2h_data_ready(g_state.a2_raw, &g_state.a2_parsed);
-
-                        g_state.a2_valid = true;
-                        g_state.last_a2_read = now;
-                        g_state.i2c_error_count = 0;
-
-                        pthread_mutex_unlock(&g_state.mutex);
+                        daemon_state_publish_a2h(&g_state, a2_raw, now);
 
                         daemon_fsm_error_to_present(&g_state);
                         last_a2_read = now;
@@ -304,8 +210,12 @@ static void main_loop(void)
                 break;
         }
 
-        /* Sleep curto para responsividade do socket */
-        msleep(poll_delay_ms);
+        /* Empurra novas amostras e transições da FSM para os assinantes */
+        daemon_socket_publish(&g_socket_server, &g_state);
+
+        /* Atende o socket (conexões, comandos, envios pendentes) até o próximo passo da FSM */
+        time_t daemon_uptime = time(NULL) - g_start_time;
+        daemon_socket_poll(&g_socket_server, &g_state, daemon_uptime, poll_delay_ms);
     }
 }
 
@@ -341,6 +251,13 @@ int main(int argc, char *argv[])
         closelog();
         return EXIT_FAILURE;
     }
+    daemon_rxcal_init(g_config.rx_cal, g_config.rx_cal_count);
+    daemon_rxcal_init_temp_comp(g_config.rx_temp_comp, g_config.rx_temp_comp_count);
+    daemon_stats_init(g_config.stats_windows, g_config.stats_window_count);
+    daemon_alarm_init(g_config.alarm_limits, g_config.alarm_limit_count,
+                      g_config.alarm_hysteresis, g_config.alarm_module_thresholds);
+    daemon_trend_init(g_config.trend_tiers, g_config.trend_tier_count);
+    sfp_dbm_init();
 
     /* Daemonização */
     if (g_config.daemonize && !foreground) {
@@ -371,6 +288,7 @@ int main(int argc, char *argv[])
     }
 
     syslog(LOG_INFO, "I²C device opened: %s", g_config.i2c_device);
+    daemon_metrics_set_i2c_bus(g_config.i2c_device);
 
     /* Inicializa servidor socket */
     if (!daemon_socket_init(&g_socket_server, &g_config)) {
@@ -0,0 +1,109 @@
+/**
+ * @file daemon_measure.c
+ * @brief Implementação da referência de RX e do min/max hold
+ */
+
+#include "daemon_measure.h"
+#include <math.h>
+#include <string.h>
+
+/* ============================================
+ * Amostras
+ * ============================================ */
+bool daemon_measure_add(daemon_measure_t *m, float rx_dbm)
+{
+    if (!m) {
+        return false;
+    }
+
+    m->recent_dbm[m->recent_next] = rx_dbm;
+    m->recent_next = (m->recent_next + 1u) % DAEMON_MEASURE_AVG_SAMPLES;
+    if (m->recent_count < DAEMON_MEASURE_AVG_SAMPLES) {
+        m->recent_count++;
+    }
+
+    bool changed = m->dirty;
+    m->dirty = false;
+
+    if (!m->hold_valid) {
+        m->hold_valid = true;
+        m->rx_min_dbm = rx_dbm;
+        m->rx_max_dbm = rx_dbm;
+        return true;
+    }
+    if (rx_dbm < m->rx_min_dbm) {
+        m->rx_min_dbm = rx_dbm;
+        changed = true;
+    }
+    if (rx_dbm > m->rx_max_dbm) {
+        m->rx_max_dbm = rx_dbm;
+        changed = true;
+    }
+    return changed;
+}
+
+/* ============================================
+ * Referência
+ * ============================================ */
+uint32_t daemon_measure_set_reference(daemon_measure_t *m, uint64_t now_ms)
+{
+    if (!m || m->recent_count == 0) {
+        return 0;
+    }
+
+    /* Média em potência linear: a média de dBm subestima com ruído */
+    double sum_mw = 0.0;
+    for (uint32_t i = 0; i < m->recent_count; i++) {
+        sum_mw += pow(10.0, m->recent_dbm[i] / 10.0);
+    }
+    double mean_mw = sum_mw / (double)m->recent_count;
+
+    daemon_measure_set_reference_value(m, mean_mw > 0.0 ? (float)(10.0 * log10(mean_mw)) : m->recent_dbm[0], now_ms);
+    return m->recent_count;
+}
+
+void daemon_measure_set_reference_value(daemon_measure_t *m, float ref_dbm, uint64_t now_ms)
+{
+    if (!m) {
+        return;
+    }
+    m->ref_valid = true;
+    m->ref_dbm = ref_dbm;
+    m->ref_set_ms = now_ms;
+    m->dirty = true;
+}
+
+void daemon_measure_clear_reference(daemon_measure_t *m)
+{
+    if (!m) {
+        return;
+    }
+    m->ref_valid = false;
+    m->ref_dbm = 0.0f;
+    m->ref_set_ms = 0;
+    m->dirty = true;
+}
+
+/* ============================================
+ * Hold
+ * ============================================ */
+void daemon_measure_reset_hold(daemon_measure_t *m, uint64_t now_ms)
+{
+    if (!m) {
+        return;
+    }
+    m->hold_valid = false;
+    m->hold_since_ms = now_ms;
+    m->dirty = true;
+}
+
+void daemon_measure_new_module(daemon_measure_t *m, uint64_t now_ms)
+{
+    if (!m) {
+        return;
+    }
+    memset(m->recent_dbm, 0, sizeof(m->recent_dbm));
+    m->recent_count = 0;
+    m->recent_next = 0;
+    daemon_measure_reset_hold(m, now_ms);
+}
@@ -0,0 +1,75 @@
+/**
+ * @file daemon_measure.h
+ * @brief Modos de medição de RX: referência (dB relativo) e min/max hold
+ *
+ * Uso típico como medidor de perda: com o cordão de referência, SET
+ * REFERENCE guarda a média das últimas amostras de RX; com o enlace sob
+ * teste, cada amostra traz rx_rel_db = rx_power_dbm - referência
+ * (negativo = perda). O hold guarda o menor e o maior rx_power_dbm desde
+ * o último RESET HOLD (ou a troca de módulo).
+ *
+ * Tudo é atualizado na publicação da amostra (daemon_state_publish_a2h),
+ * sob o mutex do estado: picos entre duas consultas do cliente não se perdem.
+ */
+
+#ifndef DAEMON_MEASURE_H
+#define DAEMON_MEASURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Amostras de RX na média de SET REFERENCE */
+#define DAEMON_MEASURE_AVG_SAMPLES 8
+
+typedef struct {
+    /* Últimas amostras de rx_power_dbm (anel) */
+    float recent_dbm[DAEMON_MEASURE_AVG_SAMPLES];
+    uint32_t recent_count;
+    uint32_t recent_next;
+
+    /* Referência (SET REFERENCE) */
+    bool ref_valid;
+    float ref_dbm;
+    uint64_t ref_set_ms;       /* Quando foi definida (epoch, ms) */
+
+    /* Hold */
+    bool hold_valid;
+    float rx_min_dbm;
+    float rx_max_dbm;
+    uint64_t hold_since_ms;    /* Último RESET HOLD (epoch, ms) */
+
+    /* Referência ou hold alterados por comando desde a última amostra */
+    bool dirty;
+} daemon_measure_t;
+
+/**
+ * @brief Acrescenta uma amostra de RX
+ * @return true se a referência, o hold ou o dB relativo mudaram a saída
+ *         desta amostra além do próprio rx_power_dbm (SFP_A2_CHANGED_MEASURE)
+ */
+bool daemon_measure_add(daemon_measure_t *m, float rx_dbm);
+
+/**
+ * @brief Referência = média (em mW) das últimas amostras
+ * @return Amostras usadas (0 = nenhuma amostra, referência inalterada)
+ */
+uint32_t daemon_measure_set_reference(daemon_measure_t *m, uint64_t now_ms);
+
+/**
+ * @brief Referência com valor explícito (dBm)
+ */
+void daemon_measure_set_reference_value(daemon_measure_t *m, float ref_dbm, uint64_t now_ms);
+
+void daemon_measure_clear_reference(daemon_measure_t *m);
+
+/**
+ * @brief Zera o hold (volta a valer a partir da próxima amostra)
+ */
+void daemon_measure_reset_hold(daemon_measure_t *m, uint64_t now_ms);
+
+/**
+ * @brief Novo módulo: descarta hold e média (a referência é do usuário e fica)
+ */
+void daemon_measure_new_module(daemon_measure_t *m, uint64_t now_ms);
+
+#endif /* DAEMON_MEASURE_H */
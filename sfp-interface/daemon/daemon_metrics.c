@@ -0,0 +1,530 @@
+/**
+ * @file daemon_metrics.c
+ * @brief Implementação do registro de métricas
+ */
+
+#define _DEFAULT_SOURCE
+#include "daemon_metrics.h"
+#include "daemon_json.h"
+#include "../a0h.h"
+#include "../a2h.h"
+#include <stdatomic.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ============================================
+ * Tipos de Série
+ * ============================================ */
+typedef struct {
+    _Atomic uint64_t value;
+} metric_counter_t;
+
+typedef struct {
+    _Atomic int64_t value;
+} metric_gauge_t;
+
+/* Buckets não cumulativos (o último é +Inf); a exportação acumula */
+typedef struct {
+    _Atomic uint64_t buckets[DAEMON_METRICS_BUCKETS + 1];
+    _Atomic uint64_t sum_ns;
+} metric_histogram_t;
+
+typedef enum {
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM
+} metric_kind_t;
+
+typedef struct {
+    const char *name;               /* Nome Prometheus; no JSON sem o prefixo */
+    const char *help;
+    metric_kind_t kind;
+    const uint32_t *bounds_us;      /* Histogramas: limites superiores em µs */
+    bool bus_label;                 /* Prometheus: prefixa bus="…" nos rótulos */
+} metric_family_t;
+
+typedef struct {
+    const metric_family_t *family;
+    const char *labels;             /* Prometheus, ex.: addr="0x50" (NULL: sem rótulo) */
+    const char *key;                /* Chave da série no objeto JSON da família */
+    void *value;
+} metric_series_t;
+
+#define METRIC_NAME_PREFIX "sfp_daemon_"
+
+#define METRIC_STR_(x) #x
+#define METRIC_STR(x) METRIC_STR_(x)
+
+/* ============================================
+ * Armazenamento
+ * ============================================ */
+#define FSM_STATE_COUNT 4
+
+/* Transações conhecidas (endereço, tamanho): probes de presença e leituras de bloco */
+static const struct {
+    uint8_t addr;
+    size_t len;
+} k_i2c_slots[] = {
+    { SFP_I2C_ADDR_A0, 1 },
+    { SFP_I2C_ADDR_A2, 1 },
+    { SFP_I2C_ADDR_A0, SFP_A0_SIZE },
+    { SFP_I2C_ADDR_A2, SFP_A2_SIZE },
+};
+
+#define I2C_SLOT_COUNT (sizeof(k_i2c_slots) / sizeof(k_i2c_slots[0]))
+
+static metric_counter_t g_i2c_transactions[I2C_SLOT_COUNT];
+static metric_counter_t g_i2c_bytes[I2C_SLOT_COUNT];
+static metric_counter_t g_i2c_errors[I2C_SLOT_COUNT][DAEMON_I2C_RESULT_COUNT];
+static metric_histogram_t g_i2c_latency[I2C_SLOT_COUNT];
+static metric_gauge_t g_i2c_health = { 100 };
+
+static char g_i2c_bus[256] = "";
+static char g_i2c_bus_label[320] = "";  /* bus="…" já escapado */
+
+static metric_counter_t g_fsm_transitions[FSM_STATE_COUNT][FSM_STATE_COUNT];
+
+static metric_histogram_t g_loop_jitter;
+
+static metric_counter_t g_socket_accepts;
+static metric_counter_t g_socket_closes;
+static metric_gauge_t g_socket_clients;
+static metric_gauge_t g_socket_subscribers;
+
+static metric_counter_t g_commands[DAEMON_CMD_COUNT];
+static metric_histogram_t g_command_duration[DAEMON_CMD_COUNT];
+
+/* ============================================
+ * Famílias
+ * ============================================ */
+static const uint32_t k_i2c_bounds_us[DAEMON_METRICS_BUCKETS] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000
+};
+
+static const uint32_t k_loop_bounds_us[DAEMON_METRICS_BUCKETS] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000
+};
+
+static const uint32_t k_command_bounds_us[DAEMON_METRICS_BUCKETS] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000
+};
+
+static const metric_family_t k_i2c_transactions = {
+    METRIC_NAME_PREFIX "i2c_transactions_total", "I2C transactions per bus, device address and length", METRIC_COUNTER, NULL, true };
+static const metric_family_t k_i2c_bytes = {
+    METRIC_NAME_PREFIX "i2c_bytes_total", "Bytes read over I2C (successful transactions)", METRIC_COUNTER, NULL, true };
+static const metric_family_t k_i2c_errors = {
+    METRIC_NAME_PREFIX "i2c_errors_total", "Failed I2C transactions per error code (nack=EREMOTEIO, timeout=ETIMEDOUT)", METRIC_COUNTER, NULL, true };
+static const metric_family_t k_i2c_latency = {
+    METRIC_NAME_PREFIX "i2c_latency_seconds", "I2C transaction latency", METRIC_HISTOGRAM, k_i2c_bounds_us, true };
+static const metric_family_t k_i2c_health = {
+    METRIC_NAME_PREFIX "i2c_bus_health", "Rolling bus health score (100 = no recent failures)", METRIC_GAUGE, NULL, true };
+static const metric_family_t k_fsm_transitions = {
+    METRIC_NAME_PREFIX "fsm_transitions_total", "State machine transitions", METRIC_COUNTER, NULL, false };
+static const metric_family_t k_loop_jitter = {
+    METRIC_NAME_PREFIX "loop_jitter_seconds", "Main loop period deviation from the FSM step", METRIC_HISTOGRAM, k_loop_bounds_us, false };
+static const metric_family_t k_socket_accepts = {
+    METRIC_NAME_PREFIX "socket_accepts_total", "Accepted socket connections", METRIC_COUNTER, NULL, false };
+static const metric_family_t k_socket_closes = {
+    METRIC_NAME_PREFIX "socket_closes_total", "Closed socket connections", METRIC_COUNTER, NULL, false };
+static const metric_family_t k_socket_clients = {
+    METRIC_NAME_PREFIX "socket_clients", "Connected socket clients", METRIC_GAUGE, NULL, false };
+static const metric_family_t k_socket_subscribers = {
+    METRIC_NAME_PREFIX "socket_subscribers", "Clients subscribed to dynamic samples", METRIC_GAUGE, NULL, false };
+static const metric_family_t k_commands = {
+    METRIC_NAME_PREFIX "commands_total", "Socket commands per type", METRIC_COUNTER, NULL, false };
+static const metric_family_t k_command_duration = {
+    METRIC_NAME_PREFIX "command_duration_seconds", "Time to build a command response (parse + serialization)", METRIC_HISTOGRAM, k_command_bounds_us, false };
+
+/* ============================================
+ * Registro (ordem de exportação)
+ * ============================================ */
+#define I2C_SLOT_SERIES(family, storage, slot, addr, len) \
+    { &family, "addr=\"" addr "\",len=\"" len "\"", addr "/" len, &storage[slot] }
+
+/* Mesma ordem de k_i2c_slots */
+#define I2C_SERIES(family, storage) \
+    I2C_SLOT_SERIES(family, storage, 0, "0x50", "1"), \
+    I2C_SLOT_SERIES(family, storage, 1, "0x51", "1"), \
+    I2C_SLOT_SERIES(family, storage, 2, "0x50", METRIC_STR(SFP_A0_SIZE)), \
+    I2C_SLOT_SERIES(family, storage, 3, "0x51", METRIC_STR(SFP_A2_SIZE))
+
+#define I2C_ERROR_SERIES(slot, addr, len, result, code) \
+    { &k_i2c_errors, "addr=\"" addr "\",len=\"" len "\",code=\"" code "\"", addr "/" len "/" code, \
+      &g_i2c_errors[slot][result] }
+
+#define I2C_ERROR_SLOT(slot, addr, len) \
+    I2C_ERROR_SERIES(slot, addr, len, DAEMON_I2C_NACK, "nack"), \
+    I2C_ERROR_SERIES(slot, addr, len, DAEMON_I2C_TIMEOUT, "timeout"), \
+    I2C_ERROR_SERIES(slot, addr, len, DAEMON_I2C_SHORT_READ, "short_read"), \
+    I2C_ERROR_SERIES(slot, addr, len, DAEMON_I2C_OTHER, "other")
+
+#define FSM_SERIES(from, to) \
+    { &k_fsm_transitions, "from=\"" #from "\",to=\"" #to "\"", #from "->" #to, \
+      &g_fsm_transitions[SFP_STATE_##from][SFP_STATE_##to] }
+
+#define COMMAND_SERIES(family, storage, id, name) \
+    { &family, "command=\"" name "\"", name, &storage[id] }
+
+#define COMMAND_FAMILY(family, storage) \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_GET_CURRENT, "GET_CURRENT"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_GET_STATIC, "GET_STATIC"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_GET_DYNAMIC, "GET_DYNAMIC"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_GET_STATE, "GET_STATE"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_GET_FIELDS, "GET_FIELDS"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_GET_STATS, "GET_STATS"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_GET_ALARMS, "GET_ALARMS"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_GET_TREND, "GET_TREND"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_REFERENCE, "REFERENCE"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_RESET_HOLD, "RESET_HOLD"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_PING, "PING"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_SUBSCRIBE, "SUBSCRIBE"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_UNSUBSCRIBE, "UNSUBSCRIBE"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_FORMAT, "FORMAT"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_FRAMING, "FRAMING"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_STATS, "STATS"), \
+    COMMAND_SERIES(family, storage, DAEMON_CMD_INVALID, "INVALID")
+
+/* Séries da mesma família ficam contíguas */
+static const metric_series_t k_registry[] = {
+    I2C_SERIES(k_i2c_transactions, g_i2c_transactions),
+    I2C_SERIES(k_i2c_bytes, g_i2c_bytes),
+    I2C_ERROR_SLOT(0, "0x50", "1"),
+    I2C_ERROR_SLOT(1, "0x51", "1"),
+    I2C_ERROR_SLOT(2, "0x50", METRIC_STR(SFP_A0_SIZE)),
+    I2C_ERROR_SLOT(3, "0x51", METRIC_STR(SFP_A2_SIZE)),
+    I2C_SERIES(k_i2c_latency, g_i2c_latency),
+    { &k_i2c_health, NULL, NULL, &g_i2c_health },
+
+    FSM_SERIES(INIT, ABSENT),
+    FSM_SERIES(ABSENT, PRESENT),
+    FSM_SERIES(PRESENT, ABSENT),
+    FSM_SERIES(PRESENT, ERROR),
+    FSM_SERIES(ERROR, PRESENT),
+    FSM_SERIES(ERROR, ABSENT),
+
+    { &k_loop_jitter, NULL, NULL, &g_loop_jitter },
+
+    { &k_socket_accepts, NULL, NULL, &g_socket_accepts },
+    { &k_socket_closes, NULL, NULL, &g_socket_closes },
+    { &k_socket_clients, NULL, NULL, &g_socket_clients },
+    { &k_socket_subscribers, NULL, NULL, &g_socket_subscribers },
+
+    COMMAND_FAMILY(k_commands, g_commands),
+    COMMAND_FAMILY(k_command_duration, g_command_duration),
+};
+
+#define REGISTRY_SIZE (sizeof(k_registry) / sizeof(k_registry[0]))
+
+/* ============================================
+ * Primitivas
+ * ============================================ */
+static void counter_add(metric_counter_t *c, uint64_t n)
+{
+    atomic_fetch_add_explicit(&c->value, n, memory_order_relaxed);
+}
+
+static void gauge_add(metric_gauge_t *g, int64_t n)
+{
+    atomic_fetch_add_explicit(&g->value, n, memory_order_relaxed);
+}
+
+static void histogram_observe(metric_histogram_t *h, const uint32_t *bounds_us, uint64_t ns)
+{
+    size_t i = 0;
+    while (i < DAEMON_METRICS_BUCKETS && ns > (uint64_t)bounds_us[i] * 1000u) {
+        i++;
+    }
+    atomic_fetch_add_explicit(&h->buckets[i], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum_ns, ns, memory_order_relaxed);
+}
+
+static uint64_t counter_get(const metric_counter_t *c)
+{
+    return atomic_load_explicit(&((metric_counter_t *)c)->value, memory_order_relaxed);
+}
+
+static int64_t gauge_get(const metric_gauge_t *g)
+{
+    return atomic_load_explicit(&((metric_gauge_t *)g)->value, memory_order_relaxed);
+}
+
+/* Cópia cumulativa (cum[i] = observações <= bounds[i]; cum[BUCKETS] = total) */
+static void histogram_snapshot(const metric_histogram_t *h, uint64_t cum[DAEMON_METRICS_BUCKETS + 1], uint64_t *sum_ns)
+{
+    metric_histogram_t *m = (metric_histogram_t *)h;
+    uint64_t total = 0;
+    for (size_t i = 0; i <= DAEMON_METRICS_BUCKETS; i++) {
+        total += atomic_load_explicit(&m->buckets[i], memory_order_relaxed);
+        cum[i] = total;
+    }
+    *sum_ns = atomic_load_explicit(&m->sum_ns, memory_order_relaxed);
+}
+
+static int i2c_slot(uint8_t addr, size_t len)
+{
+    for (size_t i = 0; i < I2C_SLOT_COUNT; i++) {
+        if (k_i2c_slots[i].addr == addr && k_i2c_slots[i].len == len) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/* ============================================
+ * Registro
+ * ============================================ */
+uint64_t daemon_metrics_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void daemon_metrics_set_i2c_bus(const char *device)
+{
+    snprintf(g_i2c_bus, sizeof(g_i2c_bus), "%s", device ? device : "");
+
+    /* Valor de rótulo Prometheus: escapa \\ e " */
+    size_t n = 0;
+    n += (size_t)snprintf(g_i2c_bus_label, sizeof(g_i2c_bus_label), "bus=\"");
+    for (const char *c = g_i2c_bus; *c && n + 4 < sizeof(g_i2c_bus_label); c++) {
+        if (*c == '\\' || *c == '"') {
+            g_i2c_bus_label[n++] = '\\';
+        }
+        g_i2c_bus_label[n++] = *c;
+    }
+    g_i2c_bus_label[n++] = '"';
+    g_i2c_bus_label[n] = '\0';
+}
+
+void daemon_metrics_i2c(uint8_t addr, size_t len, daemon_i2c_result_t result, uint64_t elapsed_ns)
+{
+    int i = i2c_slot(addr, len);
+    if (i < 0 || (unsigned)result >= DAEMON_I2C_RESULT_COUNT) {
+        return;
+    }
+    counter_add(&g_i2c_transactions[i], 1);
+    if (result == DAEMON_I2C_OK) {
+        counter_add(&g_i2c_bytes[i], len);
+    } else {
+        counter_add(&g_i2c_errors[i][result], 1);
+    }
+    histogram_observe(&g_i2c_latency[i], k_i2c_bounds_us, elapsed_ns);
+}
+
+void daemon_metrics_i2c_health(unsigned score)
+{
+    atomic_store_explicit(&g_i2c_health.value, (int64_t)score, memory_order_relaxed);
+}
+
+void daemon_metrics_fsm_transition(sfp_daemon_state_t from, sfp_daemon_state_t to)
+{
+    if ((unsigned)from < FSM_STATE_COUNT && (unsigned)to < FSM_STATE_COUNT) {
+        counter_add(&g_fsm_transitions[from][to], 1);
+    }
+}
+
+void daemon_metrics_loop(uint64_t expected_us, uint64_t actual_us)
+{
+    uint64_t jitter_us = actual_us > expected_us ? actual_us - expected_us : expected_us - actual_us;
+    histogram_observe(&g_loop_jitter, k_loop_bounds_us, jitter_us * 1000u);
+}
+
+void daemon_metrics_socket_accept(void)
+{
+    counter_add(&g_socket_accepts, 1);
+    gauge_add(&g_socket_clients, 1);
+}
+
+void daemon_metrics_socket_close(void)
+{
+    counter_add(&g_socket_closes, 1);
+    gauge_add(&g_socket_clients, -1);
+}
+
+void daemon_metrics_set_subscribers(unsigned count)
+{
+    atomic_store_explicit(&g_socket_subscribers.value, (int64_t)count, memory_order_relaxed);
+}
+
+void daemon_metrics_command(daemon_metrics_command_t command, uint64_t elapsed_ns)
+{
+    if ((unsigned)command >= DAEMON_CMD_COUNT) {
+        command = DAEMON_CMD_INVALID;
+    }
+    counter_add(&g_commands[command], 1);
+    histogram_observe(&g_command_duration[command], k_command_bounds_us, elapsed_ns);
+}
+
+/* ============================================
+ * Exportação JSON
+ * ============================================ */
+static void json_series_value(daemon_json_t *w, const char *key, const metric_series_t *series)
+{
+    switch (series->family->kind) {
+        case METRIC_COUNTER:
+            daemon_json_uint(w, key, counter_get(series->value));
+            break;
+        case METRIC_GAUGE:
+            daemon_json_int(w, key, gauge_get(series->value));
+            break;
+        case METRIC_HISTOGRAM: {
+            uint64_t cum[DAEMON_METRICS_BUCKETS + 1];
+            uint64_t sum_ns;
+            histogram_snapshot(series->value, cum, &sum_ns);
+
+            daemon_json_object_begin(w, key);
+            daemon_json_uint(w, "count", cum[DAEMON_METRICS_BUCKETS]);
+            daemon_json_number(w, "sum_us", (double)sum_ns / 1000.0);
+            daemon_json_array_begin(w, "le_us");
+            for (size_t i = 0; i < DAEMON_METRICS_BUCKETS; i++) {
+                daemon_json_uint(w, NULL, series->family->bounds_us[i]);
+            }
+            daemon_json_array_end(w);
+            daemon_json_array_begin(w, "buckets");   /* Cumulativos; o último é +Inf */
+            for (size_t i = 0; i <= DAEMON_METRICS_BUCKETS; i++) {
+                daemon_json_uint(w, NULL, cum[i]);
+            }
+            daemon_json_array_end(w);
+            daemon_json_object_end(w);
+            break;
+        }
+    }
+}
+
+size_t daemon_metrics_render_json(char *buf, size_t cap)
+{
+    daemon_json_t w;
+    daemon_json_init(&w, buf, cap);
+    daemon_json_object_begin(&w, NULL);
+    daemon_json_string(&w, "status", "ok");
+    daemon_json_object_begin(&w, "metrics");
+    daemon_json_string(&w, "i2c_bus", g_i2c_bus);
+
+    for (size_t i = 0; i < REGISTRY_SIZE; ) {
+        const metric_family_t *family = k_registry[i].family;
+        const char *name = family->name + strlen(METRIC_NAME_PREFIX);
+
+        if (!k_registry[i].key) {
+            json_series_value(&w, name, &k_registry[i]);
+            i++;
+            continue;
+        }
+
+        /* Família com rótulos: objeto chave → valor */
+        daemon_json_object_begin(&w, name);
+        for (; i < REGISTRY_SIZE && k_registry[i].family == family; i++) {
+            json_series_value(&w, k_registry[i].key, &k_registry[i]);
+        }
+        daemon_json_object_end(&w);
+    }
+
+    daemon_json_object_end(&w);
+    daemon_json_object_end(&w);
+    return daemon_json_finish(&w);
+}
+
+/* ============================================
+ * Exportação Prometheus
+ * ============================================ */
+typedef struct {
+    char *buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+} prom_writer_t;
+
+static void prom_printf(prom_writer_t *p, const char *fmt, ...)
+{
+    if (p->overflow) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(p->buf + p->len, p->cap - p->len, fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= p->cap - p->len) {
+        p->overflow = true;
+        return;
+    }
+    p->len += (size_t)n;
+}
+
+/* Rótulos da série: bus (famílias I²C), os da série e um extra opcional (le do histograma) */
+static void prom_labels(prom_writer_t *p, const metric_series_t *series, const char *extra)
+{
+    const char *parts[3] = {
+        series->family->bus_label && g_i2c_bus_label[0] ? g_i2c_bus_label : NULL,
+        series->labels,
+        extra
+    };
+    const char *sep = "{";
+    for (size_t i = 0; i < 3; i++) {
+        if (parts[i]) {
+            prom_printf(p, "%s%s", sep, parts[i]);
+            sep = ",";
+        }
+    }
+    if (sep[0] == ',') {
+        prom_printf(p, "}");
+    }
+}
+
+size_t daemon_metrics_render_prometheus(char *buf, size_t cap)
+{
+    prom_writer_t p = { buf, cap, 0, false };
+    static const char *const kind_names[] = { "counter", "gauge", "histogram" };
+
+    const metric_family_t *current = NULL;
+    for (size_t i = 0; i < REGISTRY_SIZE; i++) {
+        const metric_series_t *series = &k_registry[i];
+        const metric_family_t *family = series->family;
+
+        if (family != current) {
+            prom_printf(&p, "# HELP %s %s\n# TYPE %s %s\n", family->name, family->help, family->name, kind_names[family->kind]);
+            current = family;
+        }
+
+        switch (family->kind) {
+            case METRIC_COUNTER:
+                prom_printf(&p, "%s", family->name);
+                prom_labels(&p, series, NULL);
+                prom_printf(&p, " %llu\n", (unsigned long long)counter_get(series->value));
+                break;
+            case METRIC_GAUGE:
+                prom_printf(&p, "%s", family->name);
+                prom_labels(&p, series, NULL);
+                prom_printf(&p, " %lld\n", (long long)gauge_get(series->value));
+                break;
+            case METRIC_HISTOGRAM: {
+                uint64_t cum[DAEMON_METRICS_BUCKETS + 1];
+                uint64_t sum_ns;
+                histogram_snapshot(series->value, cum, &sum_ns);
+
+                for (size_t b = 0; b <= DAEMON_METRICS_BUCKETS; b++) {
+                    char le[32];
+                    if (b < DAEMON_METRICS_BUCKETS) {
+                        snprintf(le, sizeof(le), "le=\"%g\"", family->bounds_us[b] / 1e6);
+                    } else {
+                        snprintf(le, sizeof(le), "le=\"+Inf\"");
+                    }
+                    prom_printf(&p, "%s_bucket", family->name);
+                    prom_labels(&p, series, le);
+                    prom_printf(&p, " %llu\n", (unsigned long long)cum[b]);
+                }
+                prom_printf(&p, "%s_sum", family->name);
+                prom_labels(&p, series, NULL);
+                prom_printf(&p, " %.9f\n", (double)sum_ns / 1e9);
+                prom_printf(&p, "%s_count", family->name);
+                prom_labels(&p, series, NULL);
+                prom_printf(&p, " %llu\n", (unsigned long long)cum[DAEMON_METRICS_BUCKETS]);
+                break;
+            }
+        }
+    }
+
+    return p.overflow ? 0 : p.len;
+}
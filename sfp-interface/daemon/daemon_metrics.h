@@ -0,0 +1,117 @@
+/**
+ * @file daemon_metrics.h
+ * @brief Registro de métricas do daemon (contadores, gauges e histogramas)
+ *
+ * Todas as séries são variáveis atômicas estáticas atualizadas com
+ * operações relaxed: registrar uma métrica nunca bloqueia nem aloca. O
+ * comando STATS do socket exporta o registro em JSON ou no formato texto
+ * do Prometheus.
+ */
+
+#ifndef DAEMON_METRICS_H
+#define DAEMON_METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "daemon_state.h"
+#include "daemon_i2c.h"
+
+/* Limites dos buckets de cada histograma (o último bucket é +Inf) */
+#define DAEMON_METRICS_BUCKETS 12
+
+/* ============================================
+ * Comandos do Socket (rótulo command=…)
+ * ============================================ */
+typedef enum {
+    DAEMON_CMD_GET_CURRENT,
+    DAEMON_CMD_GET_STATIC,
+    DAEMON_CMD_GET_DYNAMIC,
+    DAEMON_CMD_GET_STATE,
+    DAEMON_CMD_GET_FIELDS,
+    DAEMON_CMD_GET_STATS,
+    DAEMON_CMD_GET_ALARMS,
+    DAEMON_CMD_GET_TREND,
+    DAEMON_CMD_REFERENCE,
+    DAEMON_CMD_RESET_HOLD,
+    DAEMON_CMD_PING,
+    DAEMON_CMD_SUBSCRIBE,
+    DAEMON_CMD_UNSUBSCRIBE,
+    DAEMON_CMD_FORMAT,
+    DAEMON_CMD_FRAMING,
+    DAEMON_CMD_STATS,
+    DAEMON_CMD_INVALID,
+    DAEMON_CMD_COUNT
+} daemon_metrics_command_t;
+
+/* ============================================
+ * Registro
+ * ============================================ */
+
+/**
+ * @brief Relógio monotônico em nanossegundos (base das medições)
+ */
+uint64_t daemon_metrics_now_ns(void);
+
+/**
+ * @brief Nome do barramento (rótulo bus=…), ex.: "/dev/i2c-1"
+ */
+void daemon_metrics_set_i2c_bus(const char *device);
+
+/**
+ * @brief Registra uma transação I²C
+ * @param addr Endereço do dispositivo (0x50 ou 0x51)
+ * @param len Bytes pedidos (1 no probe de presença, 128 na leitura de bloco);
+ *            pares (addr, len) fora desses são ignorados
+ * @param result Resultado classificado
+ * @param elapsed_ns Duração da transação
+ */
+void daemon_metrics_i2c(uint8_t addr, size_t len, daemon_i2c_result_t result, uint64_t elapsed_ns);
+
+/**
+ * @brief Nota de saúde do barramento (gauge, 0–100)
+ */
+void daemon_metrics_i2c_health(unsigned score);
+
+/**
+ * @brief Registra uma transição da FSM
+ */
+void daemon_metrics_fsm_transition(sfp_daemon_state_t from, sfp_daemon_state_t to);
+
+/**
+ * @brief Registra o período de uma volta do loop principal
+ * @param expected_us Período esperado (passo da FSM)
+ * @param actual_us Período medido
+ */
+void daemon_metrics_loop(uint64_t expected_us, uint64_t actual_us);
+
+void daemon_metrics_socket_accept(void);
+void daemon_metrics_socket_close(void);
+
+/**
+ * @brief Número de assinantes de SUBSCRIBE DYNAMIC (gauge)
+ */
+void daemon_metrics_set_subscribers(unsigned count);
+
+/**
+ * @brief Registra um comando do socket e o tempo para montar a resposta
+ */
+void daemon_metrics_command(daemon_metrics_command_t command, uint64_t elapsed_ns);
+
+/* ============================================
+ * Exportação
+ * ============================================ */
+
+/**
+ * @brief Exporta o registro em JSON compacto
+ * @return Bytes escritos, ou 0 se não coube
+ */
+size_t daemon_metrics_render_json(char *buf, size_t cap);
+
+/**
+ * @brief Exporta o registro no formato texto do Prometheus (0.0.4)
+ * @return Bytes escritos, ou 0 se não coube
+ */
+size_t daemon_metrics_render_prometheus(char *buf, size_t cap);
+
+#endif /* DAEMON_METRICS_H */
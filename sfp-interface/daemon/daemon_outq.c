@@ -0,0 +1,250 @@
+/**
+ * @file daemon_outq.c
+ * @brief Implementação da fila de saída por cliente
+ */
+
+#define _DEFAULT_SOURCE
+#include "daemon_outq.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+/* ============================================
+ * Chunks
+ * ============================================ */
+/* Chunks livres de DAEMON_CHUNK_POOL_CAP bytes guardados para reuso: em
+ * regime o caminho de resposta não chama malloc/free. Só a thread
+ * principal (socket) mexe em chunks, então o pool não tem lock. */
+static daemon_chunk_t *g_chunk_pool[DAEMON_CHUNK_POOL_MAX];
+static unsigned g_chunk_pool_count = 0;
+
+daemon_chunk_t *daemon_chunk_new(size_t cap)
+{
+    if (cap <= DAEMON_CHUNK_POOL_CAP) {
+        if (g_chunk_pool_count > 0) {
+            daemon_chunk_t *chunk = g_chunk_pool[--g_chunk_pool_count];
+            chunk->refs = 1;
+            chunk->len = 0;
+            return chunk;
+        }
+        cap = DAEMON_CHUNK_POOL_CAP;
+    }
+
+    daemon_chunk_t *chunk = malloc(sizeof(daemon_chunk_t));
+    if (!chunk) {
+        return NULL;
+    }
+
+    chunk->data = malloc(cap > 0 ? cap : 1);
+    if (!chunk->data) {
+        free(chunk);
+        return NULL;
+    }
+
+    chunk->refs = 1;
+    chunk->len = 0;
+    chunk->cap = cap;
+    return chunk;
+}
+
+daemon_chunk_t *daemon_chunk_ref(daemon_chunk_t *chunk)
+{
+    if (chunk) {
+        chunk->refs++;
+    }
+    return chunk;
+}
+
+void daemon_chunk_unref(daemon_chunk_t *chunk)
+{
+    if (!chunk) {
+        return;
+    }
+
+    if (--chunk->refs == 0) {
+        if (chunk->cap == DAEMON_CHUNK_POOL_CAP && g_chunk_pool_count < DAEMON_CHUNK_POOL_MAX) {
+            g_chunk_pool[g_chunk_pool_count++] = chunk;
+            return;
+        }
+        free(chunk->data);
+        free(chunk);
+    }
+}
+
+/* ============================================
+ * Fila
+ * ============================================ */
+void daemon_outq_init(daemon_outq_t *q)
+{
+    if (!q) {
+        return;
+    }
+
+    memset(q, 0, sizeof(daemon_outq_t));
+}
+
+void daemon_outq_clear(daemon_outq_t *q)
+{
+    if (!q) {
+        return;
+    }
+
+    for (unsigned i = 0; i < q->count; i++) {
+        daemon_outq_seg_t *seg = &q->segs[(q->head + i) % DAEMON_OUTQ_MAX_SEGS];
+        daemon_chunk_unref(seg->chunk);
+        seg->chunk = NULL;
+    }
+
+    q->head = 0;
+    q->count = 0;
+    q->bytes = 0;
+}
+
+bool daemon_outq_has_room(const daemon_outq_t *q, unsigned segs)
+{
+    return q && q->count + segs <= DAEMON_OUTQ_MAX_SEGS;
+}
+
+/* Reserva o próximo segmento livre no fim da fila */
+static daemon_outq_seg_t *outq_tail(daemon_outq_t *q, uint64_t now_ms)
+{
+    if (q->count >= DAEMON_OUTQ_MAX_SEGS) {
+        return NULL;
+    }
+
+    /* Fila vazia: o prazo de stall começa a contar agora */
+    if (q->count == 0) {
+        q->last_progress_ms = now_ms;
+    }
+
+    daemon_outq_seg_t *seg = &q->segs[(q->head + q->count) % DAEMON_OUTQ_MAX_SEGS];
+    q->count++;
+    return seg;
+}
+
+bool daemon_outq_push_static(daemon_outq_t *q, const char *data, size_t len, uint64_t now_ms)
+{
+    if (!q || !data) {
+        return false;
+    }
+    if (len == 0) {
+        return true;
+    }
+
+    daemon_outq_seg_t *seg = outq_tail(q, now_ms);
+    if (!seg) {
+        return false;
+    }
+
+    seg->chunk = NULL;
+    seg->data = data;
+    seg->len = len;
+    q->bytes += len;
+    return true;
+}
+
+bool daemon_outq_push_copy(daemon_outq_t *q, const char *data, size_t len, uint64_t now_ms)
+{
+    if (!q || !data || len > DAEMON_OUTQ_INLINE_SIZE) {
+        return false;
+    }
+    if (len == 0) {
+        return true;
+    }
+
+    daemon_outq_seg_t *seg = outq_tail(q, now_ms);
+    if (!seg) {
+        return false;
+    }
+
+    memcpy(seg->inline_buf, data, len);
+    seg->chunk = NULL;
+    seg->data = seg->inline_buf;
+    seg->len = len;
+    q->bytes += len;
+    return true;
+}
+
+bool daemon_outq_push_chunk(daemon_outq_t *q, daemon_chunk_t *chunk, uint64_t now_ms)
+{
+    if (!q || !chunk) {
+        return false;
+    }
+    if (chunk->len == 0) {
+        return true;
+    }
+
+    daemon_outq_seg_t *seg = outq_tail(q, now_ms);
+    if (!seg) {
+        return false;
+    }
+
+    seg->chunk = daemon_chunk_ref(chunk);
+    seg->data = chunk->data;
+    seg->len = chunk->len;
+    q->bytes += chunk->len;
+    return true;
+}
+
+/* ============================================
+ * Envio (sendmsg com iovec de todos os segmentos)
+ * ============================================ */
+ssize_t daemon_outq_flush(daemon_outq_t *q, int fd, uint64_t now_ms)
+{
+    if (!q || fd < 0) {
+        return -1;
+    }
+    if (q->count == 0) {
+        return 0;
+    }
+
+    struct iovec iov[DAEMON_OUTQ_MAX_SEGS];
+    for (unsigned i = 0; i < q->count; i++) {
+        const daemon_outq_seg_t *seg = &q->segs[(q->head + i) % DAEMON_OUTQ_MAX_SEGS];
+        iov[i].iov_base = (void *)seg->data;
+        iov[i].iov_len = seg->len;
+    }
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = q->count;
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+    } while (sent < 0 && errno == EINTR);
+
+    if (sent < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+
+    /* Consome segmentos enviados; o último pode ter saído pela metade */
+    size_t remaining = (size_t)sent;
+    while (remaining > 0 && q->count > 0) {
+        daemon_outq_seg_t *seg = &q->segs[q->head];
+        if (remaining < seg->len) {
+            seg->data += remaining;
+            seg->len -= remaining;
+            break;
+        }
+
+        remaining -= seg->len;
+        daemon_chunk_unref(seg->chunk);
+        seg->chunk = NULL;
+        q->head = (q->head + 1) % DAEMON_OUTQ_MAX_SEGS;
+        q->count--;
+    }
+
+    q->bytes -= (size_t)sent;
+    if (sent > 0) {
+        q->last_progress_ms = now_ms;
+    }
+    if (q->count == 0) {
+        q->head = 0;
+    }
+
+    return sent;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file daemon_outq.h
+ * @brief Fila de saída por cliente (scatter/gather com escrita parcial)
+ */
+
+#ifndef DAEMON_OUTQ_H
+#define DAEMON_OUTQ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+/* ============================================
+ * Limites da Fila
+ * ============================================ */
+#define DAEMON_OUTQ_MAX_SEGS 64       /* Segmentos pendentes por cliente (<= IOV_MAX) */
+#define DAEMON_OUTQ_INLINE_SIZE 80    /* Bytes copiados dentro do próprio segmento (cabeçalho binário + status line) */
+#define DAEMON_CHUNK_POOL_CAP 16384   /* Capacidade dos chunks reaproveitados (maior resposta JSON) */
+#define DAEMON_CHUNK_POOL_MAX 64      /* Chunks livres mantidos no pool */
+
+/* ============================================
+ * Chunk: buffer com contagem de referências
+ * ============================================ */
+
+/* Um chunk pode estar na fila de vários clientes ao mesmo tempo;
+ * é liberado quando a última referência é solta. */
+typedef struct {
+    uint32_t refs;
+    size_t len;
+    size_t cap;
+    char *data;
+} daemon_chunk_t;
+
+/* ============================================
+ * Segmento e Fila
+ * ============================================ */
+typedef struct {
+    daemon_chunk_t *chunk;                  /* NULL: bytes estáticos ou em inline_buf */
+    const char *data;
+    size_t len;
+    char inline_buf[DAEMON_OUTQ_INLINE_SIZE];
+} daemon_outq_seg_t;
+
+typedef struct {
+    daemon_outq_seg_t segs[DAEMON_OUTQ_MAX_SEGS];
+    unsigned head;                /* Índice do primeiro segmento pendente */
+    unsigned count;               /* Segmentos pendentes */
+    size_t bytes;                 /* Bytes pendentes */
+    uint64_t last_progress_ms;    /* Último envio (ou enfileiramento com fila vazia) */
+} daemon_outq_t;
+
+/* ============================================
+ * Funções de Chunk
+ * ============================================ */
+
+/**
+ * @brief Obtém chunk vazio com capacidade fixa
+ * @param cap Capacidade mínima em bytes (até DAEMON_CHUNK_POOL_CAP vem do
+ *            pool de chunks livres, com cap = DAEMON_CHUNK_POOL_CAP)
+ * @return Chunk com uma referência, ou NULL se falhar
+ */
+daemon_chunk_t *daemon_chunk_new(size_t cap);
+
+/**
+ * @brief Adiciona uma referência ao chunk
+ * @param chunk Chunk
+ * @return O próprio chunk
+ */
+daemon_chunk_t *daemon_chunk_ref(daemon_chunk_t *chunk);
+
+/**
+ * @brief Solta uma referência; na última o chunk volta ao pool ou é liberado
+ * @param chunk Chunk (NULL é ignorado)
+ */
+void daemon_chunk_unref(daemon_chunk_t *chunk);
+
+/* ============================================
+ * Funções da Fila
+ * ============================================ */
+
+/**
+ * @brief Inicializa fila vazia
+ * @param q Fila
+ */
+void daemon_outq_init(daemon_outq_t *q);
+
+/**
+ * @brief Descarta todos os segmentos pendentes
+ * @param q Fila
+ */
+void daemon_outq_clear(daemon_outq_t *q);
+
+/**
+ * @brief Verifica se cabem mais segmentos na fila
+ * @param q Fila
+ * @param segs Número de segmentos desejados
+ * @return true se há espaço
+ */
+bool daemon_outq_has_room(const daemon_outq_t *q, unsigned segs);
+
+/**
+ * @brief Enfileira bytes de armazenamento estático (não copiados)
+ * @param q Fila
+ * @param data Bytes com tempo de vida estático
+ * @param len Tamanho
+ * @param now_ms Relógio monotônico atual (ms)
+ * @return true se enfileirado, false se a fila está cheia
+ */
+bool daemon_outq_push_static(daemon_outq_t *q, const char *data, size_t len, uint64_t now_ms);
+
+/**
+ * @brief Enfileira cópia de bytes curtos (até DAEMON_OUTQ_INLINE_SIZE)
+ * @param q Fila
+ * @param data Bytes a copiar
+ * @param len Tamanho
+ * @param now_ms Relógio monotônico atual (ms)
+ * @return true se enfileirado, false se a fila está cheia ou len excede o limite
+ */
+bool daemon_outq_push_copy(daemon_outq_t *q, const char *data, size_t len, uint64_t now_ms);
+
+/**
+ * @brief Enfileira o conteúdo de um chunk (a fila adiciona sua própria referência)
+ * @param q Fila
+ * @param chunk Chunk
+ * @param now_ms Relógio monotônico atual (ms)
+ * @return true se enfileirado, false se a fila está cheia
+ */
+bool daemon_outq_push_chunk(daemon_outq_t *q, daemon_chunk_t *chunk, uint64_t now_ms);
+
+/**
+ * @brief Envia o máximo possível com um único sendmsg() (non-blocking)
+ * @param q Fila
+ * @param fd Socket do cliente
+ * @param now_ms Relógio monotônico atual (ms)
+ * @return Bytes enviados (0 se o socket está cheio), ou -1 em erro fatal
+ */
+ssize_t daemon_outq_flush(daemon_outq_t *q, int fd, uint64_t now_ms);
+
+#endif /* DAEMON_OUTQ_H */
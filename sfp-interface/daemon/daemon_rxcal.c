@@ -0,0 +1,326 @@
+/**
+ * @file daemon_rxcal.c
+ * @brief Implementação das tabelas de calibração de RX power
+ */
+
+#define _DEFAULT_SOURCE
+#include "daemon_rxcal.h"
+#include "../sfp_dbm.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+
+/* ============================================
+ * Tabelas Registradas
+ * ============================================ */
+static daemon_rxcal_table_t g_tables[DAEMON_RXCAL_MAX_TABLES];
+static size_t g_table_count = 0;
+
+/* Offset fixo legado: vale quando nenhuma tabela casa com o módulo */
+static float g_default_offset_dbm = 0.0f;
+
+static daemon_rxcal_temp_comp_t g_temp_comps[DAEMON_RXCAL_MAX_TEMP_COMP];
+static size_t g_temp_comp_count = 0;
+
+/* ============================================
+ * Parse e Compilação
+ * ============================================ */
+bool daemon_rxcal_parse(const char *spec, daemon_rxcal_table_t *table)
+{
+    if (!spec || !table) {
+        return false;
+    }
+
+    memset(table, 0, sizeof(*table));
+
+    /* Chave: <wavelength_nm>[:<vendor_pn>] */
+    char *end;
+    unsigned long nm = strtoul(spec, &end, 10);
+    if (end == spec || nm == 0 || nm > UINT16_MAX) {
+        return false;
+    }
+    table->wavelength_nm = (uint16_t)nm;
+
+    const char *p = end;
+    if (*p == ':') {
+        p++;
+        size_t len = strcspn(p, " \t");
+        if (len == 0 || len >= sizeof(table->vendor_pn)) {
+            return false;
+        }
+        memcpy(table->vendor_pn, p, len);
+        p += len;
+    }
+
+    /* Pontos: <lido>:<referência>, mantidos em ordem crescente de lido */
+    for (;;) {
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0') {
+            break;
+        }
+        if (table->n_points == DAEMON_RXCAL_MAX_POINTS) {
+            return false;
+        }
+
+        float raw = strtof(p, &end);
+        if (end == p || *end != ':') {
+            return false;
+        }
+        p = end + 1;
+        float ref = strtof(p, &end);
+        if (end == p || !isfinite(raw) || !isfinite(ref)) {
+            return false;
+        }
+        p = end;
+
+        unsigned i = table->n_points;
+        while (i > 0 && table->raw_dbm[i - 1] > raw) {
+            table->raw_dbm[i] = table->raw_dbm[i - 1];
+            table->ref_dbm[i] = table->ref_dbm[i - 1];
+            i--;
+        }
+        if (i > 0 && table->raw_dbm[i - 1] == raw) {
+            return false;  /* Mesmo valor lido duas vezes */
+        }
+        table->raw_dbm[i] = raw;
+        table->ref_dbm[i] = ref;
+        table->n_points++;
+    }
+
+    if (table->n_points == 0) {
+        return false;
+    }
+
+    for (unsigned i = 0; i + 1 < table->n_points; i++) {
+        table->slope[i] = (table->ref_dbm[i + 1] - table->ref_dbm[i])
+                        / (table->raw_dbm[i + 1] - table->raw_dbm[i]);
+    }
+    return true;
+}
+
+/* ============================================
+ * Registro
+ * ============================================ */
+void daemon_rxcal_init(const daemon_rxcal_table_t *tables, size_t count)
+{
+    g_table_count = 0;
+    if (tables) {
+        if (count > DAEMON_RXCAL_MAX_TABLES) {
+            count = DAEMON_RXCAL_MAX_TABLES;
+        }
+        memcpy(g_tables, tables, count * sizeof(*tables));
+        g_table_count = count;
+    }
+
+    const char *offset_env = getenv("RX_POWER_OFFSET_DBM");
+    if (offset_env) {
+        g_default_offset_dbm = strtof(offset_env, NULL);
+        syslog(LOG_INFO, "RX power offset: %.2f dBm", g_default_offset_dbm);
+    }
+
+    if (g_table_count > 0) {
+        syslog(LOG_INFO, "RX calibration tables loaded: %zu", g_table_count);
+    }
+}
+
+/* ============================================
+ * Escolha da Tabela (uma vez por módulo)
+ * ============================================ */
+
+/* Vendor PN do A0h: 16 bytes completados com espaços */
+static void module_pn(const sfp_a0h_base_t *a0, char pn[DAEMON_RXCAL_PN_SIZE])
+{
+    const char *vendor_pn = NULL;
+    size_t pn_len = 0;
+    if (sfp_a0_get_vendor_pn(a0, &vendor_pn)) {
+        memcpy(pn, vendor_pn, DAEMON_RXCAL_PN_SIZE - 1);
+        pn_len = DAEMON_RXCAL_PN_SIZE - 1;
+        while (pn_len > 0 && (pn[pn_len - 1] == ' ' || pn[pn_len - 1] == '\0')) {
+            pn_len--;
+        }
+    }
+    pn[pn_len] = '\0';
+}
+
+const daemon_rxcal_table_t *daemon_rxcal_select(const sfp_a0h_base_t *a0)
+{
+    uint16_t nm;
+    if (g_table_count == 0 || !sfp_a0_get_wavelength_nm(a0, &nm)) {
+        return NULL;
+    }
+
+    char pn[DAEMON_RXCAL_PN_SIZE];
+    module_pn(a0, pn);
+
+    const daemon_rxcal_table_t *by_wavelength = NULL;
+    for (size_t i = 0; i < g_table_count; i++) {
+        const daemon_rxcal_table_t *t = &g_tables[i];
+        if (t->wavelength_nm != nm) {
+            continue;
+        }
+        if (t->vendor_pn[0] == '\0') {
+            if (!by_wavelength) {
+                by_wavelength = t;
+            }
+        } else if (strcmp(t->vendor_pn, pn) == 0) {
+            syslog(LOG_INFO, "RX calibration: %u nm, PN %s (%u points)",
+                   nm, t->vendor_pn, t->n_points);
+            return t;
+        }
+    }
+
+    if (by_wavelength) {
+        syslog(LOG_INFO, "RX calibration: %u nm (%u points)", nm, by_wavelength->n_points);
+    }
+    return by_wavelength;
+}
+
+/* ============================================
+ * Correção por Amostra
+ * ============================================ */
+float daemon_rxcal_apply(const daemon_rxcal_table_t *table, float dbm)
+{
+    /* Piso = sem luz: corrigido viraria uma leitura plausível (hold, alarmes) */
+    if (dbm <= SFP_DBM_FLOOR) {
+        return dbm;
+    }
+    if (!table) {
+        return dbm + g_default_offset_dbm;
+    }
+
+    unsigned last = table->n_points - 1u;
+    if (dbm <= table->raw_dbm[0]) {
+        return dbm + (table->ref_dbm[0] - table->raw_dbm[0]);
+    }
+    if (dbm >= table->raw_dbm[last]) {
+        return dbm + (table->ref_dbm[last] - table->raw_dbm[last]);
+    }
+
+    /* raw_dbm[lo] <= dbm < raw_dbm[hi] */
+    unsigned lo = 0;
+    unsigned hi = last;
+    while (hi - lo > 1) {
+        unsigned mid = (lo + hi) / 2;
+        if (table->raw_dbm[mid] <= dbm) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return table->ref_dbm[lo] + table->slope[lo] * (dbm - table->raw_dbm[lo]);
+}
+
+/* ============================================
+ * Compensação de Temperatura
+ * ============================================ */
+bool daemon_rxcal_parse_temp_comp(const char *spec, daemon_rxcal_temp_comp_t *comp)
+{
+    if (!spec || !comp) {
+        return false;
+    }
+
+    memset(comp, 0, sizeof(*comp));
+
+    /* Chave: <vendor_pn> */
+    const char *p = spec;
+    size_t len = strcspn(p, " \t");
+    if (len == 0 || len >= sizeof(comp->vendor_pn)) {
+        return false;
+    }
+    memcpy(comp->vendor_pn, p, len);
+    p += len;
+
+    /* <t_ref> <t_min>:<t_max> */
+    char *end;
+    comp->t_ref_c = strtof(p, &end);
+    if (end == p) {
+        return false;
+    }
+    p = end;
+    comp->t_min_c = strtof(p, &end);
+    if (end == p || *end != ':') {
+        return false;
+    }
+    p = end + 1;
+    comp->t_max_c = strtof(p, &end);
+    if (end == p || !(comp->t_min_c < comp->t_max_c)) {
+        return false;
+    }
+    p = end;
+
+    /* <c1> [<c2> [<c3>]] */
+    for (;;) {
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0') {
+            break;
+        }
+        if (comp->degree == DAEMON_RXCAL_TEMP_COMP_DEGREE) {
+            return false;
+        }
+        float c = strtof(p, &end);
+        if (end == p || !isfinite(c)) {
+            return false;
+        }
+        comp->coef[comp->degree++] = c;
+        p = end;
+    }
+    return comp->degree > 0;
+}
+
+void daemon_rxcal_init_temp_comp(const daemon_rxcal_temp_comp_t *comps, size_t count)
+{
+    g_temp_comp_count = 0;
+    if (comps) {
+        if (count > DAEMON_RXCAL_MAX_TEMP_COMP) {
+            count = DAEMON_RXCAL_MAX_TEMP_COMP;
+        }
+        memcpy(g_temp_comps, comps, count * sizeof(*comps));
+        g_temp_comp_count = count;
+    }
+
+    if (g_temp_comp_count > 0) {
+        syslog(LOG_INFO, "RX temperature compensation models loaded: %zu", g_temp_comp_count);
+    }
+}
+
+const daemon_rxcal_temp_comp_t *daemon_rxcal_select_temp_comp(const sfp_a0h_base_t *a0)
+{
+    if (g_temp_comp_count == 0) {
+        return NULL;
+    }
+
+    char pn[DAEMON_RXCAL_PN_SIZE];
+    module_pn(a0, pn);
+    for (size_t i = 0; i < g_temp_comp_count; i++) {
+        const daemon_rxcal_temp_comp_t *c = &g_temp_comps[i];
+        if (strcmp(c->vendor_pn, pn) == 0) {
+            syslog(LOG_INFO, "RX temperature compensation: PN %s (degree %u, ref %.1f C)",
+                   c->vendor_pn, c->degree, c->t_ref_c);
+            return c;
+        }
+    }
+    return NULL;
+}
+
+float daemon_rxcal_temp_comp_apply(const daemon_rxcal_temp_comp_t *comp, float dbm, float temp_c)
+{
+    if (!comp || dbm <= SFP_DBM_FLOOR || !isfinite(temp_c)) {
+        return dbm;
+    }
+
+    /* Fora da faixa do ajuste o polinômio não vale: satura no extremo */
+    if (temp_c < comp->t_min_c) {
+        temp_c = comp->t_min_c;
+    } else if (temp_c > comp->t_max_c) {
+        temp_c = comp->t_max_c;
+    }
+
+    /* Horner: x·(c1 + x·(c2 + x·c3)) */
+    float x = temp_c - comp->t_ref_c;
+    float d = 0.0f;
+    for (int k = comp->degree - 1; k >= 0; k--) {
+        d = (d + comp->coef[k]) * x;
+    }
+    return dbm - d;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file daemon_rxcal.h
+ * @brief Tabelas de calibração de RX power por comprimento de onda / PN
+ *
+ * Cada tabela vem de uma linha rx_cal= do arquivo de configuração:
+ *
+ *   rx_cal=<wavelength_nm>[:<vendor_pn>] <lido_dbm>:<referência_dbm> ...
+ *
+ * Na carga os pontos são ordenados e a inclinação de cada segmento é
+ * pré-calculada. Na inserção do módulo (publish do A0h) a tabela é
+ * escolhida uma vez; a correção por amostra é busca binária + lerp.
+ * Fora da faixa da tabela vale o offset do ponto extremo.
+ *
+ * Módulos baratos também desviam a leitura de RX com a própria
+ * temperatura. Uma linha rx_temp_comp= por Vendor PN descreve esse desvio
+ * (ajustado offline por tools/sfp-tcomp-fit a partir de uma gravação):
+ *
+ *   rx_temp_comp=<vendor_pn> <t_ref_c> <t_min_c>:<t_max_c> <c1> [<c2> [<c3>]]
+ *
+ * d(T) = c1·x + c2·x² + c3·x³, com x = T - t_ref e T limitado à faixa do
+ * ajuste. A amostra compensada é rx_dbm - d(temp_realtime da mesma
+ * amostra), antes da tabela rx_cal.
+ */
+
+#ifndef DAEMON_RXCAL_H
+#define DAEMON_RXCAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../a0h.h"
+
+#define DAEMON_RXCAL_MAX_TABLES 16
+#define DAEMON_RXCAL_MAX_POINTS 16
+#define DAEMON_RXCAL_PN_SIZE 17      /* Vendor PN (16 bytes do A0h) + NUL */
+#define DAEMON_RXCAL_MAX_TEMP_COMP 16
+#define DAEMON_RXCAL_TEMP_COMP_DEGREE 3
+
+/* ============================================
+ * Tabela Compilada
+ * ============================================ */
+typedef struct {
+    uint16_t wavelength_nm;
+    char vendor_pn[DAEMON_RXCAL_PN_SIZE];   /* Vazio = qualquer PN */
+    uint8_t n_points;
+    float raw_dbm[DAEMON_RXCAL_MAX_POINTS]; /* Crescente, sem repetição */
+    float ref_dbm[DAEMON_RXCAL_MAX_POINTS];
+    float slope[DAEMON_RXCAL_MAX_POINTS];   /* Segmento i → i+1 */
+} daemon_rxcal_table_t;
+
+/* ============================================
+ * Compensação de Temperatura
+ * ============================================ */
+typedef struct {
+    char vendor_pn[DAEMON_RXCAL_PN_SIZE];
+    uint8_t degree;
+    float t_ref_c;
+    float t_min_c;
+    float t_max_c;
+    float coef[DAEMON_RXCAL_TEMP_COMP_DEGREE];   /* c1..c3 (dB/°C^k) */
+} daemon_rxcal_temp_comp_t;
+
+/* ============================================
+ * Funções
+ * ============================================ */
+
+/**
+ * @brief Faz o parse de uma linha rx_cal= e compila a tabela
+ * @param spec Valor após "rx_cal="
+ * @param table Tabela de saída
+ * @return false se a linha for inválida
+ */
+bool daemon_rxcal_parse(const char *spec, daemon_rxcal_table_t *table);
+
+/**
+ * @brief Registra as tabelas da configuração. Também lê o offset fixo
+ *        legado (env RX_POWER_OFFSET_DBM), usado quando nenhuma tabela casa
+ */
+void daemon_rxcal_init(const daemon_rxcal_table_t *tables, size_t count);
+
+/**
+ * @brief Escolhe a tabela do módulo: wavelength + PN, senão só wavelength
+ * @return Tabela ou NULL (aplica só o offset legado)
+ */
+const daemon_rxcal_table_t *daemon_rxcal_select(const sfp_a0h_base_t *a0);
+
+/**
+ * @brief Corrige um valor de RX power em dBm com a tabela escolhida
+ *        (SFP_DBM_FLOOR, sem luz, passa sem correção)
+ */
+float daemon_rxcal_apply(const daemon_rxcal_table_t *table, float dbm);
+
+/**
+ * @brief Faz o parse de uma linha rx_temp_comp=
+ * @return false se a linha for inválida
+ */
+bool daemon_rxcal_parse_temp_comp(const char *spec, daemon_rxcal_temp_comp_t *comp);
+
+/**
+ * @brief Registra os modelos de temperatura da configuração
+ */
+void daemon_rxcal_init_temp_comp(const daemon_rxcal_temp_comp_t *comps, size_t count);
+
+/**
+ * @brief Escolhe o modelo do módulo pelo Vendor PN
+ * @return Modelo ou NULL (sem compensação)
+ */
+const daemon_rxcal_temp_comp_t *daemon_rxcal_select_temp_comp(const sfp_a0h_base_t *a0);
+
+/**
+ * @brief Compensa um valor de RX power (dBm) pela temperatura do módulo
+ *        na mesma amostra. Sem modelo, ou no piso de dBm (sem luz), devolve
+ *        dbm inalterado.
+ */
+float daemon_rxcal_temp_comp_apply(const daemon_rxcal_temp_comp_t *comp, float dbm, float temp_c);
+
+#endif /* DAEMON_RXCAL_H */
@@ -1,19 +1,27 @@
 /**
  * @file daemon_socket.c
- * @brief Implementação do servidor socket e serialização JSON
+ * @brief Implementação do servidor socket e serialização JSON (daemon_json)
  */
 
+#define _DEFAULT_SOURCE
 #include "daemon_socket.h"
 #include "daemon_fsm.h"
 #include "daemon_state.h"
 #include "../a0h.h"
 #include "../a2h.h"
-#include <cjson/cJSON.h>
+#include "../sfp_wire.h"
+#include "../sfp_dbm.h"
+#include "daemon_json.h"
+#include "daemon_metrics.h"
+#include "daemon_stats.h"
+#include "daemon_alarm.h"
+#include "daemon_trend.h"
+#include "../sfp_probes.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/epoll.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <string.h>
@@ -22,8 +30,36 @@
 #include <time.h>
 #include <sys/stat.h>
 
-/* Offset de calibração lido do env RX_POWER_OFFSET_DBM na inicialização */
-static float g_rx_power_offset_dbm = 0.0f;
+
+/* Objeto "a0" já renderizado do módulo atual (GET CURRENT / GET STATIC) */
+static struct {
+    bool valid;
+    uint64_t generation_id;
+    size_t len;
+    char json[DAEMON_A0H_CACHE_SIZE];
+} g_a0h_cache;
+
+/* Resposta do GET DYNAMIC já renderizada por formato (índice
+ * daemon_socket_format_t), válida enquanto a amostra for a mesma */
+static struct {
+    uint64_t sample_seq;
+    uint64_t generation_id;
+    bool a2_valid;
+    daemon_chunk_t *chunk;
+} g_dynamic_cache[2];
+
+/* Marcador do socket de escuta em epoll_event.data.u32 (clientes usam o índice do slot) */
+#define DAEMON_SOCKET_LISTEN_TAG UINT32_MAX
+
+/* ============================================
+ * Relógio Monotônico (ms)
+ * ============================================ */
+static uint64_t daemon_socket_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
 
 /* ============================================
  * Inicializa Servidor Socket
@@ -40,10 +76,12 @@ bool daemon_socket_init(daemon_socket_server_t *server, const daemon_config_t *c
     memcpy(server->socket_path, config->socket_path, copy_len);
     server->socket_path[copy_len] = '\0';
     server->server_fd = -1;
+    server->epoll_fd = -1;
     server->num_clients = 0;
 
     for (int i = 0; i < DAEMON_MAX_CONNECTIONS; i++) {
-        server->client_fds[i] = -1;
+        server->clients[i].fd = -1;
+        daemon_outq_init(&server->clients[i].tx);
     }
 
     /* Cria diretório do socket se não existir */
@@ -99,12 +137,25 @@ bool daemon_socket_init(daemon_socket_server_t *server, const daemon_config_t *c
     int flags = fcntl(server->server_fd, F_GETFL, 0);
     fcntl(server->server_fd, F_SETFL, flags | O_NONBLOCK);
 
-    /* Lê offset de calibração de RX power do ambiente */
-    const char *offset_env = getenv("RX_POWER_OFFSET_DBM");
-    if (offset_env) {
-        g_rx_power_offset_dbm = (float)atof(offset_env);
-        syslog(LOG_INFO, "RX power offset: %.2f dBm", g_rx_power_offset_dbm);
+    /* epoll: socket de escuta + clientes (EPOLLIN/EPOLLOUT conforme a fila) */
+    server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (server->epoll_fd < 0) {
+        syslog(LOG_ERR, "Failed to create epoll: %s", strerror(errno));
+        close(server->server_fd);
+        return false;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = DAEMON_SOCKET_LISTEN_TAG;
+    if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->server_fd, &ev) < 0) {
+        syslog(LOG_ERR, "Failed to register listen socket: %s", strerror(errno));
+        close(server->epoll_fd);
+        close(server->server_fd);
+        return false;
     }
+    server->listen_armed = true;
 
     syslog(LOG_INFO, "Socket server initialized: %s", server->socket_path);
     return true;
@@ -121,10 +172,22 @@ void daemon_socket_cleanup(daemon_socket_server_t *server)
 
     /* Fecha clientes */
     for (int i = 0; i < DAEMON_MAX_CONNECTIONS; i++) {
-        if (server->client_fds[i] >= 0) {
-            close(server->client_fds[i]);
-            server->client_fds[i] = -1;
+        if (server->clients[i].fd >= 0) {
+            close(server->clients[i].fd);
+            server->clients[i].fd = -1;
         }
+        daemon_outq_clear(&server->clients[i].tx);
+    }
+
+    for (size_t i = 0; i < sizeof(g_dynamic_cache) / sizeof(g_dynamic_cache[0]); i++) {
+        daemon_chunk_unref(g_dynamic_cache[i].chunk);
+        g_dynamic_cache[i].chunk = NULL;
+    }
+
+    /* Fecha epoll */
+    if (server->epoll_fd >= 0) {
+        close(server->epoll_fd);
+        server->epoll_fd = -1;
     }
 
     /* Fecha servidor */
@@ -139,9 +202,61 @@ void daemon_socket_cleanup(daemon_socket_server_t *server)
     syslog(LOG_INFO, "Socket server cleaned up");
 }
 
+/* ============================================
+ * Atualiza Interesse epoll do Cliente
+ * ============================================ */
+static void daemon_socket_update_events(daemon_socket_server_t *server, daemon_socket_client_t *client)
+{
+    /* Backpressure: com a fila acima do limite, para de ler comandos
+     * até o cliente consumir as respostas pendentes */
+    uint32_t events = 0;
+    if (!client->rx_closed && client->tx.bytes < DAEMON_CLIENT_TX_HIGH_WATERMARK) {
+        events |= EPOLLIN;
+    }
+    if (client->tx.count > 0) {
+        events |= EPOLLOUT;
+    }
+
+    if (events == client->events) {
+        return;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.u32 = (uint32_t)(client - server->clients);
+    if (epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, client->fd, &ev) == 0) {
+        client->events = events;
+    }
+}
+
 /* ============================================
  * Aceita Novas Conexões
  * ============================================ */
+
+/*
+ * Com a tabela cheia o socket de escuta fica no epoll sem eventos: ele é
+ * level-triggered e, com conexões esperando no backlog, epoll_wait voltaria
+ * na hora até o fim do prazo. Volta a EPOLLIN quando um cliente sai.
+ */
+static void daemon_socket_arm_listen(daemon_socket_server_t *server)
+{
+    bool armed = server->num_clients < DAEMON_MAX_CONNECTIONS;
+    if (armed == server->listen_armed || server->epoll_fd < 0 || server->server_fd < 0) {
+        return;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = armed ? EPOLLIN : 0;
+    ev.data.u32 = DAEMON_SOCKET_LISTEN_TAG;
+    if (epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, server->server_fd, &ev) == 0) {
+        server->listen_armed = armed;
+    } else {
+        syslog(LOG_WARNING, "Failed to update listen socket: %s", strerror(errno));
+    }
+}
+
 bool daemon_socket_accept(daemon_socket_server_t *server)
 {
     if (!server || server->server_fd < 0) {
@@ -168,9 +283,30 @@ bool daemon_socket_accept(daemon_socket_server_t *server)
         /* Adiciona à lista */
         bool added = false;
         for (int i = 0; i < DAEMON_MAX_CONNECTIONS; i++) {
-            if (server->client_fds[i] < 0) {
-                server->client_fds[i] = client_fd;
+            daemon_socket_client_t *client = &server->clients[i];
+            if (client->fd < 0) {
+                struct epoll_event ev;
+                memset(&ev, 0, sizeof(ev));
+                ev.events = EPOLLIN;
+                ev.data.u32 = (uint32_t)i;
+                if (server->epoll_fd >= 0 &&
+                    epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, client_fd, &ev) < 0) {
+                    syslog(LOG_WARNING, "Failed to register client: %s", strerror(errno));
+                    break;
+                }
+
+                client->fd = client_fd;
+                client->rx_len = 0;
+                client->rx_discarding = false;
+                client->rx_closed = false;
+                client->events = EPOLLIN;
+                client->evict = false;
+                client->subscribed = false;
+                client->format = DAEMON_FORMAT_JSON;
+                client->length_framing = false;
+                daemon_outq_clear(&client->tx);
                 server->num_clients++;
+                daemon_metrics_socket_accept();
                 syslog(LOG_DEBUG, "Client connected (fd: %d)", client_fd);
                 added = true;
                 accepted_any = true;
@@ -185,24 +321,612 @@ bool daemon_socket_accept(daemon_socket_server_t *server)
         }
     }
 
+    daemon_socket_arm_listen(server);
     return accepted_any;
 }
 
 /* ============================================
- * Processa Comando de Cliente
+ * Enfileira Frame (cabeçalho + corpo + '\n')
+ * ============================================ */
+static bool daemon_socket_queue_frame(daemon_socket_client_t *client, const char *head, size_t head_len, daemon_chunk_t *body)
+{
+    uint64_t now_ms = daemon_socket_now_ms();
+
+    /* FRAMING LENGTH: a linha de cabeçalho ganha no fim o tamanho exato do
+     * que vem depois dela (corpo + '\n') */
+    char framed[DAEMON_OUTQ_INLINE_SIZE];
+    if (body && client->length_framing && client->format == DAEMON_FORMAT_JSON &&
+        head_len > 0 && head[head_len - 1] == '\n') {
+        int n = snprintf(framed, sizeof(framed), "%.*s %zu\n", (int)(head_len - 1), head, body->len + 1);
+        if (n < 0 || (size_t)n >= sizeof(framed)) {
+            return false;
+        }
+        head = framed;
+        head_len = (size_t)n;
+    }
+
+    /* Os três pedaços saem juntos no mesmo sendmsg() */
+    return body &&
+           daemon_outq_has_room(&client->tx, 3) &&
+           client->tx.bytes + body->len < DAEMON_CLIENT_TX_MAX_BYTES &&
+           daemon_outq_push_copy(&client->tx, head, head_len, now_ms) &&
+           daemon_outq_push_chunk(&client->tx, body, now_ms) &&
+           daemon_outq_push_static(&client->tx, "\n", 1, now_ms);
+}
+
+/* ============================================
+ * Registros Binários (sfp_wire.h)
  * ============================================ */
-static void daemon_socket_process_client_command(int client_fd, sfp_daemon_state_data_t *state, const char *command, time_t daemon_uptime)
+/* Mesma tabela do RX (sfp_dbm.h): sem libm por amostra/requisição */
+static float daemon_socket_tx_power_dbm(const sfp_a2h_t *a2)
 {
-    if (!command || !state) {
+    return sfp_dbm_from_uw(a2->tx_power_realtime);
+}
+
+static void daemon_socket_wire_sample(const sfp_daemon_state_data_t *state_copy, sfp_wire_sample_t *sample)
+{
+    const sfp_a2h_t *a2 = &state_copy->a2_parsed;
+
+    memset(sample, 0, sizeof(*sample));
+    sample->generation_id = state_copy->generation_id;
+    sample->timestamp_ms = state_copy->last_a2_read_ms;
+    if (!state_copy->a2_valid) {
         return;
     }
 
-    char *json_response = NULL;
+    sample->temp_c = (float)a2->temp_realtime;
+    sample->vcc_v = (float)a2->vcc_realtime;
+    sample->tx_bias_ma = (float)a2->tx_bias_realtime;
+    sample->tx_power_uw = (float)a2->tx_power_realtime;
+    sample->tx_power_dbm = daemon_socket_tx_power_dbm(a2);
+    sample->rx_power_uw = sfp_a2h_get_rx_power(a2);
+    sample->rx_power_dbm = state_copy->rx_power_dbm;
+    sample->flags = SFP_WIRE_SAMPLE_VALID | (a2->data_ready ? SFP_WIRE_SAMPLE_DATA_READY : 0);
+    sample->changed = (uint8_t)state_copy->a2_changed;
+    sample->status = (uint16_t)(a2->flags & SFP_A2_FLAGS_STATUS_MASK);
+    if (a2->flags & SFP_A2_FLAGS_ALARM_MASK) sample->status |= SFP_WIRE_STATUS_ALARM;
+    if (a2->flags & SFP_A2_FLAGS_WARNING_MASK) sample->status |= SFP_WIRE_STATUS_WARNING;
+}
+
+static void daemon_socket_wire_state(const sfp_daemon_state_data_t *state_copy, sfp_wire_state_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->generation_id = state_copy->generation_id;
+    out->first_detected = (int64_t)state_copy->first_detected;
+    out->last_a0_read = (int64_t)state_copy->last_a0_read;
+    out->last_a2_read = (int64_t)state_copy->last_a2_read;
+    out->state = (uint8_t)state_copy->state;
+    out->i2c_error_count = state_copy->i2c_error_count;
+}
+
+/* Monta frame STATE a partir do estado atual; retorna o tamanho */
+static size_t daemon_socket_frame_state(sfp_daemon_state_data_t *state, uint8_t *frame)
+{
+    sfp_daemon_state_data_t state_copy;
+    sfp_wire_state_t wire_state;
+
+    daemon_state_get_copy(state, &state_copy);
+    daemon_socket_wire_state(&state_copy, &wire_state);
+    return sfp_wire_frame_state(frame, state_copy.sample_seq, &wire_state);
+}
+
+/* ============================================
+ * Enfileira Frame Binário (já completo no chunk)
+ * ============================================ */
+static bool daemon_socket_queue_binary(daemon_socket_client_t *client, daemon_chunk_t *frame)
+{
+    return frame &&
+           daemon_outq_has_room(&client->tx, 1) &&
+           client->tx.bytes + frame->len < DAEMON_CLIENT_TX_MAX_BYTES &&
+           daemon_outq_push_chunk(&client->tx, frame, daemon_socket_now_ms());
+}
+
+static daemon_chunk_t *daemon_socket_binary_chunk(const uint8_t *frame, size_t len)
+{
+    daemon_chunk_t *chunk = daemon_chunk_new(len);
+    if (chunk) {
+        memcpy(chunk->data, frame, len);
+        chunk->len = len;
+    }
+    return chunk;
+}
+
+/* ============================================
+ * Resposta Dinâmica por Amostra
+ * ============================================ */
+static size_t serialize_dynamic_body(const sfp_daemon_state_data_t *state_copy, char *buf, size_t cap);
+
+/* Corpo do GET DYNAMIC (JSON) ou frame SAMPLE (binário) da amostra atual.
+ * Só muda com sample_seq (publish_a2h ou SET/CLEAR REFERENCE e RESET HOLD),
+ * troca de módulo ou a2_valid caindo na remoção: entre duas versões todos os
+ * clientes recebem o mesmo chunk.
+ * Devolve uma referência nova, ou NULL se não coube. */
+static daemon_chunk_t *daemon_socket_dynamic_body(sfp_daemon_state_data_t *state, daemon_socket_format_t format)
+{
+    pthread_mutex_lock(&state->mutex);
+    uint64_t seq = state->sample_seq;
+    uint64_t generation_id = state->generation_id;
+    bool a2_valid = state->a2_valid;
+    pthread_mutex_unlock(&state->mutex);
+
+    if (g_dynamic_cache[format].chunk &&
+        g_dynamic_cache[format].sample_seq == seq &&
+        g_dynamic_cache[format].generation_id == generation_id &&
+        g_dynamic_cache[format].a2_valid == a2_valid) {
+        return daemon_chunk_ref(g_dynamic_cache[format].chunk);
+    }
+
+    sfp_daemon_state_data_t state_copy;
+    daemon_state_get_copy(state, &state_copy);
+
+    daemon_chunk_t *chunk;
+    if (format == DAEMON_FORMAT_BINARY) {
+        uint8_t frame[SFP_WIRE_HEADER_SIZE + SFP_WIRE_SAMPLE_SIZE];
+        sfp_wire_sample_t sample;
+        daemon_socket_wire_sample(&state_copy, &sample);
+        chunk = daemon_socket_binary_chunk(frame, sfp_wire_frame_sample(frame, state_copy.sample_seq, &sample));
+    } else {
+        chunk = daemon_chunk_new(DAEMON_CHUNK_POOL_CAP);
+        if (chunk) {
+            chunk->len = serialize_dynamic_body(&state_copy, chunk->data, chunk->cap);
+        }
+    }
+    if (!chunk || chunk->len == 0) {
+        daemon_chunk_unref(chunk);
+        return NULL;
+    }
+
+    /* Chave da cópia serializada (a amostra pode ter avançado desde a leitura acima) */
+    daemon_chunk_unref(g_dynamic_cache[format].chunk);
+    g_dynamic_cache[format].sample_seq = state_copy.sample_seq;
+    g_dynamic_cache[format].generation_id = state_copy.generation_id;
+    g_dynamic_cache[format].a2_valid = state_copy.a2_valid;
+    g_dynamic_cache[format].chunk = daemon_chunk_ref(chunk);
+    return chunk;
+}
+
+/* ============================================
+ * Enfileira Resposta (status line + corpo + '\n')
+ * ============================================ */
+static void daemon_socket_queue_response(daemon_socket_client_t *client, int status_code, const char *status_msg, daemon_chunk_t *body)
+{
+    /* Em modo binário a resposta textual vai embrulhada num frame TEXT:
+     * o cabeçalho sai no mesmo segmento da status line */
+    char head[DAEMON_OUTQ_INLINE_SIZE];
+    size_t prefix = client->format == DAEMON_FORMAT_BINARY ? SFP_WIRE_HEADER_SIZE : 0;
+    int status_len = snprintf(head + prefix, sizeof(head) - prefix, "STATUS %d %s\n", status_code, status_msg);
+    if (status_len < 0 || (size_t)status_len >= sizeof(head) - prefix) {
+        client->evict = true;
+        return;
+    }
+
+    if (prefix) {
+        sfp_wire_header_t hdr = {
+            .type = SFP_WIRE_TYPE_TEXT,
+            .payload_len = (uint32_t)((size_t)status_len + body->len + 1),
+        };
+        sfp_wire_encode_header((uint8_t *)head, &hdr);
+    }
+
+    if (!daemon_socket_queue_frame(client, head, prefix + (size_t)status_len, body)) {
+        /* Fila estourada: uma resposta pela metade corromperia o stream */
+        syslog(LOG_WARNING, "Client output queue overflow (fd: %d), evicting", client->fd);
+        client->evict = true;
+    }
+}
+
+/* Enfileira frame binário montado pelo chamador (GET DYNAMIC/STATE em modo binário) */
+static void daemon_socket_queue_binary_response(daemon_socket_client_t *client, const uint8_t *frame, size_t len)
+{
+    daemon_chunk_t *chunk = daemon_socket_binary_chunk(frame, len);
+    bool queued = daemon_socket_queue_binary(client, chunk);
+    daemon_chunk_unref(chunk);
+
+    if (!queued) {
+        syslog(LOG_WARNING, "Client output queue overflow (fd: %d), evicting", client->fd);
+        client->evict = true;
+    }
+}
+
+/* ============================================
+ * Resposta Simples {"status":…,"message":…}
+ * ============================================ */
+static size_t serialize_message(char *buf, size_t cap, const char *status, const char *message)
+{
+    daemon_json_t w;
+    daemon_json_init(&w, buf, cap);
+    daemon_json_object_begin(&w, NULL);
+    daemon_json_string(&w, "status", status);
+    daemon_json_string(&w, "message", message);
+    daemon_json_object_end(&w);
+    return daemon_json_finish(&w);
+}
+
+/* ============================================
+ * GET … IF-NEWER <n> (Requisição Condicional)
+ * ============================================ */
+
+/* Separa o sufixo " IF-NEWER <n>" do comando (cmd fica só com o GET).
+ * Retorna false se não há sufixo; *valid indica se <n> é um número. */
+static bool daemon_socket_split_if_newer(char *cmd, uint64_t *since, bool *valid)
+{
+    char *suffix = strstr(cmd, " IF-NEWER");
+    if (!suffix) {
+        return false;
+    }
+    *suffix = '\0';
+
+    const char *arg = suffix + 9;
+    char *end = NULL;
+    *valid = *arg == ' ' && arg[1] >= '0' && arg[1] <= '9';
+    if (*valid) {
+        *since = strtoull(arg + 1, &end, 10);
+        *valid = *end == '\0';
+    }
+    return true;
+}
+
+/* true se a resposta de `command` seria igual à que o cliente já tem.
+ * CURRENT/DYNAMIC comparam sample_seq: toda volta a PRESENT com A2h válido
+ * passa por publish_a2h, que incrementa a sequência. STATIC compara
+ * generation_id (A0h só é lido na inserção). */
+static bool daemon_socket_not_modified(sfp_daemon_state_data_t *state, const char *command, uint64_t since, uint64_t *version)
+{
+    pthread_mutex_lock(&state->mutex);
+    bool not_modified;
+    if (strcmp(command, "GET STATIC") == 0) {
+        *version = state->generation_id;
+        not_modified = state->a0_valid && since == state->generation_id;
+    } else {
+        *version = state->sample_seq;
+        not_modified = state->a2_valid && since == state->sample_seq &&
+                       (strcmp(command, "GET DYNAMIC") == 0 || state->state == SFP_STATE_PRESENT);
+    }
+    pthread_mutex_unlock(&state->mutex);
+    return not_modified;
+}
+
+/* ============================================
+ * GET STATS WINDOW <segundos>
+ * ============================================ */
+static size_t daemon_socket_stats_window(const char *args, int *status_code, const char **status_msg, char *buf, size_t cap)
+{
+    while (*args == ' ' || *args == '\t') args++;
+    char *end = NULL;
+    unsigned long seconds = strtoul(args, &end, 10);
+    bool valid = end != args && *end == '\0' && seconds > 0 && seconds <= DAEMON_STATS_MAX_WINDOW_SEC;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t now_ms = (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+
+    daemon_stats_result_t result;
+    if (!valid || !daemon_stats_query((uint32_t)seconds, now_ms, &result)) {
+        /* Lista as janelas configuradas para o cliente escolher */
+        daemon_stats_window_cfg_t windows[DAEMON_STATS_MAX_WINDOWS];
+        size_t count = daemon_stats_get_windows(windows, DAEMON_STATS_MAX_WINDOWS);
+
+        *status_code = 400;
+        *status_msg = "BAD_REQUEST";
+        daemon_json_t w;
+        daemon_json_init(&w, buf, cap);
+        daemon_json_object_begin(&w, NULL);
+        daemon_json_string(&w, "status", "error");
+        daemon_json_string(&w, "message", "Usage: GET STATS WINDOW <seconds> (one of windows)");
+        daemon_json_array_begin(&w, "windows");
+        for (size_t i = 0; i < count; i++) {
+            daemon_json_uint(&w, NULL, windows[i].seconds);
+        }
+        daemon_json_array_end(&w);
+        daemon_json_object_end(&w);
+        return daemon_json_finish(&w);
+    }
+
+    daemon_json_t w;
+    daemon_json_init(&w, buf, cap);
+    daemon_json_object_begin(&w, NULL);
+    daemon_json_string(&w, "status", "ok");
+    daemon_json_uint(&w, "window_s", result.window.seconds);
+    daemon_json_string(&w, "mode", result.window.mode == DAEMON_STATS_TUMBLING ? "tumbling" : "sliding");
+    daemon_json_bool(&w, "complete", result.complete);
+    daemon_json_uint(&w, "generation_id", result.generation_id);
+    daemon_json_uint(&w, "from_ms", result.from_ms);
+    daemon_json_uint(&w, "to_ms", result.to_ms);
+    if (result.percentile_from_ms > 0) {
+        daemon_json_uint(&w, "percentile_from_ms", result.percentile_from_ms);
+    } else {
+        daemon_json_null(&w, "percentile_from_ms");
+    }
+    daemon_json_object_begin(&w, "channels");
+    for (int c = 0; c < DAEMON_STATS_CH_COUNT; c++) {
+        const daemon_stats_summary_t *s = &result.channels[c];
+        daemon_json_object_begin(&w, daemon_stats_channel_name((daemon_stats_channel_t)c));
+        daemon_json_uint(&w, "n", s->n);
+        if (s->n > 0) {
+            daemon_json_number(&w, "mean", s->mean);
+            daemon_json_number(&w, "stddev", s->stddev);
+            daemon_json_number(&w, "min", s->min);
+            daemon_json_number(&w, "max", s->max);
+            daemon_json_number(&w, "p2p", s->max - s->min);
+            daemon_json_number(&w, "p1", s->p1);
+            daemon_json_number(&w, "p50", s->p50);
+            daemon_json_number(&w, "p99", s->p99);
+        }
+        daemon_json_object_end(&w);
+    }
+    daemon_json_object_end(&w);
+    daemon_json_object_end(&w);
+    return daemon_json_finish(&w);
+}
+
+/* ============================================
+ * GET ALARMS [SINCE <seq>]
+ * ============================================ */
+static void serialize_alarm_event(daemon_json_t *w, const char *key, const daemon_alarm_event_t *e)
+{
+    daemon_json_object_begin(w, key);
+    daemon_json_uint(w, "seq", e->seq);
+    daemon_json_uint(w, "timestamp_ms", e->timestamp_ms);
+    daemon_json_uint(w, "generation_id", e->generation_id);
+    daemon_json_string(w, "channel", daemon_alarm_channel_name(e->channel));
+    daemon_json_string(w, "condition", daemon_alarm_condition_name(e->condition));
+    daemon_json_string(w, "source", daemon_alarm_source_name(e->source));
+    daemon_json_string(w, "state", e->raised ? "raised" : "cleared");
+    daemon_json_number(w, "value", e->value);
+    daemon_json_number(w, "threshold", e->threshold);
+    daemon_json_object_end(w);
+}
+
+static size_t daemon_socket_get_alarms(const char *args, int *status_code, const char **status_msg, char *buf, size_t cap)
+{
+    while (*args == ' ' || *args == '\t') args++;
+
+    bool since_given = false;
+    uint64_t since = 0;
+    if (*args != '\0') {
+        char *end = NULL;
+        if (strncmp(args, "SINCE ", 6) == 0) {
+            since = strtoull(&args[6], &end, 10);
+        }
+        if (!end || end == &args[6] || *end != '\0') {
+            *status_code = 400;
+            *status_msg = "BAD_REQUEST";
+            return serialize_message(buf, cap, "error", "Usage: GET ALARMS [SINCE <seq>]");
+        }
+        since_given = true;
+    }
+
+    /* Cada condição só pode estar ativa uma vez */
+    daemon_alarm_event_t active[DAEMON_ALARM_SRC_COUNT * DAEMON_ALARM_CH_COUNT * DAEMON_ALARM_COND_COUNT];
+    size_t active_count = daemon_alarm_active(active, sizeof(active) / sizeof(active[0]));
+
+    daemon_json_t w;
+    daemon_json_init(&w, buf, cap);
+    daemon_json_object_begin(&w, NULL);
+    daemon_json_string(&w, "status", "ok");
+    daemon_json_uint(&w, "last_seq", daemon_alarm_last_seq());
+    daemon_json_array_begin(&w, "active");
+    for (size_t i = 0; i < active_count; i++) {
+        serialize_alarm_event(&w, NULL, &active[i]);
+    }
+    daemon_json_array_end(&w);
+
+    if (since_given) {
+        daemon_alarm_event_t events[DAEMON_ALARM_QUEUE_SIZE];
+        bool lost = false;
+        size_t count = daemon_alarm_events_since(since, events, DAEMON_ALARM_QUEUE_SIZE, &lost);
+        daemon_json_bool(&w, "lost", lost);
+        daemon_json_array_begin(&w, "events");
+        for (size_t i = 0; i < count; i++) {
+            serialize_alarm_event(&w, NULL, &events[i]);
+        }
+        daemon_json_array_end(&w);
+    }
+
+    daemon_json_object_end(&w);
+    return daemon_json_finish(&w);
+}
+
+/* ============================================
+ * GET TREND [<segundos>]
+ * ============================================ */
+static void serialize_trend_tier(daemon_json_t *w, const char *key, const daemon_trend_result_t *result)
+{
+    daemon_json_object_begin(w, key);
+    daemon_json_uint(w, "span_s", (uint64_t)result->tier.bucket_seconds * result->tier.buckets);
+    daemon_json_uint(w, "bucket_s", result->tier.bucket_seconds);
+    daemon_json_uint(w, "generation_id", result->generation_id);
+    daemon_json_uint(w, "from_ms", result->from_ms);
+    daemon_json_uint(w, "to_ms", result->to_ms);
+    daemon_json_object_begin(w, "channels");
+    for (int c = 0; c < DAEMON_ALARM_CH_COUNT; c++) {
+        const daemon_trend_channel_result_t *r = &result->channels[c];
+        daemon_json_object_begin(w, daemon_alarm_channel_name((daemon_alarm_channel_t)c));
+        daemon_json_uint(w, "points", r->points);
+        if (r->valid) {
+            daemon_json_number(w, "slope_per_day", r->slope_per_day);
+            daemon_json_number(w, "fitted", r->fitted);
+            daemon_json_number(w, "r2", r->r2);
+            if (r->has_threshold) {
+                daemon_json_string(w, "condition", daemon_alarm_condition_name(r->condition));
+                daemon_json_number(w, "threshold", r->threshold);
+                daemon_json_number(w, "days_to_threshold", r->days_to_threshold);
+            } else {
+                daemon_json_null(w, "days_to_threshold");
+            }
+        }
+        daemon_json_object_end(w);
+    }
+    daemon_json_object_end(w);
+    daemon_json_object_end(w);
+}
+
+static size_t daemon_socket_get_trend(const char *args, int *status_code, const char **status_msg, char *buf, size_t cap)
+{
+    while (*args == ' ' || *args == '\t') args++;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t now_ms = (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+
+    daemon_trend_tier_cfg_t tiers[DAEMON_TREND_MAX_TIERS];
+    size_t count = daemon_trend_get_tiers(tiers, DAEMON_TREND_MAX_TIERS);
+    daemon_trend_result_t result;
+
+    /* Com span: só aquela camada */
+    if (*args != '\0') {
+        char *end = NULL;
+        unsigned long seconds = strtoul(args, &end, 10);
+        bool valid = end != args && *end == '\0' && seconds > 0 && seconds <= DAEMON_TREND_MAX_SPAN_SEC;
+        if (!valid || !daemon_trend_query((uint32_t)seconds, now_ms, &result)) {
+            *status_code = 400;
+            *status_msg = "BAD_REQUEST";
+            daemon_json_t w;
+            daemon_json_init(&w, buf, cap);
+            daemon_json_object_begin(&w, NULL);
+            daemon_json_string(&w, "status", "error");
+            daemon_json_string(&w, "message", "Usage: GET TREND [<seconds>] (one of spans)");
+            daemon_json_array_begin(&w, "spans");
+            for (size_t i = 0; i < count; i++) {
+                daemon_json_uint(&w, NULL, (uint64_t)tiers[i].bucket_seconds * tiers[i].buckets);
+            }
+            daemon_json_array_end(&w);
+            daemon_json_object_end(&w);
+            return daemon_json_finish(&w);
+        }
+    }
+
+    daemon_json_t w;
+    daemon_json_init(&w, buf, cap);
+    daemon_json_object_begin(&w, NULL);
+    daemon_json_string(&w, "status", "ok");
+    daemon_json_uint(&w, "timestamp_ms", now_ms);
+    daemon_json_array_begin(&w, "tiers");
+    if (*args != '\0') {
+        serialize_trend_tier(&w, NULL, &result);
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            if (daemon_trend_query(tiers[i].bucket_seconds * tiers[i].buckets, now_ms, &result)) {
+                serialize_trend_tier(&w, NULL, &result);
+            }
+        }
+    }
+    daemon_json_array_end(&w);
+    daemon_json_object_end(&w);
+    return daemon_json_finish(&w);
+}
+
+/* ============================================
+ * SET REFERENCE [dBm] / CLEAR REFERENCE / RESET HOLD
+ * ============================================ */
+static size_t daemon_socket_set_reference(sfp_daemon_state_data_t *state, const char *args, int *status_code, const char **status_msg, char *buf, size_t cap)
+{
+    while (*args == ' ' || *args == '\t') args++;
+
+    float value;
+    const float *explicit_ref = NULL;
+    if (*args != '\0') {
+        char *end = NULL;
+        value = strtof(args, &end);
+        if (end == args || *end != '\0' || !(value >= -100.0f && value <= 100.0f)) {
+            *status_code = 400;
+            *status_msg = "BAD_REQUEST";
+            return serialize_message(buf, cap, "error", "Usage: SET REFERENCE [<dBm>]");
+        }
+        explicit_ref = &value;
+    }
+
+    float ref = 0.0f;
+    uint32_t samples = daemon_state_set_reference(state, explicit_ref, &ref);
+    if (samples == 0) {
+        *status_code = 400;
+        *status_msg = "BAD_REQUEST";
+        return serialize_message(buf, cap, "error", "No RX samples to average");
+    }
+
+    daemon_json_t w;
+    daemon_json_init(&w, buf, cap);
+    daemon_json_object_begin(&w, NULL);
+    daemon_json_string(&w, "status", "ok");
+    daemon_json_float(&w, "rx_reference_dbm", ref);
+    daemon_json_uint(&w, "samples", samples);
+    daemon_json_object_end(&w);
+    return daemon_json_finish(&w);
+}
+
+/* ============================================
+ * SUBSCRIBE DYNAMIC [decimação] / UNSUBSCRIBE
+ * ============================================ */
+static size_t daemon_socket_subscribe(daemon_socket_client_t *client, sfp_daemon_state_data_t *state, const char *args, int *status_code, const char **status_msg, char *buf, size_t cap)
+{
+    unsigned long decimation = 1;
+    bool delta = false;
+    bool have_decimation = false;
+    bool valid = true;
+
+    /* Argumentos opcionais, em qualquer ordem: decimação e DELTA */
+    while (valid && *args) {
+        while (*args == ' ' || *args == '\t') args++;
+        if (!*args) break;
+
+        size_t token_len = strcspn(args, " \t");
+        if (token_len == 5 && strncmp(args, "DELTA", 5) == 0 && !delta) {
+            delta = true;
+        } else if (!have_decimation && args[0] >= '0' && args[0] <= '9') {
+            char *end = NULL;
+            decimation = strtoul(args, &end, 10);
+            valid = end == args + token_len &&
+                    decimation >= 1 && decimation <= DAEMON_SUBSCRIBE_MAX_DECIMATION;
+            have_decimation = true;
+        } else {
+            valid = false;
+        }
+        args += token_len;
+    }
+
+    if (!valid) {
+        *status_code = 400;
+        *status_msg = "BAD_REQUEST";
+        return serialize_message(buf, cap, "error", "Usage: SUBSCRIBE DYNAMIC [decimation] [DELTA]");
+    }
+
+    client->subscribed = true;
+    client->decimation = (uint32_t)decimation;
+    client->decimation_count = 0;
+    client->delta = delta;
+    client->pending_changed = SFP_A2_CHANGED_ALL;  /* Primeiro frame vai completo */
+
+    pthread_mutex_lock(&state->mutex);
+    uint64_t seq = state->sample_seq;
+    pthread_mutex_unlock(&state->mutex);
+
+    daemon_json_t w;
+    daemon_json_init(&w, buf, cap);
+    daemon_json_object_begin(&w, NULL);
+    daemon_json_string(&w, "status", "ok");
+    daemon_json_string(&w, "subscribed", "dynamic");
+    daemon_json_uint(&w, "decimation", client->decimation);
+    daemon_json_bool(&w, "delta", client->delta);
+    daemon_json_uint(&w, "seq", seq);
+    daemon_json_object_end(&w);
+
+    return daemon_json_finish(&w);
+}
+
+/* ============================================
+ * Processa Comando de Cliente
+ * ============================================ */
+static daemon_metrics_command_t daemon_socket_execute_command(daemon_socket_client_t *client, sfp_daemon_state_data_t *state, const char *command, time_t daemon_uptime)
+{
+    if (!client || !command || !state) {
+        return DAEMON_CMD_INVALID;
+    }
+
     int status_code = 200;
     const char *status_msg = "OK";
 
     /* Remove newline */
-    char cmd[256];
+    char cmd[DAEMON_MAX_COMMAND_LENGTH];
     size_t cmd_len = strlen(command);
     size_t cmd_copy_len = (cmd_len < sizeof(cmd) - 1) ? cmd_len : sizeof(cmd) - 1;
     memcpy(cmd, command, cmd_copy_len);
@@ -214,101 +938,690 @@ static void daemon_socket_process_client_command(int client_fd, sfp_daemon_state
     char *p = cmd;
     while (*p == ' ' || *p == '\t') p++;
 
-    /* Processa comando */
-    if (strcmp(p, "GET CURRENT") == 0) {
-        json_response = daemon_socket_serialize_current(state);
-        if (!json_response) {
-            status_code = 500;
-            status_msg = "ERROR";
+    /* GET CURRENT|DYNAMIC|STATIC IF-NEWER <n>: 304 curto se nada mudou,
+     * senão segue como o GET normal */
+    uint64_t since = 0;
+    bool since_valid = false;
+    bool conditional = daemon_socket_split_if_newer(p, &since, &since_valid);
+    bool bad_conditional = conditional &&
+                           (!since_valid ||
+                            (strcmp(p, "GET CURRENT") != 0 &&
+                             strcmp(p, "GET DYNAMIC") != 0 &&
+                             strcmp(p, "GET STATIC") != 0));
+    uint64_t version = 0;
+    bool not_modified = conditional && !bad_conditional &&
+                        daemon_socket_not_modified(state, p, since, &version);
+
+    /* GET DYNAMIC: resposta compartilhada entre clientes até a próxima amostra */
+    if (!bad_conditional && !not_modified && strcmp(p, "GET DYNAMIC") == 0) {
+        daemon_chunk_t *dynamic = daemon_socket_dynamic_body(state, client->format);
+        if (dynamic) {
+            if (client->format == DAEMON_FORMAT_BINARY) {
+                if (!daemon_socket_queue_binary(client, dynamic)) {
+                    syslog(LOG_WARNING, "Client output queue overflow (fd: %d), evicting", client->fd);
+                    client->evict = true;
+                }
+            } else {
+                daemon_socket_queue_response(client, 200, "OK", dynamic);
+            }
+            daemon_chunk_unref(dynamic);
+            return DAEMON_CMD_GET_DYNAMIC;
         }
-    } else if (strcmp(p, "GET STATIC") == 0) {
-        json_response = daemon_socket_serialize_static(state);
-        if (!json_response) {
-            status_code = 500;
-            status_msg = "ERROR";
+    }
+
+    /* GET STATE no modo binário sai como frame STATE */
+    if (!conditional && client->format == DAEMON_FORMAT_BINARY && strcmp(p, "GET STATE") == 0) {
+        uint8_t frame[SFP_WIRE_HEADER_SIZE + SFP_WIRE_STATE_SIZE];
+        daemon_socket_queue_binary_response(client, frame, daemon_socket_frame_state(state, frame));
+        return DAEMON_CMD_GET_STATE;
+    }
+
+    /* STATS [PROMETHEUS]: maior que um chunk do pool */
+    if (strcmp(p, "STATS") == 0 || strcmp(p, "STATS PROMETHEUS") == 0) {
+        daemon_chunk_t *stats = daemon_chunk_new(DAEMON_STATS_BUFFER_SIZE);
+        if (!stats) {
+            client->evict = true;
+            return DAEMON_CMD_STATS;
         }
-    } else if (strcmp(p, "GET DYNAMIC") == 0) {
-        json_response = daemon_socket_serialize_dynamic(state);
-        if (!json_response) {
+        stats->len = strcmp(p, "STATS") == 0
+            ? daemon_metrics_render_json(stats->data, stats->cap)
+            : daemon_metrics_render_prometheus(stats->data, stats->cap);
+        if (stats->len == 0) {
             status_code = 500;
             status_msg = "ERROR";
+            stats->len = serialize_message(stats->data, stats->cap, "error", "Response too large");
         }
+        daemon_socket_queue_response(client, status_code, status_msg, stats);
+        daemon_chunk_unref(stats);
+        return DAEMON_CMD_STATS;
+    }
+
+    /* O JSON é escrito direto no chunk que vai para a fila (vem do pool) */
+    daemon_chunk_t *body = daemon_chunk_new(DAEMON_CHUNK_POOL_CAP);
+    if (!body) {
+        client->evict = true;
+        return DAEMON_CMD_INVALID;
+    }
+    char *buf = body->data;
+    size_t cap = body->cap;
+    size_t len;
+    daemon_metrics_command_t type = DAEMON_CMD_INVALID;
+
+    /* Processa comando */
+    if (bad_conditional) {
+        status_code = 400;
+        status_msg = "BAD_REQUEST";
+        len = serialize_message(buf, cap, "error", "Usage: GET CURRENT|DYNAMIC|STATIC IF-NEWER <seq>");
+    } else if (not_modified) {
+        type = strcmp(p, "GET STATIC") == 0 ? DAEMON_CMD_GET_STATIC :
+               strcmp(p, "GET DYNAMIC") == 0 ? DAEMON_CMD_GET_DYNAMIC : DAEMON_CMD_GET_CURRENT;
+        status_code = 304;
+        status_msg = "NOT_MODIFIED";
+        daemon_json_t w;
+        daemon_json_init(&w, buf, cap);
+        daemon_json_object_begin(&w, NULL);
+        daemon_json_string(&w, "status", "not_modified");
+        daemon_json_uint(&w, strcmp(p, "GET STATIC") == 0 ? "generation_id" : "seq", version);
+        daemon_json_object_end(&w);
+        len = daemon_json_finish(&w);
+    } else if (strcmp(p, "GET CURRENT") == 0) {
+        type = DAEMON_CMD_GET_CURRENT;
+        len = daemon_socket_serialize_current(state, buf, cap);
+    } else if (strcmp(p, "GET STATIC") == 0) {
+        type = DAEMON_CMD_GET_STATIC;
+        len = daemon_socket_serialize_static(state, buf, cap);
+    } else if (strcmp(p, "GET DYNAMIC") == 0) {
+        type = DAEMON_CMD_GET_DYNAMIC;
+        len = daemon_socket_serialize_dynamic(state, buf, cap);
     } else if (strcmp(p, "GET STATE") == 0) {
-        json_response = daemon_socket_serialize_state(state);
-        if (!json_response) {
-            status_code = 500;
-            status_msg = "ERROR";
+        type = DAEMON_CMD_GET_STATE;
+        len = daemon_socket_serialize_state(state, buf, cap);
+    } else if (strncmp(p, "GET FIELDS", 10) == 0 && (p[10] == '\0' || p[10] == ' ')) {
+        type = DAEMON_CMD_GET_FIELDS;
+        bool bad_fields = false;
+        len = daemon_socket_serialize_fields(state, &p[10], buf, cap, &bad_fields);
+        if (bad_fields) {
+            status_code = 400;
+            status_msg = "BAD_REQUEST";
+            len = serialize_message(buf, cap, "error", "Usage: GET FIELDS <name>[,<name>...] (unknown or too many fields)");
         }
+    } else if (strncmp(p, "GET STATS WINDOW", 16) == 0 && (p[16] == '\0' || p[16] == ' ')) {
+        type = DAEMON_CMD_GET_STATS;
+        len = daemon_socket_stats_window(&p[16], &status_code, &status_msg, buf, cap);
+    } else if (strncmp(p, "GET ALARMS", 10) == 0 && (p[10] == '\0' || p[10] == ' ')) {
+        type = DAEMON_CMD_GET_ALARMS;
+        len = daemon_socket_get_alarms(&p[10], &status_code, &status_msg, buf, cap);
+    } else if (strncmp(p, "GET TREND", 9) == 0 && (p[9] == '\0' || p[9] == ' ')) {
+        type = DAEMON_CMD_GET_TREND;
+        len = daemon_socket_get_trend(&p[9], &status_code, &status_msg, buf, cap);
+    } else if (strncmp(p, "SET REFERENCE", 13) == 0 && (p[13] == '\0' || p[13] == ' ')) {
+        type = DAEMON_CMD_REFERENCE;
+        len = daemon_socket_set_reference(state, &p[13], &status_code, &status_msg, buf, cap);
+    } else if (strcmp(p, "CLEAR REFERENCE") == 0) {
+        type = DAEMON_CMD_REFERENCE;
+        daemon_state_clear_reference(state);
+        len = serialize_message(buf, cap, "ok", "Reference cleared");
+    } else if (strcmp(p, "RESET HOLD") == 0) {
+        type = DAEMON_CMD_RESET_HOLD;
+        daemon_state_reset_hold(state);
+        len = serialize_message(buf, cap, "ok", "Hold reset");
     } else if (strcmp(p, "PING") == 0) {
-        json_response = daemon_socket_serialize_ping(daemon_uptime);
-        if (!json_response) {
-            status_code = 500;
-            status_msg = "ERROR";
-        }
+        type = DAEMON_CMD_PING;
+        len = daemon_socket_serialize_ping(daemon_uptime, buf, cap);
+    } else if (strncmp(p, "SUBSCRIBE DYNAMIC", 17) == 0 && (p[17] == '\0' || p[17] == ' ')) {
+        type = DAEMON_CMD_SUBSCRIBE;
+        len = daemon_socket_subscribe(client, state, &p[17], &status_code, &status_msg, buf, cap);
+    } else if (strcmp(p, "FORMAT JSON") == 0 || strcmp(p, "FORMAT BINARY") == 0) {
+        type = DAEMON_CMD_FORMAT;
+        /* A própria confirmação já sai no formato novo */
+        client->format = strcmp(p, "FORMAT BINARY") == 0 ? DAEMON_FORMAT_BINARY : DAEMON_FORMAT_JSON;
+        daemon_json_t w;
+        daemon_json_init(&w, buf, cap);
+        daemon_json_object_begin(&w, NULL);
+        daemon_json_string(&w, "status", "ok");
+        daemon_json_string(&w, "format", client->format == DAEMON_FORMAT_BINARY ? "binary" : "json");
+        daemon_json_uint(&w, "wire_version", SFP_WIRE_VERSION);
+        daemon_json_object_end(&w);
+        len = daemon_json_finish(&w);
+    } else if (strcmp(p, "FRAMING LENGTH") == 0 || strcmp(p, "FRAMING LINE") == 0) {
+        type = DAEMON_CMD_FRAMING;
+        /* Como em FORMAT, a confirmação já sai no modo novo */
+        client->length_framing = strcmp(p, "FRAMING LENGTH") == 0;
+        daemon_json_t w;
+        daemon_json_init(&w, buf, cap);
+        daemon_json_object_begin(&w, NULL);
+        daemon_json_string(&w, "status", "ok");
+        daemon_json_string(&w, "framing", client->length_framing ? "length" : "line");
+        daemon_json_object_end(&w);
+        len = daemon_json_finish(&w);
+    } else if (strcmp(p, "UNSUBSCRIBE") == 0) {
+        type = DAEMON_CMD_UNSUBSCRIBE;
+        client->subscribed = false;
+        daemon_json_t w;
+        daemon_json_init(&w, buf, cap);
+        daemon_json_object_begin(&w, NULL);
+        daemon_json_string(&w, "status", "ok");
+        daemon_json_bool(&w, "subscribed", false);
+        daemon_json_object_end(&w);
+        len = daemon_json_finish(&w);
     } else {
         status_code = 400;
         status_msg = "BAD_REQUEST";
-        cJSON *json = cJSON_CreateObject();
-        cJSON_AddStringToObject(json, "status", "error");
-        cJSON_AddStringToObject(json, "message", "Invalid command");
-        json_response = cJSON_Print(json);
-        cJSON_Delete(json);
+        len = serialize_message(buf, cap, "error", "Invalid command");
+    }
+
+    if (len == 0) {
+        status_code = 500;
+        status_msg = "ERROR";
+        len = serialize_message(buf, cap, "error", "Response too large");
+    }
+    body->len = len;
+
+    /* Enfileira resposta (enviada em daemon_socket_service_client) */
+    daemon_socket_queue_response(client, status_code, status_msg, body);
+    daemon_chunk_unref(body);
+    return type;
+}
+
+/* Executa o comando e registra tipo e tempo de montagem da resposta */
+static void daemon_socket_process_client_command(daemon_socket_client_t *client, sfp_daemon_state_data_t *state, const char *command, time_t daemon_uptime)
+{
+    /* USDT sfp:command__receive(fd, comando) / sfp:command__respond(fd, tipo, ns) */
+    SFP_PROBE2(command__receive, client->fd, command);
+
+    uint64_t start_ns = daemon_metrics_now_ns();
+    daemon_metrics_command_t type = daemon_socket_execute_command(client, state, command, daemon_uptime);
+    uint64_t elapsed_ns = daemon_metrics_now_ns() - start_ns;
+
+    daemon_metrics_command(type, elapsed_ns);
+    SFP_PROBE3(command__respond, client->fd, (int)type, elapsed_ns);
+}
+
+/* ============================================
+ * Fecha Conexão de Cliente
+ * ============================================ */
+static void daemon_socket_close_client(daemon_socket_server_t *server, daemon_socket_client_t *client)
+{
+    syslog(LOG_DEBUG, "Client disconnected (fd: %d)", client->fd);
+    if (server->epoll_fd >= 0) {
+        epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+    }
+    close(client->fd);
+    client->fd = -1;
+    client->rx_len = 0;
+    client->rx_discarding = false;
+    client->rx_closed = false;
+    client->events = 0;
+    client->evict = false;
+    client->subscribed = false;
+    daemon_outq_clear(&client->tx);
+    server->num_clients--;
+    daemon_metrics_socket_close();
+    daemon_socket_arm_listen(server);
+}
+
+/* Cliente pode receber mais uma resposta sem passar do limite de backpressure */
+static bool daemon_socket_client_writable(const daemon_socket_client_t *client)
+{
+    return !client->evict &&
+           client->tx.bytes < DAEMON_CLIENT_TX_HIGH_WATERMARK &&
+           daemon_outq_has_room(&client->tx, 3);
+}
+
+/* ============================================
+ * Extrai e Executa Linhas Completas do Buffer
+ * ============================================ */
+static int daemon_socket_dispatch_lines(daemon_socket_client_t *client, sfp_daemon_state_data_t *state, time_t daemon_uptime)
+{
+    int processed = 0;
+    size_t start = 0;
+
+    /* Cada '\n' fecha um comando; respostas saem na ordem de chegada.
+     * Com a fila de saída cheia, o resto fica no buffer até ela esvaziar. */
+    for (size_t i = 0; i < client->rx_len && daemon_socket_client_writable(client); i++) {
+        if (client->rx_buf[i] != '\n') {
+            continue;
+        }
+
+        if (client->rx_discarding) {
+            /* Fim da linha longa demais já respondida com erro */
+            client->rx_discarding = false;
+        } else {
+            size_t line_len = i - start;
+            if (line_len > 0 && client->rx_buf[start + line_len - 1] == '\r') {
+                line_len--;
+            }
+            if (line_len > 0) {
+                client->rx_buf[start + line_len] = '\0';
+                daemon_socket_process_client_command(client, state, &client->rx_buf[start], daemon_uptime);
+                processed++;
+            }
+        }
+        start = i + 1;
+    }
+
+    /* Move o resto (linhas ainda não executadas) para o início do buffer */
+    if (start > 0) {
+        memmove(client->rx_buf, &client->rx_buf[start], client->rx_len - start);
+        client->rx_len -= start;
+    }
+
+    /* Linha maior que qualquer comando válido: responde BAD_REQUEST uma vez
+     * e descarta o resto até o próximo '\n' */
+    if (client->rx_len >= DAEMON_MAX_COMMAND_LENGTH && memchr(client->rx_buf, '\n', client->rx_len) == NULL) {
+        if (!client->rx_discarding) {
+            client->rx_buf[client->rx_len] = '\0';
+            daemon_socket_process_client_command(client, state, client->rx_buf, daemon_uptime);
+            processed++;
+        }
+        client->rx_discarding = true;
+        client->rx_len = 0;
+    }
+
+    return processed;
+}
+
+/* ============================================
+ * Atende um Cliente (leitura, comandos, envio)
+ * ============================================ */
+static int daemon_socket_service_client(daemon_socket_server_t *server, daemon_socket_client_t *client, sfp_daemon_state_data_t *state, time_t daemon_uptime)
+{
+    int processed = 0;
+    bool closed = false;
+
+    /* Repete enquanto a fila esvaziar e ainda houver linhas retidas no buffer:
+     * sem isso, comandos já recebidos esperariam por um EPOLLIN que não vem */
+    do {
+        /* Envia o que está pendente antes de aceitar mais trabalho */
+        if (daemon_outq_flush(&client->tx, client->fd, daemon_socket_now_ms()) < 0) {
+            closed = true;
+            break;
+        }
+
+        /* Linhas que ficaram retidas pelo backpressure */
+        processed += daemon_socket_dispatch_lines(client, state, daemon_uptime);
+
+        /* Drena o socket: um write do cliente pode trazer vários comandos,
+         * e um comando pode chegar dividido entre vários recv() */
+        while (!client->rx_closed && daemon_socket_client_writable(client)) {
+            size_t space = sizeof(client->rx_buf) - client->rx_len - 1;
+            if (space == 0) {
+                break;
+            }
+
+            ssize_t bytes_read = recv(client->fd, &client->rx_buf[client->rx_len], space, 0);
+
+            if (bytes_read < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    /* Erro na conexão */
+                    closed = true;
+                }
+                break;
+            }
+
+            if (bytes_read == 0) {
+                /* Conexão fechada: executa o que ficou pendente, inclusive
+                 * um último comando sem '\n' (ex.: printf "PING" | nc -U) */
+                if (client->rx_discarding) {
+                    client->rx_len = 0;
+                } else if (client->rx_len > 0) {
+                    client->rx_buf[client->rx_len++] = '\n';
+                }
+                client->rx_closed = true;
+                processed += daemon_socket_dispatch_lines(client, state, daemon_uptime);
+                break;
+            }
+
+            client->rx_len += (size_t)bytes_read;
+            processed += daemon_socket_dispatch_lines(client, state, daemon_uptime);
+        }
+
+        /* Uma única chamada envia todas as respostas geradas nesta rodada */
+        if (daemon_outq_flush(&client->tx, client->fd, daemon_socket_now_ms()) < 0) {
+            closed = true;
+        }
+    } while (!closed && !client->evict && client->tx.count == 0 &&
+             memchr(client->rx_buf, '\n', client->rx_len) != NULL);
+
+    /* EOF recebido: fecha quando não houver mais nada a executar nem a enviar */
+    if (client->rx_closed && client->tx.count == 0 && client->rx_len == 0) {
+        closed = true;
+    }
+
+    if (closed || client->evict) {
+        daemon_socket_close_client(server, client);
+    } else {
+        daemon_socket_update_events(server, client);
+    }
+
+    return processed;
+}
+
+/* ============================================
+ * Aguarda e Atende Eventos
+ * ============================================ */
+int daemon_socket_poll(daemon_socket_server_t *server, sfp_daemon_state_data_t *state, time_t daemon_uptime, uint32_t timeout_ms)
+{
+    if (!server || !state || server->epoll_fd < 0) {
+        return 0;
+    }
+
+    int processed = 0;
+    uint64_t deadline_ms = daemon_socket_now_ms() + timeout_ms;
+
+    for (;;) {
+        uint64_t now_ms = daemon_socket_now_ms();
+        int wait_ms = (now_ms < deadline_ms) ? (int)(deadline_ms - now_ms) : 0;
+
+        struct epoll_event events[DAEMON_MAX_CONNECTIONS + 1];
+        int n = epoll_wait(server->epoll_fd, events, DAEMON_MAX_CONNECTIONS + 1, wait_ms);
+        if (n < 0 && errno != EINTR) {
+            syslog(LOG_WARNING, "epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            uint32_t tag = events[i].data.u32;
+            if (tag == DAEMON_SOCKET_LISTEN_TAG) {
+                daemon_socket_accept(server);
+            } else if (tag < DAEMON_MAX_CONNECTIONS && server->clients[tag].fd >= 0) {
+                processed += daemon_socket_service_client(server, &server->clients[tag], state, daemon_uptime);
+            }
+        }
+
+        daemon_socket_close_inactive(server);
+
+        if (n <= 0 && wait_ms == 0) {
+            break;
+        }
+        if (daemon_socket_now_ms() >= deadline_ms) {
+            break;
+        }
+    }
+
+    return processed;
+}
+
+/* ============================================
+ * Serializa Evento de Amostra (SUBSCRIBE DYNAMIC)
+ * ============================================ */
+static size_t serialize_sample_event(const sfp_daemon_state_data_t *state_copy, uint32_t fields, char *buf, size_t cap);
+
+/* Corpos de delta já serializados nesta publicação, por máscara de campos */
+#define DAEMON_DELTA_CACHE_SIZE 4
+
+typedef struct {
+    const sfp_daemon_state_data_t *state_copy;
+    daemon_chunk_t *full;
+    uint32_t delta_mask[DAEMON_DELTA_CACHE_SIZE];
+    daemon_chunk_t *delta[DAEMON_DELTA_CACHE_SIZE];
+    unsigned delta_count;
+} daemon_sample_bodies_t;
+
+/* Devolve uma referência nova (o chamador solta com daemon_chunk_unref) */
+static daemon_chunk_t *daemon_socket_sample_body(daemon_sample_bodies_t *bodies, uint32_t fields)
+{
+    /* Máscara completa: o delta é igual à amostra inteira */
+    if (fields == SFP_A2_CHANGED_ALL && bodies->full) {
+        return daemon_chunk_ref(bodies->full);
+    }
+
+    for (unsigned i = 0; i < bodies->delta_count; i++) {
+        if (bodies->delta_mask[i] == fields) {
+            return daemon_chunk_ref(bodies->delta[i]);
+        }
+    }
+
+    daemon_chunk_t *chunk = daemon_chunk_new(DAEMON_CHUNK_POOL_CAP);
+    if (!chunk) {
+        return NULL;
+    }
+    chunk->len = serialize_sample_event(bodies->state_copy, fields, chunk->data, chunk->cap);
+    if (chunk->len == 0) {
+        daemon_chunk_unref(chunk);
+        return NULL;
+    }
+
+    /* Cache cheio (assinantes com históricos muito diferentes): o chunk
+     * vale só para este cliente */
+    if (fields == SFP_A2_CHANGED_ALL) {
+        bodies->full = daemon_chunk_ref(chunk);
+    } else if (bodies->delta_count < DAEMON_DELTA_CACHE_SIZE) {
+        bodies->delta_mask[bodies->delta_count] = fields;
+        bodies->delta[bodies->delta_count++] = daemon_chunk_ref(chunk);
+    }
+    return chunk;
+}
+
+/* Enfileira e tenta enviar um frame de push (head de head_len bytes + body;
+ * head NULL: body é o frame binário pronto); false se o cliente não tinha espaço */
+static bool daemon_socket_push_frame(daemon_socket_server_t *server, daemon_socket_client_t *client, const char *head, size_t head_len, daemon_chunk_t *body)
+{
+    /* Backpressure: assinante lento perde frames; se parar de ler de vez,
+     * cai pelo stall timeout */
+    if (!daemon_socket_client_writable(client)) {
+        return false;
+    }
+    bool queued = head
+        ? daemon_socket_queue_frame(client, head, head_len, body)
+        : daemon_socket_queue_binary(client, body);
+    if (!queued) {
+        return false;
+    }
+
+    if (daemon_outq_flush(&client->tx, client->fd, daemon_socket_now_ms()) < 0) {
+        daemon_socket_close_client(server, client);
+        return true;
     }
+    daemon_socket_update_events(server, client);
+    return true;
+}
+
+static bool daemon_socket_push(daemon_socket_server_t *server, daemon_socket_client_t *client, const char *head, daemon_chunk_t *body)
+{
+    return daemon_socket_push_frame(server, client, head, head ? strlen(head) : 0, body);
+}
+
+/* ============================================
+ * Eventos de Alarme (daemon_alarm.h)
+ * ============================================ */
+/* Cada transição nova vai para todos os assinantes, sem decimação */
+static void daemon_socket_publish_alarms(daemon_socket_server_t *server, uint64_t last_seq)
+{
+    daemon_alarm_event_t events[DAEMON_ALARM_QUEUE_SIZE];
+    bool lost = false;
+    size_t count = daemon_alarm_events_since(server->published_alarm_seq, events, DAEMON_ALARM_QUEUE_SIZE, &lost);
+    server->published_alarm_seq = count > 0 ? events[count - 1].seq : last_seq;
+    if (lost) {
+        syslog(LOG_WARNING, "Alarm events overflowed the queue before publish");
+    }
+
+    for (size_t n = 0; n < count; n++) {
+        char json[512];
+        daemon_json_t w;
+        daemon_json_init(&w, json, sizeof(json));
+        serialize_alarm_event(&w, NULL, &events[n]);
+        size_t len = daemon_json_finish(&w);
+        daemon_chunk_t *body = len ? daemon_socket_binary_chunk((const uint8_t *)json, len) : NULL;
+        if (!body) {
+            continue;
+        }
+
+        char text_head[DAEMON_OUTQ_INLINE_SIZE];
+        int text_len = snprintf(text_head, sizeof(text_head), "EVENT ALARM %llu\n", (unsigned long long)events[n].seq);
 
-    /* Envia resposta */
-    if (json_response) {
-        char status_line[256];
-        snprintf(status_line, sizeof(status_line), "STATUS %d %s\n", status_code, status_msg);
-        send(client_fd, status_line, strlen(status_line), 0);
-        send(client_fd, json_response, strlen(json_response), 0);
-        send(client_fd, "\n", 1, 0);
-        free(json_response);
+        /* Binário: a mesma linha embrulhada num frame TEXT */
+        char binary_head[DAEMON_OUTQ_INLINE_SIZE];
+        sfp_wire_header_t hdr = {
+            .type = SFP_WIRE_TYPE_TEXT,
+            .payload_len = (uint32_t)((size_t)text_len + body->len + 1),
+        };
+        sfp_wire_encode_header((uint8_t *)binary_head, &hdr);
+        memcpy(binary_head + SFP_WIRE_HEADER_SIZE, text_head, (size_t)text_len + 1);
+
+        for (int i = 0; i < DAEMON_MAX_CONNECTIONS; i++) {
+            daemon_socket_client_t *client = &server->clients[i];
+            if (client->fd < 0 || !client->subscribed || client->evict) {
+                continue;
+            }
+            if (client->format == DAEMON_FORMAT_BINARY) {
+                daemon_socket_push_frame(server, client, binary_head, SFP_WIRE_HEADER_SIZE + (size_t)text_len, body);
+            } else {
+                daemon_socket_push_frame(server, client, text_head, (size_t)text_len, body);
+            }
+        }
+        daemon_chunk_unref(body);
     }
 }
 
 /* ============================================
- * Processa Comandos Pendentes
+ * Publica Novidades para Assinantes
  * ============================================ */
-int daemon_socket_process_commands(daemon_socket_server_t *server, sfp_daemon_state_data_t *state, time_t daemon_uptime)
+void daemon_socket_publish(daemon_socket_server_t *server, sfp_daemon_state_data_t *state)
 {
     if (!server || !state) {
-        return 0;
+        return;
     }
 
-    int processed = 0;
+    unsigned subscribers = 0;
+    for (int i = 0; i < DAEMON_MAX_CONNECTIONS; i++) {
+        if (server->clients[i].fd >= 0 && server->clients[i].subscribed) {
+            subscribers++;
+        }
+    }
+    daemon_metrics_set_subscribers(subscribers);
+
+    pthread_mutex_lock(&state->mutex);
+    uint64_t seq = state->sample_seq;
+    sfp_daemon_state_t fsm_state = state->state;
+    uint64_t generation_id = state->generation_id;
+    pthread_mutex_unlock(&state->mutex);
+
+    bool state_changed = fsm_state != server->published_state ||
+                         generation_id != server->published_generation_id;
+    bool generation_changed = generation_id != server->published_generation_id;
+    bool new_sample = seq != server->published_seq;
+    uint64_t alarm_seq = daemon_alarm_last_seq();
+    bool new_alarms = alarm_seq != server->published_alarm_seq;
+
+    server->published_state = fsm_state;
+    server->published_generation_id = generation_id;
+    server->published_seq = seq;
+
+    if (subscribers == 0) {
+        server->published_alarm_seq = alarm_seq;
+        return;
+    }
+    if (!state_changed && !new_sample && !new_alarms) {
+        return;
+    }
+
+    /* Transição da FSM: sai antes da amostra para o cliente saber o contexto */
+    if (state_changed) {
+        daemon_chunk_t *json_body = NULL;
+        daemon_chunk_t *binary = NULL;
+        for (int i = 0; i < DAEMON_MAX_CONNECTIONS; i++) {
+            daemon_socket_client_t *client = &server->clients[i];
+            if (client->fd < 0 || !client->subscribed || client->evict) {
+                continue;
+            }
+            /* Módulo novo: a base do delta do cliente não vale mais */
+            if (generation_changed) {
+                client->pending_changed = SFP_A2_CHANGED_ALL;
+            }
+
+            if (client->format == DAEMON_FORMAT_BINARY) {
+                if (!binary) {
+                    uint8_t frame[SFP_WIRE_HEADER_SIZE + SFP_WIRE_STATE_SIZE];
+                    binary = daemon_socket_binary_chunk(frame, daemon_socket_frame_state(state, frame));
+                }
+                if (binary) {
+                    daemon_socket_push(server, client, NULL, binary);
+                }
+            } else {
+                if (!json_body) {
+                    json_body = daemon_chunk_new(DAEMON_CHUNK_POOL_CAP);
+                    if (json_body) {
+                        json_body->len = daemon_socket_serialize_state(state, json_body->data, json_body->cap);
+                    }
+                }
+                if (json_body) {
+                    daemon_socket_push(server, client, "EVENT STATE\n", json_body);
+                }
+            }
+        }
+        daemon_chunk_unref(json_body);
+        daemon_chunk_unref(binary);
+    }
+
+    /* Alarmes antes da amostra que os causou: a latência é a da aquisição */
+    if (new_alarms) {
+        daemon_socket_publish_alarms(server, alarm_seq);
+    }
+
+    if (!new_sample) {
+        return;
+    }
+
+    /* Nova amostra: cada corpo é serializado uma vez e o mesmo chunk vai para
+     * todos os assinantes que precisam dele */
+    sfp_daemon_state_data_t state_copy;
+    daemon_state_get_copy(state, &state_copy);
+
+    daemon_sample_bodies_t bodies = { .state_copy = &state_copy };
+    daemon_chunk_t *binary = NULL;
+    char sample_head[DAEMON_OUTQ_INLINE_SIZE];
+    char delta_head[DAEMON_OUTQ_INLINE_SIZE];
+    snprintf(sample_head, sizeof(sample_head), "EVENT SAMPLE %llu\n", (unsigned long long)state_copy.sample_seq);
+    snprintf(delta_head, sizeof(delta_head), "EVENT DELTA %llu\n", (unsigned long long)state_copy.sample_seq);
 
     for (int i = 0; i < DAEMON_MAX_CONNECTIONS; i++) {
-        if (server->client_fds[i] < 0) {
+        daemon_socket_client_t *client = &server->clients[i];
+        if (client->fd < 0 || !client->subscribed || client->evict) {
             continue;
         }
 
-        char buffer[1024];
-        ssize_t bytes_read = recv(server->client_fds[i], buffer, sizeof(buffer) - 1, 0);
+        /* Amostras puladas (decimação ou fila cheia) acumulam os campos
+         * alterados para o próximo delta enviado */
+        client->pending_changed |= state_copy.a2_changed;
 
-        if (bytes_read < 0) {
-            if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                /* Erro ou conexão fechada */
-                close(server->client_fds[i]);
-                server->client_fds[i] = -1;
-                server->num_clients--;
+        if (++client->decimation_count < client->decimation) {
+            continue;
+        }
+        client->decimation_count = 0;
+
+        /* Binário: o registro de 48 bytes vai sempre completo (o mesmo frame
+         * do GET DYNAMIC) */
+        if (client->format == DAEMON_FORMAT_BINARY) {
+            if (!binary) {
+                binary = daemon_socket_dynamic_body(state, DAEMON_FORMAT_BINARY);
+            }
+            if (binary && daemon_socket_push(server, client, NULL, binary)) {
+                client->pending_changed = 0;
             }
             continue;
         }
 
-        if (bytes_read == 0) {
-            /* Conexão fechada */
-            close(server->client_fds[i]);
-            server->client_fds[i] = -1;
-            server->num_clients--;
+        uint32_t fields = client->delta ? client->pending_changed : SFP_A2_CHANGED_ALL;
+        daemon_chunk_t *body = daemon_socket_sample_body(&bodies, fields);
+        if (!body) {
             continue;
         }
 
-        buffer[bytes_read] = '\0';
-        daemon_socket_process_client_command(server->client_fds[i], state, buffer, daemon_uptime);
-        processed++;
+        if (daemon_socket_push(server, client, client->delta ? delta_head : sample_head, body)) {
+            client->pending_changed = 0;
+        }
+        daemon_chunk_unref(body);
     }
 
-    return processed;
+    daemon_chunk_unref(binary);
+    daemon_chunk_unref(bodies.full);
+    for (unsigned j = 0; j < bodies.delta_count; j++) {
+        daemon_chunk_unref(bodies.delta[j]);
+    }
 }
 
 /* ============================================
@@ -320,8 +1633,23 @@ void daemon_socket_close_inactive(daemon_socket_server_t *server)
         return;
     }
 
-    /* Implementação futura: timeout de conexões */
-    /* Por enquanto, conexões são fechadas apenas quando cliente desconecta */
+    uint64_t now_ms = daemon_socket_now_ms();
+
+    /* Conexões ociosas sem resposta pendente são mantidas; só são fechados
+     * clientes que pararam de ler as respostas (fila sem progresso) */
+    for (int i = 0; i < DAEMON_MAX_CONNECTIONS; i++) {
+        daemon_socket_client_t *client = &server->clients[i];
+        if (client->fd < 0) {
+            continue;
+        }
+
+        bool stalled = client->tx.count > 0 &&
+                       now_ms - client->tx.last_progress_ms > DAEMON_CLIENT_STALL_TIMEOUT_MS;
+        if (stalled || client->evict) {
+            syslog(LOG_WARNING, "Evicting client (fd: %d, %zu bytes pending)", client->fd, client->tx.bytes);
+            daemon_socket_close_client(server, client);
+        }
+    }
 }
 
 /* ============================================
@@ -329,92 +1657,92 @@ void daemon_socket_close_inactive(daemon_socket_server_t *server)
  * ============================================ */
 
 /* Serializa compliance codes decodificados */
-static void serialize_compliance_codes(cJSON *obj, const sfp_compliance_decoded_t *dc)
-{
-    if (!obj || !dc) return;
-
-    cJSON *byte3 = cJSON_CreateObject();
-    cJSON_AddBoolToObject(byte3, "eth_10g_base_sr", dc->eth_10g_base_sr);
-    cJSON_AddBoolToObject(byte3, "eth_10g_base_lr", dc->eth_10g_base_lr);
-    cJSON_AddBoolToObject(byte3, "eth_10g_base_lrm", dc->eth_10g_base_lrm);
-    cJSON_AddBoolToObject(byte3, "eth_10g_base_er", dc->eth_10g_base_er);
-    cJSON_AddBoolToObject(byte3, "infiniband_1x_sx", dc->infiniband_1x_sx);
-    cJSON_AddBoolToObject(byte3, "infiniband_1x_lx", dc->infiniband_1x_lx);
-    cJSON_AddBoolToObject(byte3, "infiniband_1x_copper_active", dc->infiniband_1x_copper_active);
-    cJSON_AddBoolToObject(byte3, "infiniband_1x_copper_passive", dc->infiniband_1x_copper_passive);
-    cJSON_AddItemToObject(obj, "byte3_ethernet_infiniband", byte3);
-
-    cJSON *byte4 = cJSON_CreateObject();
-    cJSON_AddBoolToObject(byte4, "escon_mmf", dc->escon_mmf);
-    cJSON_AddBoolToObject(byte4, "escon_smf", dc->escon_smf);
-    cJSON_AddBoolToObject(byte4, "oc_192_sr", dc->oc_192_sr);
-    cJSON_AddBoolToObject(byte4, "sonet_rs_1", dc->sonet_rs_1);
-    cJSON_AddBoolToObject(byte4, "sonet_rs_2", dc->sonet_rs_2);
-    cJSON_AddBoolToObject(byte4, "oc_48_lr", dc->oc_48_lr);
-    cJSON_AddBoolToObject(byte4, "oc_48_ir", dc->oc_48_ir);
-    cJSON_AddBoolToObject(byte4, "oc_48_sr", dc->oc_48_sr);
-    cJSON_AddItemToObject(obj, "byte4_escon_sonet", byte4);
-
-    cJSON *byte5 = cJSON_CreateObject();
-    cJSON_AddBoolToObject(byte5, "oc_12_sm_lr", dc->oc_12_sm_lr);
-    cJSON_AddBoolToObject(byte5, "oc_12_sm_ir", dc->oc_12_sm_ir);
-    cJSON_AddBoolToObject(byte5, "oc_12_sr", dc->oc_12_sr);
-    cJSON_AddBoolToObject(byte5, "oc_3_sm_lr", dc->oc_3_sm_lr);
-    cJSON_AddBoolToObject(byte5, "oc_3_sm_ir", dc->oc_3_sm_ir);
-    cJSON_AddBoolToObject(byte5, "oc_3_sr", dc->oc_3_sr);
-    cJSON_AddItemToObject(obj, "byte5_sonet", byte5);
-
-    cJSON *byte6 = cJSON_CreateObject();
-    cJSON_AddBoolToObject(byte6, "eth_base_px", dc->eth_base_px);
-    cJSON_AddBoolToObject(byte6, "eth_base_bx_10", dc->eth_base_bx_10);
-    cJSON_AddBoolToObject(byte6, "eth_100_base_fx", dc->eth_100_base_fx);
-    cJSON_AddBoolToObject(byte6, "eth_100_base_lx", dc->eth_100_base_lx);
-    cJSON_AddBoolToObject(byte6, "eth_1000_base_t", dc->eth_1000_base_t);
-    cJSON_AddBoolToObject(byte6, "eth_1000_base_cx", dc->eth_1000_base_cx);
-    cJSON_AddBoolToObject(byte6, "eth_1000_base_lx", dc->eth_1000_base_lx);
-    cJSON_AddBoolToObject(byte6, "eth_1000_base_sx", dc->eth_1000_base_sx);
-    cJSON_AddItemToObject(obj, "byte6_ethernet_1g", byte6);
-
-    cJSON *byte7 = cJSON_CreateObject();
-    cJSON_AddBoolToObject(byte7, "fc_very_long_distance", dc->fc_very_long_distance);
-    cJSON_AddBoolToObject(byte7, "fc_short_distance", dc->fc_short_distance);
-    cJSON_AddBoolToObject(byte7, "fc_intermediate_distance", dc->fc_intermediate_distance);
-    cJSON_AddBoolToObject(byte7, "fc_long_distance", dc->fc_long_distance);
-    cJSON_AddBoolToObject(byte7, "fc_medium_distance", dc->fc_medium_distance);
-    cJSON_AddBoolToObject(byte7, "shortwave_laser_sa", dc->shortwave_laser_sa);
-    cJSON_AddBoolToObject(byte7, "longwave_laser_lc", dc->longwave_laser_lc);
-    cJSON_AddBoolToObject(byte7, "electrical_inter_enclosure", dc->electrical_inter_enclosure);
-    cJSON_AddItemToObject(obj, "byte7_fc_link_length", byte7);
-
-    cJSON *byte8 = cJSON_CreateObject();
-    cJSON_AddBoolToObject(byte8, "electrical_intra_enclosure", dc->electrical_intra_enclosure);
-    cJSON_AddBoolToObject(byte8, "shortwave_laser_sn", dc->shortwave_laser_sn);
-    cJSON_AddBoolToObject(byte8, "shortwave_laser_sl", dc->shortwave_laser_sl);
-    cJSON_AddBoolToObject(byte8, "longwave_laser_ll", dc->longwave_laser_ll);
-    cJSON_AddBoolToObject(byte8, "active_cable", dc->active_cable);
-    cJSON_AddBoolToObject(byte8, "passive_cable", dc->passive_cable);
-    cJSON_AddItemToObject(obj, "byte8_fc_technology", byte8);
-
-    cJSON *byte9 = cJSON_CreateObject();
-    cJSON_AddBoolToObject(byte9, "twin_axial_pair", dc->twin_axial_pair);
-    cJSON_AddBoolToObject(byte9, "twisted_pair", dc->twisted_pair);
-    cJSON_AddBoolToObject(byte9, "miniature_coax", dc->miniature_coax);
-    cJSON_AddBoolToObject(byte9, "video_coax", dc->video_coax);
-    cJSON_AddBoolToObject(byte9, "multimode_m6", dc->multimode_m6);
-    cJSON_AddBoolToObject(byte9, "multimode_m5", dc->multimode_m5);
-    cJSON_AddBoolToObject(byte9, "single_mode", dc->single_mode);
-    cJSON_AddItemToObject(obj, "byte9_fc_transmission_media", byte9);
-
-    cJSON *byte10 = cJSON_CreateObject();
-    cJSON_AddBoolToObject(byte10, "cs_1200_mbps", dc->cs_1200_mbps);
-    cJSON_AddBoolToObject(byte10, "cs_800_mbps", dc->cs_800_mbps);
-    cJSON_AddBoolToObject(byte10, "cs_1600_mbps", dc->cs_1600_mbps);
-    cJSON_AddBoolToObject(byte10, "cs_400_mbps", dc->cs_400_mbps);
-    cJSON_AddBoolToObject(byte10, "cs_3200_mbps", dc->cs_3200_mbps);
-    cJSON_AddBoolToObject(byte10, "cs_200_mbps", dc->cs_200_mbps);
-    cJSON_AddBoolToObject(byte10, "see_byte_62", dc->see_byte_62);
-    cJSON_AddBoolToObject(byte10, "cs_100_mbps", dc->cs_100_mbps);
-    cJSON_AddItemToObject(obj, "byte10_fc_channel_speed", byte10);
+static void serialize_compliance_codes(daemon_json_t *w, const sfp_compliance_decoded_t *dc)
+{
+    if (!w || !dc) return;
+
+    daemon_json_object_begin(w, "byte3_ethernet_infiniband");
+    daemon_json_bool(w, "eth_10g_base_sr", dc->eth_10g_base_sr);
+    daemon_json_bool(w, "eth_10g_base_lr", dc->eth_10g_base_lr);
+    daemon_json_bool(w, "eth_10g_base_lrm", dc->eth_10g_base_lrm);
+    daemon_json_bool(w, "eth_10g_base_er", dc->eth_10g_base_er);
+    daemon_json_bool(w, "infiniband_1x_sx", dc->infiniband_1x_sx);
+    daemon_json_bool(w, "infiniband_1x_lx", dc->infiniband_1x_lx);
+    daemon_json_bool(w, "infiniband_1x_copper_active", dc->infiniband_1x_copper_active);
+    daemon_json_bool(w, "infiniband_1x_copper_passive", dc->infiniband_1x_copper_passive);
+    daemon_json_object_end(w);
+
+    daemon_json_object_begin(w, "byte4_escon_sonet");
+    daemon_json_bool(w, "escon_mmf", dc->escon_mmf);
+    daemon_json_bool(w, "escon_smf", dc->escon_smf);
+    daemon_json_bool(w, "oc_192_sr", dc->oc_192_sr);
+    daemon_json_bool(w, "sonet_rs_1", dc->sonet_rs_1);
+    daemon_json_bool(w, "sonet_rs_2", dc->sonet_rs_2);
+    daemon_json_bool(w, "oc_48_lr", dc->oc_48_lr);
+    daemon_json_bool(w, "oc_48_ir", dc->oc_48_ir);
+    daemon_json_bool(w, "oc_48_sr", dc->oc_48_sr);
+    daemon_json_object_end(w);
+
+    daemon_json_object_begin(w, "byte5_sonet");
+    daemon_json_bool(w, "oc_12_sm_lr", dc->oc_12_sm_lr);
+    daemon_json_bool(w, "oc_12_sm_ir", dc->oc_12_sm_ir);
+    daemon_json_bool(w, "oc_12_sr", dc->oc_12_sr);
+    daemon_json_bool(w, "oc_3_sm_lr", dc->oc_3_sm_lr);
+    daemon_json_bool(w, "oc_3_sm_ir", dc->oc_3_sm_ir);
+    daemon_json_bool(w, "oc_3_sr", dc->oc_3_sr);
+    daemon_json_object_end(w);
+
+    daemon_json_object_begin(w, "byte6_ethernet_1g");
+    daemon_json_bool(w, "eth_base_px", dc->eth_base_px);
+    daemon_json_bool(w, "eth_base_bx_10", dc->eth_base_bx_10);
+    daemon_json_bool(w, "eth_100_base_fx", dc->eth_100_base_fx);
+    daemon_json_bool(w, "eth_100_base_lx", dc->eth_100_base_lx);
+    daemon_json_bool(w, "eth_1000_base_t", dc->eth_1000_base_t);
+    daemon_json_bool(w, "eth_1000_base_cx", dc->eth_1000_base_cx);
+    daemon_json_bool(w, "eth_1000_base_lx", dc->eth_1000_base_lx);
+    daemon_json_bool(w, "eth_1000_base_sx", dc->eth_1000_base_sx);
+    daemon_json_object_end(w);
+
+    daemon_json_object_begin(w, "byte7_fc_link_length");
+    daemon_json_bool(w, "fc_very_long_distance", dc->fc_very_long_distance);
+    daemon_json_bool(w, "fc_short_distance", dc->fc_short_distance);
+    daemon_json_bool(w, "fc_intermediate_distance", dc->fc_intermediate_distance);
+    daemon_json_bool(w, "fc_long_distance", dc->fc_long_distance);
+    daemon_json_bool(w, "fc_medium_distance", dc->fc_medium_distance);
+    daemon_json_bool(w, "shortwave_laser_sa", dc->shortwave_laser_sa);
+    daemon_json_bool(w, "longwave_laser_lc", dc->longwave_laser_lc);
+    daemon_json_bool(w, "electrical_inter_enclosure", dc->electrical_inter_enclosure);
+    daemon_json_object_end(w);
+
+    daemon_json_object_begin(w, "byte8_fc_technology");
+    daemon_json_bool(w, "electrical_intra_enclosure", dc->electrical_intra_enclosure);
+    daemon_json_bool(w, "shortwave_laser_sn", dc->shortwave_laser_sn);
+    daemon_json_bool(w, "shortwave_laser_sl", dc->shortwave_laser_sl);
+    daemon_json_bool(w, "longwave_laser_ll", dc->longwave_laser_ll);
+    daemon_json_bool(w, "active_cable", dc->active_cable);
+    daemon_json_bool(w, "passive_cable", dc->passive_cable);
+    daemon_json_object_end(w);
+
+    daemon_json_object_begin(w, "byte9_fc_transmission_media");
+    daemon_json_bool(w, "twin_axial_pair", dc->twin_axial_pair);
+    daemon_json_bool(w, "twisted_pair", dc->twisted_pair);
+    daemon_json_bool(w, "miniature_coax", dc->miniature_coax);
+    daemon_json_bool(w, "video_coax", dc->video_coax);
+    daemon_json_bool(w, "multimode_m6", dc->multimode_m6);
+    daemon_json_bool(w, "multimode_m5", dc->multimode_m5);
+    daemon_json_bool(w, "single_mode", dc->single_mode);
+    daemon_json_object_end(w);
+
+    daemon_json_object_begin(w, "byte10_fc_channel_speed");
+    daemon_json_bool(w, "cs_1200_mbps", dc->cs_1200_mbps);
+    daemon_json_bool(w, "cs_800_mbps", dc->cs_800_mbps);
+    daemon_json_bool(w, "cs_1600_mbps", dc->cs_1600_mbps);
+    daemon_json_bool(w, "cs_400_mbps", dc->cs_400_mbps);
+    daemon_json_bool(w, "cs_3200_mbps", dc->cs_3200_mbps);
+    daemon_json_bool(w, "cs_200_mbps", dc->cs_200_mbps);
+    daemon_json_bool(w, "see_byte_62", dc->see_byte_62);
+    daemon_json_bool(w, "cs_100_mbps", dc->cs_100_mbps);
+    daemon_json_object_end(w);
 }
 
 /* Serializa identifier type como string */
@@ -545,390 +1873,754 @@ static const char* ext_compliance_to_string(sfp_extended_spec_compliance_code_t
 }
 
 /* Serializa A0h completo */
-static void serialize_a0h_complete(cJSON *a0_obj, const sfp_a0h_base_t *a0)
+static void serialize_a0h_complete(daemon_json_t *w, const sfp_a0h_base_t *a0)
 {
-    if (!a0_obj || !a0) return;
+    if (!w || !a0) return;
 
     /* Byte 0 - Identifier */
     uint8_t identifier = sfp_a0_get_identifier(a0);
-    cJSON_AddNumberToObject(a0_obj, "identifier", identifier);
-    cJSON_AddStringToObject(a0_obj, "identifier_type", identifier_type_to_string((sfp_identifier_t)identifier));
+    daemon_json_number(w, "identifier", identifier);
+    daemon_json_string(w, "identifier_type", identifier_type_to_string((sfp_identifier_t)identifier));
 
     /* Byte 1 - Extended Identifier */
     uint8_t ext_identifier = sfp_a0_get_ext_identifier(a0);
     bool ext_id_valid = sfp_validate_ext_identifier(a0);
-    cJSON_AddNumberToObject(a0_obj, "ext_identifier", ext_identifier);
-    cJSON_AddBoolToObject(a0_obj, "ext_identifier_valid", ext_id_valid);
+    daemon_json_number(w, "ext_identifier", ext_identifier);
+    daemon_json_bool(w, "ext_identifier_valid", ext_id_valid);
 
     /* Byte 2 - Connector */
     sfp_connector_type_t connector = sfp_a0_get_connector(a0);
     const char *connector_str = sfp_connector_to_string(connector);
-    cJSON_AddNumberToObject(a0_obj, "connector", connector);
-    cJSON_AddStringToObject(a0_obj, "connector_type", connector_str);
+    daemon_json_number(w, "connector", connector);
+    daemon_json_string(w, "connector_type", connector_str);
 
     /* Bytes 3-10 - Compliance Codes */
-    serialize_compliance_codes(a0_obj, &a0->dc);
+    serialize_compliance_codes(w, &a0->dc);
 
     /* Byte 11 - Encoding */
     sfp_encoding_codes_t encoding = sfp_a0_get_encoding(a0);
-    cJSON_AddNumberToObject(a0_obj, "encoding", encoding);
+    daemon_json_number(w, "encoding", encoding);
 
     /* Byte 12 - Nominal Rate */
     sfp_nominal_rate_status_t nominal_rate_status;
     uint8_t nominal_rate = sfp_a0_get_nominal_rate_mbd(a0, &nominal_rate_status);
-    cJSON_AddNumberToObject(a0_obj, "nominal_rate_mbd", nominal_rate);
-    cJSON_AddNumberToObject(a0_obj, "nominal_rate_status", nominal_rate_status);
+    daemon_json_number(w, "nominal_rate_mbd", nominal_rate);
+    daemon_json_number(w, "nominal_rate_status", nominal_rate_status);
 
     /* Byte 13 - Rate Identifier */
     sfp_rate_select rate_id = sfp_a0_get_rate_identifier(a0);
-    cJSON_AddNumberToObject(a0_obj, "rate_identifier", rate_id);
+    daemon_json_number(w, "rate_identifier", rate_id);
 
     /* Byte 14 - SMF Length or Copper Attenuation */
     sfp_smf_length_status_t smf_status_km;
     uint16_t smf_len_km = sfp_a0_get_smf_length_km(a0, &smf_status_km);
-    cJSON_AddNumberToObject(a0_obj, "smf_length_km", smf_len_km);
-    cJSON_AddNumberToObject(a0_obj, "smf_length_status_km", smf_status_km);
+    daemon_json_number(w, "smf_length_km", smf_len_km);
+    daemon_json_number(w, "smf_length_status_km", smf_status_km);
 
     /* Byte 15 SMF Length or Copper Attenuation (units 100m) */
     sfp_smf_length_status_t smf_status_m;
     uint16_t smf_len_m = sfp_a0_get_smf_length_m(a0, &smf_status_m);
-    cJSON_AddNumberToObject(a0_obj, "smf_length_m", smf_len_m);
-    cJSON_AddNumberToObject(a0_obj, "smf_length_status_m", smf_status_m);
+    daemon_json_number(w, "smf_length_m", smf_len_m);
+    daemon_json_number(w, "smf_length_status_m", smf_status_m);
 
     /* Byte 16 - OM2 Length */
     sfp_om2_length_status_t om2_status;
     uint16_t om2_len = sfp_a0_get_om2_length_m(a0, &om2_status);
-    cJSON_AddNumberToObject(a0_obj, "om2_length_m", om2_len);
-    cJSON_AddNumberToObject(a0_obj, "om2_length_status", om2_status);
+    daemon_json_number(w, "om2_length_m", om2_len);
+    daemon_json_number(w, "om2_length_status", om2_status);
 
     /* Byte 17 - OM1 Length */
     sfp_om1_length_status_t om1_status;
     uint16_t om1_len = sfp_a0_get_om1_length_m(a0, &om1_status);
-    cJSON_AddNumberToObject(a0_obj, "om1_length_m", om1_len);
-    cJSON_AddNumberToObject(a0_obj, "om1_length_status", om1_status);
+    daemon_json_number(w, "om1_length_m", om1_len);
+    daemon_json_number(w, "om1_length_status", om1_status);
 
     /* Byte 18 - OM4 or Copper Length */
     sfp_om4_length_status_t om4_status;
     uint16_t om4_copper_len = sfp_a0_get_om4_copper_or_length_m(a0, &om4_status);
-    cJSON_AddNumberToObject(a0_obj, "om4_or_copper_length_m", om4_copper_len);
-    cJSON_AddNumberToObject(a0_obj, "om4_or_copper_length_status", om4_status);
+    daemon_json_number(w, "om4_or_copper_length_m", om4_copper_len);
+    daemon_json_number(w, "om4_or_copper_length_status", om4_status);
 
     /* Byte 19 - OM3 or OM3 or Optical/Cable Physical Interconnect Length */
     sfp_om3_length_status_t om3_status;
     uint32_t om3_len = sfp_a0_get_om3_cable_length_m(a0, &om3_status);
-    cJSON_AddNumberToObject(a0_obj, "om3_length_m", om3_len);
-    cJSON_AddNumberToObject(a0_obj, "om3_length_status", om3_status);
+    daemon_json_number(w, "om3_length_m", om3_len);
+    daemon_json_number(w, "om3_length_status", om3_status);
 
     /* Bytes 20-35 - Vendor Name */
     char vendor_name[SFP_A0_LEN_VENDOR_NAME + 1] = {0};
     bool vendor_name_valid = sfp_a0_get_vendor_name(a0, vendor_name);
-    cJSON_AddStringToObject(a0_obj, "vendor_name", vendor_name_valid && vendor_name[0] ? vendor_name : "");
-    cJSON_AddBoolToObject(a0_obj, "vendor_name_valid", vendor_name_valid);
+    daemon_json_string(w, "vendor_name", vendor_name_valid && vendor_name[0] ? vendor_name : "");
+    daemon_json_bool(w, "vendor_name_valid", vendor_name_valid);
 
     /* Byte 36 - Extended Compliance */
     sfp_extended_spec_compliance_code_t ext_compliance = sfp_a0_get_ext_compliance(a0);
-    cJSON_AddNumberToObject(a0_obj, "ext_compliance_code", ext_compliance);
-    cJSON_AddStringToObject(a0_obj, "ext_compliance_desc", ext_compliance_to_string(ext_compliance));
+    daemon_json_number(w, "ext_compliance_code", ext_compliance);
+    daemon_json_string(w, "ext_compliance_desc", ext_compliance_to_string(ext_compliance));
 
     /* Bytes 37-39 - Vendor OUI */
     uint8_t vendor_oui_raw[3] = {0};
     bool vendor_oui_valid = sfp_a0_get_vendor_oui(a0, vendor_oui_raw);
     uint32_t vendor_oui_u32 = sfp_vendor_oui_to_u32(a0);
-    cJSON_AddBoolToObject(a0_obj, "vendor_oui_valid", vendor_oui_valid);
+    daemon_json_bool(w, "vendor_oui_valid", vendor_oui_valid);
     if (vendor_oui_valid) {
-        cJSON *oui_array = cJSON_CreateArray();
-        cJSON_AddItemToArray(oui_array, cJSON_CreateNumber(vendor_oui_raw[0]));
-        cJSON_AddItemToArray(oui_array, cJSON_CreateNumber(vendor_oui_raw[1]));
-        cJSON_AddItemToArray(oui_array, cJSON_CreateNumber(vendor_oui_raw[2]));
-        cJSON_AddItemToObject(a0_obj, "vendor_oui", oui_array);
-        cJSON_AddNumberToObject(a0_obj, "vendor_oui_u32", vendor_oui_u32);
+        daemon_json_array_begin(w, "vendor_oui");
+        daemon_json_uint(w, NULL, vendor_oui_raw[0]);
+        daemon_json_uint(w, NULL, vendor_oui_raw[1]);
+        daemon_json_uint(w, NULL, vendor_oui_raw[2]);
+        daemon_json_array_end(w);
+        daemon_json_number(w, "vendor_oui_u32", vendor_oui_u32);
     }
 
     /* Bytes 40-55 - Vendor Part Number */
     const char *vendor_pn = NULL;
     bool vendor_pn_valid = sfp_a0_get_vendor_pn(a0, &vendor_pn);
-    cJSON_AddStringToObject(a0_obj, "vendor_pn", vendor_pn_valid && vendor_pn ? vendor_pn : "");
-    cJSON_AddBoolToObject(a0_obj, "vendor_pn_valid", vendor_pn_valid);
+    daemon_json_string(w, "vendor_pn", vendor_pn_valid && vendor_pn ? vendor_pn : "");
+    daemon_json_bool(w, "vendor_pn_valid", vendor_pn_valid);
 
     /* Bytes 56-59 - Vendor Revision */
     char vendor_rev[5] = {0};
     bool vendor_rev_valid = sfp_a0_get_vendor_rev(a0, vendor_rev);
-    cJSON_AddStringToObject(a0_obj, "vendor_rev", vendor_rev_valid ? vendor_rev : "");
-    cJSON_AddStringToObject(a0_obj, "vendor_rev_valid", vendor_rev_valid ? "valido": "invalido");
+    daemon_json_string(w, "vendor_rev", vendor_rev_valid ? vendor_rev : "");
+    daemon_json_string(w, "vendor_rev_valid", vendor_rev_valid ? "valido": "invalido");
 
     /* Bytes 60-61 - Wavelength or Cable Compliance */
     sfp_variant_t variant = sfp_a0_get_variant(a0);
-    cJSON_AddNumberToObject(a0_obj, "variant", variant);
+    daemon_json_number(w, "variant", variant);
     if (variant == SFP_VARIANT_OPTICAL) {
         uint16_t wavelength = 0;
         if (sfp_a0_get_wavelength_nm(a0, &wavelength)) {
-            cJSON_AddNumberToObject(a0_obj, "wavelength_nm", wavelength);
+            daemon_json_number(w, "wavelength_nm", wavelength);
         }
     } else if (variant == SFP_VARIANT_PASSIVE_CABLE || variant == SFP_VARIANT_ACTIVE_CABLE) {
         uint8_t cable_compliance = 0;
         if (sfp_a0_get_cable_compliance(a0, &cable_compliance)) {
-            cJSON_AddNumberToObject(a0_obj, "cable_compliance", cable_compliance);
+            daemon_json_number(w, "cable_compliance", cable_compliance);
         }
     }
 
     /* Byte 62 - Fibre Channel Speed 2 */
     bool fc_speed_2_valid = sfp_get_a0_fc_speed_2(a0, &a0->dc);
-    cJSON_AddBoolToObject(a0_obj, "fc_speed_2_valid", fc_speed_2_valid);
+    daemon_json_bool(w, "fc_speed_2_valid", fc_speed_2_valid);
     if (fc_speed_2_valid) {
-        cJSON_AddNumberToObject(a0_obj, "fc_speed_2", a0->fc_speed2);
+        daemon_json_number(w, "fc_speed_2", a0->fc_speed2);
     }
 
     /* Byte 63 - CC_BASE (Checksum) */
     bool cc_base_valid = sfp_a0_get_cc_base_is_valid(a0);
-    cJSON_AddBoolToObject(a0_obj, "cc_base_valid", cc_base_valid);
-    cJSON_AddNumberToObject(a0_obj, "cc_base", a0->cc_base);
+    daemon_json_bool(w, "cc_base_valid", cc_base_valid);
+    daemon_json_number(w, "cc_base", a0->cc_base);
 }
 
 /* Helper para serializar extended fields (Byte 92) */
-static void serialize_a0h_extended(cJSON *a0_obj, const sfp_a0h_extended_t *a0_ext)
+static void serialize_a0h_extended(daemon_json_t *w, const sfp_a0h_extended_t *a0_ext)
 {
-    if (!a0_obj || !a0_ext) return;
+    if (!w || !a0_ext) return;
 
     /* Byte 92 - DDM Implemented */
     bool dmi = sfp_a0_get_dmi(a0_ext);
-    cJSON_AddBoolToObject(a0_obj, "dmi_implemented", dmi);
+    daemon_json_bool(w, "dmi_implemented", dmi);
 
     /* Byte 92 - Change Address Required */
     bool change_addr = sfp_a0_get_change_addr_req(a0_ext);
-    cJSON_AddBoolToObject(a0_obj, "change_addr_req", change_addr);
+    daemon_json_bool(w, "change_addr_req", change_addr);
 
     /* Byte 92 - Calibration */
     sfp_cal_type_t cal = sfp_a0_get_calibration(a0_ext);
-    cJSON_AddNumberToObject(a0_obj, "calibration", cal);
+    daemon_json_number(w, "calibration", cal);
     
     const char *cal_str = "Not Supported";
     if (cal == SFP_CAL_INTERNAL) cal_str = "Internal";
     else if (cal == SFP_CAL_EXTERNAL) cal_str = "External";
     
-    cJSON_AddStringToObject(a0_obj, "calibration_type", cal_str);
+    daemon_json_string(w, "calibration_type", cal_str);
 }
 
 /* Serializa A2h completo */
-static void serialize_a2h_complete(cJSON *a2_obj, const sfp_a2h_t *a2)
+static void serialize_a2h_fields(daemon_json_t *w, const sfp_daemon_state_data_t *state_copy, uint32_t fields)
 {
-    if (!a2_obj || !a2) return;
+    if (!w || !state_copy) return;
+    const sfp_a2h_t *a2 = &state_copy->a2_parsed;
 
     /* Temperature */
-    cJSON_AddBoolToObject(a2_obj, "temp_valid", true);
-    cJSON_AddNumberToObject(a2_obj, "temp_c", a2->temp_realtime);
+    if (fields & SFP_A2_CHANGED_TEMP) {
+        daemon_json_bool(w, "temp_valid", true);
+        daemon_json_number(w, "temp_c", a2->temp_realtime);
+    }
 
     /* Voltage */
-    cJSON_AddBoolToObject(a2_obj, "voltage_valid", true);
-    cJSON_AddNumberToObject(a2_obj, "voltage_v", a2->vcc_realtime);
+    if (fields & SFP_A2_CHANGED_VCC) {
+        daemon_json_bool(w, "voltage_valid", true);
+        daemon_json_number(w, "voltage_v", a2->vcc_realtime);
+    }
 
     /* TX Bias */
-    cJSON_AddBoolToObject(a2_obj, "tx_bias_valid", true);
-    cJSON_AddNumberToObject(a2_obj, "tx_bias_ma", a2->tx_bias_realtime);
+    if (fields & SFP_A2_CHANGED_TX_BIAS) {
+        daemon_json_bool(w, "tx_bias_valid", true);
+        daemon_json_number(w, "tx_bias_ma", a2->tx_bias_realtime);
+    }
 
     /* TX Power */
-    cJSON_AddBoolToObject(a2_obj, "tx_power_valid", true);
-    cJSON_AddNumberToObject(a2_obj, "tx_power_uw", a2->tx_power_realtime);
-    double tx_pwr_mw = a2->tx_power_realtime / 1000.0;
-    cJSON_AddNumberToObject(a2_obj, "tx_power_mw", tx_pwr_mw);
-    double tx_dbm = (a2->tx_power_realtime > 0.0)
-        ? 10.0 * log10(a2->tx_power_realtime / 1000.0)
-        : -40.0;
-    cJSON_AddNumberToObject(a2_obj, "tx_power_dbm", tx_dbm);
+    if (fields & SFP_A2_CHANGED_TX_POWER) {
+        daemon_json_bool(w, "tx_power_valid", true);
+        daemon_json_number(w, "tx_power_uw", a2->tx_power_realtime);
+        double tx_pwr_mw = a2->tx_power_realtime / 1000.0;
+        daemon_json_number(w, "tx_power_mw", tx_pwr_mw);
+        daemon_json_float(w, "tx_power_dbm", daemon_socket_tx_power_dbm(a2));
+    }
 
     /* RX Power */
-    cJSON_AddBoolToObject(a2_obj, "rx_power_valid", true);
-    float rx_uw = sfp_a2h_get_rx_power(a2);
-    float rx_dbm = sfp_a2h_get_rx_power_dbm(a2) + g_rx_power_offset_dbm;
-    cJSON_AddNumberToObject(a2_obj, "rx_power_uw", rx_uw);
-    cJSON_AddNumberToObject(a2_obj, "rx_power_mw", rx_uw / 1000.0);
-    cJSON_AddNumberToObject(a2_obj, "rx_power_dbm", rx_dbm);
+    if (fields & SFP_A2_CHANGED_RX_POWER) {
+        daemon_json_bool(w, "rx_power_valid", true);
+        float rx_uw = sfp_a2h_get_rx_power(a2);
+        float rx_dbm = state_copy->rx_power_dbm;
+        daemon_json_number(w, "rx_power_uw", rx_uw);
+        daemon_json_number(w, "rx_power_mw", rx_uw / 1000.0);
+        daemon_json_float(w, "rx_power_dbm", rx_dbm);
+    }
 
     /* Data Ready */
-    cJSON_AddBoolToObject(a2_obj, "data_ready", a2->data_ready);
+    if (fields & SFP_A2_CHANGED_DATA_READY) {
+        daemon_json_bool(w, "data_ready", a2->data_ready);
+    }
+
+    /* Status, alarmes e avisos do módulo (SFP_A2_FLAG_*) */
+    if (fields & SFP_A2_CHANGED_FLAGS) {
+        daemon_json_uint(w, "flags", a2->flags);
+    }
+
+    /* Referência e hold: o dB relativo acompanha o RX */
+    if (fields & (SFP_A2_CHANGED_RX_POWER | SFP_A2_CHANGED_MEASURE)) {
+        const daemon_measure_t *m = &state_copy->measure;
+        if (m->ref_valid) {
+            daemon_json_float(w, "rx_reference_dbm", m->ref_dbm);
+            daemon_json_float(w, "rx_rel_db", state_copy->rx_power_dbm - m->ref_dbm);
+        } else {
+            daemon_json_null(w, "rx_reference_dbm");
+            daemon_json_null(w, "rx_rel_db");
+        }
+        if (m->hold_valid) {
+            daemon_json_float(w, "rx_min_dbm", m->rx_min_dbm);
+            daemon_json_float(w, "rx_max_dbm", m->rx_max_dbm);
+        } else {
+            daemon_json_null(w, "rx_min_dbm");
+            daemon_json_null(w, "rx_max_dbm");
+        }
+        daemon_json_uint(w, "hold_since_ms", m->hold_since_ms);
+    }
+}
+
+static void serialize_a2h_complete(daemon_json_t *w, const sfp_daemon_state_data_t *state_copy)
+{
+    serialize_a2h_fields(w, state_copy, SFP_A2_CHANGED_ALL);
+}
+
+/* Objeto "a0" (valid + campos quando válido) */
+static void serialize_a0h_fields(daemon_json_t *w, const sfp_daemon_state_data_t *state_copy)
+{
+    daemon_json_bool(w, "valid", state_copy->a0_valid);
+    if (state_copy->a0_valid) {
+        serialize_a0h_complete(w, &state_copy->a0_parsed);
+        serialize_a0h_extended(w, &state_copy->a0_extended);
+    }
+}
+
+static void serialize_a0h_object(daemon_json_t *w, const sfp_daemon_state_data_t *state_copy)
+{
+    if (!state_copy->a0_valid) {
+        daemon_json_object_begin(w, "a0");
+        serialize_a0h_fields(w, state_copy);
+        daemon_json_object_end(w);
+        return;
+    }
+
+    /* O A0h só é lido na inserção (ABSENT → PRESENT, que incrementa
+     * generation_id): renderiza uma vez por módulo */
+    if (!g_a0h_cache.valid || g_a0h_cache.generation_id != state_copy->generation_id) {
+        daemon_json_t cw;
+        daemon_json_init(&cw, g_a0h_cache.json, sizeof(g_a0h_cache.json));
+        daemon_json_object_begin(&cw, NULL);
+        serialize_a0h_fields(&cw, state_copy);
+        daemon_json_object_end(&cw);
+        g_a0h_cache.len = daemon_json_finish(&cw);
+        g_a0h_cache.generation_id = state_copy->generation_id;
+        g_a0h_cache.valid = g_a0h_cache.len > 0;
+    }
+
+    if (g_a0h_cache.valid) {
+        daemon_json_raw(w, "a0", g_a0h_cache.json, g_a0h_cache.len);
+    } else {
+        daemon_json_object_begin(w, "a0");
+        serialize_a0h_fields(w, state_copy);
+        daemon_json_object_end(w);
+    }
+}
+
+/* Objeto "a2" (valid + campos quando válido) */
+static void serialize_a2h_object(daemon_json_t *w, const sfp_daemon_state_data_t *state_copy)
+{
+    daemon_json_object_begin(w, "a2");
+    daemon_json_bool(w, "valid", state_copy->a2_valid);
+    if (state_copy->a2_valid) {
+        serialize_a2h_complete(w, state_copy);
+    }
+    daemon_json_object_end(w);
+}
+
+static void serialize_timestamps(daemon_json_t *w, const sfp_daemon_state_data_t *state_copy)
+{
+    daemon_json_object_begin(w, "timestamps");
+    daemon_json_int(w, "first_detected", (int64_t)state_copy->first_detected);
+    daemon_json_int(w, "last_a0_read", (int64_t)state_copy->last_a0_read);
+    daemon_json_int(w, "last_a2_read", (int64_t)state_copy->last_a2_read);
+    daemon_json_object_end(w);
 }
 
 /* ============================================
  * Serializa Estado Completo
  * ============================================ */
-char *daemon_socket_serialize_current(const sfp_daemon_state_data_t *state)
+size_t daemon_socket_serialize_current(const sfp_daemon_state_data_t *state, char *buf, size_t cap)
 {
-    if (!state) {
-        return NULL;
+    if (!state || !buf) {
+        return 0;
     }
 
-    cJSON *json = cJSON_CreateObject();
-    cJSON *timestamps = cJSON_CreateObject();
-    cJSON *a0_obj = NULL;
-    cJSON *a2_obj = NULL;
-
     /* Obtém cópia thread-safe */
     sfp_daemon_state_data_t state_copy;
     daemon_state_get_copy((sfp_daemon_state_data_t *)state, &state_copy);
 
+    daemon_json_t w;
+    daemon_json_init(&w, buf, cap);
+    daemon_json_object_begin(&w, NULL);
+
     /* Status e estado */
     if (state_copy.state == SFP_STATE_ABSENT) {
-        cJSON_AddStringToObject(json, "status", "not_found");
-        cJSON_AddStringToObject(json, "message", "SFP not detected on I²C bus");
+        daemon_json_string(&w, "status", "not_found");
+        daemon_json_string(&w, "message", "SFP not detected on I²C bus");
     } else if (state_copy.state == SFP_STATE_ERROR) {
-        cJSON_AddStringToObject(json, "status", "error");
-        cJSON_AddStringToObject(json, "message", "I²C error or recovery in progress");
+        daemon_json_string(&w, "status", "error");
+        daemon_json_string(&w, "message", "I²C error or recovery in progress");
     } else {
-        cJSON_AddStringToObject(json, "status", "ok");
+        daemon_json_string(&w, "status", "ok");
     }
 
-    cJSON_AddStringToObject(json, "state", daemon_fsm_state_to_string(state_copy.state));
-    cJSON_AddNumberToObject(json, "generation_id", (double)state_copy.generation_id);
+    daemon_json_string(&w, "state", daemon_fsm_state_to_string(state_copy.state));
+    daemon_json_uint(&w, "generation_id", state_copy.generation_id);
+    daemon_json_uint(&w, "seq", state_copy.sample_seq);
+    serialize_timestamps(&w, &state_copy);
+    serialize_a0h_object(&w, &state_copy);
+    serialize_a2h_object(&w, &state_copy);
 
-    /* Timestamps */
-    cJSON_AddNumberToObject(timestamps, "first_detected", (double)state_copy.first_detected);
-    cJSON_AddNumberToObject(timestamps, "last_a0_read", (double)state_copy.last_a0_read);
-    cJSON_AddNumberToObject(timestamps, "last_a2_read", (double)state_copy.last_a2_read);
-    cJSON_AddItemToObject(json, "timestamps", timestamps);
+    daemon_json_object_end(&w);
+    return daemon_json_finish(&w);
+}
 
-    /* A0h */
-    if (state_copy.a0_valid) {
-        a0_obj = cJSON_CreateObject();
-        cJSON_AddBoolToObject(a0_obj, "valid", true);
-        serialize_a0h_complete(a0_obj, &state_copy.a0_parsed);
-        serialize_a0h_extended(a0_obj, &state_copy.a0_extended);
-        cJSON_AddItemToObject(json, "a0", a0_obj);
-    } else {
-        a0_obj = cJSON_CreateObject();
-        cJSON_AddBoolToObject(a0_obj, "valid", false);
-        cJSON_AddItemToObject(json, "a0", a0_obj);
+/* ============================================
+ * Serializa Apenas A0h
+ * ============================================ */
+size_t daemon_socket_serialize_static(const sfp_daemon_state_data_t *state, char *buf, size_t cap)
+{
+    if (!state || !buf) {
+        return 0;
     }
 
-    /* A2h */
-    if (state_copy.a2_valid) {
-        a2_obj = cJSON_CreateObject();
-        cJSON_AddBoolToObject(a2_obj, "valid", true);
-        serialize_a2h_complete(a2_obj, &state_copy.a2_parsed);
-        cJSON_AddItemToObject(json, "a2", a2_obj);
-    } else {
-        a2_obj = cJSON_CreateObject();
-        cJSON_AddBoolToObject(a2_obj, "valid", false);
-        cJSON_AddItemToObject(json, "a2", a2_obj);
-    }
+    /* Obtém cópia thread-safe */
+    sfp_daemon_state_data_t state_copy;
+    daemon_state_get_copy((sfp_daemon_state_data_t *)state, &state_copy);
 
-    char *json_string = cJSON_Print(json);
-    cJSON_Delete(json);
+    daemon_json_t w;
+    daemon_json_init(&w, buf, cap);
+    daemon_json_object_begin(&w, NULL);
+    daemon_json_uint(&w, "generation_id", state_copy.generation_id);
+    daemon_json_int(&w, "last_a0_read", (int64_t)state_copy.last_a0_read);
+    serialize_a0h_object(&w, &state_copy);
+    daemon_json_object_end(&w);
 
-    return json_string;
+    return daemon_json_finish(&w);
 }
 
 /* ============================================
- * Serializa Apenas A0h
+ * Serializa Apenas A2h
  * ============================================ */
-char *daemon_socket_serialize_static(const sfp_daemon_state_data_t *state)
+size_t daemon_socket_serialize_dynamic(const sfp_daemon_state_data_t *state, char *buf, size_t cap)
 {
-    if (!state) {
-        return NULL;
+    if (!state || !buf) {
+        return 0;
     }
 
-    cJSON *json = cJSON_CreateObject();
-    cJSON *a0_obj = NULL;
-
     /* Obtém cópia thread-safe */
     sfp_daemon_state_data_t state_copy;
     daemon_state_get_copy((sfp_daemon_state_data_t *)state, &state_copy);
 
-    cJSON_AddNumberToObject(json, "generation_id", (double)state_copy.generation_id);
-    cJSON_AddNumberToObject(json, "last_a0_read", (double)state_copy.last_a0_read);
+    return serialize_dynamic_body(&state_copy, buf, cap);
+}
 
-    if (state_copy.a0_valid) {
-        a0_obj = cJSON_CreateObject();
-        cJSON_AddBoolToObject(a0_obj, "valid", true);
-        serialize_a0h_complete(a0_obj, &state_copy.a0_parsed);
-        serialize_a0h_extended(a0_obj, &state_copy.a0_extended);
-        cJSON_AddItemToObject(json, "a0", a0_obj);
-    } else {
-        a0_obj = cJSON_CreateObject();
-        cJSON_AddBoolToObject(a0_obj, "valid", false);
-        cJSON_AddItemToObject(json, "a0", a0_obj);
+static size_t serialize_dynamic_body(const sfp_daemon_state_data_t *state_copy, char *buf, size_t cap)
+{
+    daemon_json_t w;
+    daemon_json_init(&w, buf, cap);
+    daemon_json_object_begin(&w, NULL);
+    daemon_json_uint(&w, "seq", state_copy->sample_seq);
+    daemon_json_int(&w, "last_a2_read", (int64_t)state_copy->last_a2_read);
+    serialize_a2h_object(&w, state_copy);
+    daemon_json_object_end(&w);
+
+    return daemon_json_finish(&w);
+}
+
+/* ============================================
+ * Serializa Evento de Amostra
+ * ============================================ */
+
+/* fields == SFP_A2_CHANGED_ALL: amostra completa; senão, delta com os campos
+ * indicados (e sem os que não mudaram) */
+static size_t serialize_sample_event(const sfp_daemon_state_data_t *state_copy, uint32_t fields, char *buf, size_t cap)
+{
+    daemon_json_t w;
+    daemon_json_init(&w, buf, cap);
+    daemon_json_object_begin(&w, NULL);
+
+    daemon_json_uint(&w, "seq", state_copy->sample_seq);
+    if (fields == SFP_A2_CHANGED_ALL) {
+        daemon_json_uint(&w, "generation_id", state_copy->generation_id);
     }
+    daemon_json_uint(&w, "timestamp_ms", state_copy->last_a2_read_ms);
+    daemon_json_int(&w, "last_a2_read", (int64_t)state_copy->last_a2_read);
 
-    char *json_string = cJSON_Print(json);
-    cJSON_Delete(json);
+    daemon_json_object_begin(&w, "a2");
+    if (fields == SFP_A2_CHANGED_ALL) {
+        daemon_json_bool(&w, "valid", state_copy->a2_valid);
+    }
+    if (state_copy->a2_valid) {
+        serialize_a2h_fields(&w, state_copy, fields);
+    }
+    daemon_json_object_end(&w);
 
-    return json_string;
+    daemon_json_object_end(&w);
+    return daemon_json_finish(&w);
 }
 
 /* ============================================
- * Serializa Apenas A2h
+ * Serializa Projeção de Campos (GET FIELDS)
  * ============================================ */
-char *daemon_socket_serialize_dynamic(const sfp_daemon_state_data_t *state)
+
+/* Cada acessor escreve um campo do snapshot; valores de A0h/A2h inválidos
+ * saem como null */
+typedef void (*field_accessor_fn)(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s);
+
+static void field_a2_number(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s, double value)
 {
-    if (!state) {
-        return NULL;
+    if (s->a2_valid) {
+        daemon_json_number(w, key, value);
+    } else {
+        daemon_json_null(w, key);
     }
+}
 
-    cJSON *json = cJSON_CreateObject();
-    cJSON *a2_obj = NULL;
+/* dBm/dB calculados em float (daemon_json_float) */
+static void field_a2_float(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s, float value)
+{
+    if (s->a2_valid) {
+        daemon_json_float(w, key, value);
+    } else {
+        daemon_json_null(w, key);
+    }
+}
 
-    /* Obtém cópia thread-safe */
-    sfp_daemon_state_data_t state_copy;
-    daemon_state_get_copy((sfp_daemon_state_data_t *)state, &state_copy);
+static void field_state(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    daemon_json_string(w, key, daemon_fsm_state_to_string(s->state));
+}
+
+static void field_generation_id(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    daemon_json_uint(w, key, s->generation_id);
+}
+
+static void field_seq(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    daemon_json_uint(w, key, s->sample_seq);
+}
+
+static void field_timestamp_ms(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    daemon_json_uint(w, key, s->last_a2_read_ms);
+}
+
+static void field_last_a2_read(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    daemon_json_int(w, key, (int64_t)s->last_a2_read);
+}
+
+static void field_temp_c(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    field_a2_number(w, key, s, s->a2_parsed.temp_realtime);
+}
+
+static void field_voltage_v(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    field_a2_number(w, key, s, s->a2_parsed.vcc_realtime);
+}
+
+static void field_tx_bias_ma(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    field_a2_number(w, key, s, s->a2_parsed.tx_bias_realtime);
+}
+
+static void field_tx_power_uw(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    field_a2_number(w, key, s, s->a2_parsed.tx_power_realtime);
+}
+
+static void field_tx_power_mw(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    field_a2_number(w, key, s, s->a2_parsed.tx_power_realtime / 1000.0);
+}
+
+static void field_tx_power_dbm(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    field_a2_float(w, key, s, daemon_socket_tx_power_dbm(&s->a2_parsed));
+}
+
+static void field_rx_power_uw(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    field_a2_number(w, key, s, sfp_a2h_get_rx_power(&s->a2_parsed));
+}
+
+static void field_rx_power_mw(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    field_a2_number(w, key, s, sfp_a2h_get_rx_power(&s->a2_parsed) / 1000.0);
+}
+
+static void field_rx_power_dbm(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    field_a2_float(w, key, s, s->rx_power_dbm);
+}
+
+static void field_rx_reference_dbm(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    if (s->measure.ref_valid) {
+        daemon_json_float(w, key, s->measure.ref_dbm);
+    } else {
+        daemon_json_null(w, key);
+    }
+}
+
+static void field_rx_rel_db(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    if (s->a2_valid && s->measure.ref_valid) {
+        daemon_json_float(w, key, s->rx_power_dbm - s->measure.ref_dbm);
+    } else {
+        daemon_json_null(w, key);
+    }
+}
 
-    cJSON_AddNumberToObject(json, "last_a2_read", (double)state_copy.last_a2_read);
+static void field_rx_min_dbm(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    if (s->measure.hold_valid) {
+        daemon_json_float(w, key, s->measure.rx_min_dbm);
+    } else {
+        daemon_json_null(w, key);
+    }
+}
 
-    if (state_copy.a2_valid) {
-        a2_obj = cJSON_CreateObject();
-        cJSON_AddBoolToObject(a2_obj, "valid", true);
-        serialize_a2h_complete(a2_obj, &state_copy.a2_parsed);
-        cJSON_AddItemToObject(json, "a2", a2_obj);
+static void field_rx_max_dbm(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    if (s->measure.hold_valid) {
+        daemon_json_float(w, key, s->measure.rx_max_dbm);
     } else {
-        a2_obj = cJSON_CreateObject();
-        cJSON_AddBoolToObject(a2_obj, "valid", false);
-        cJSON_AddItemToObject(json, "a2", a2_obj);
+        daemon_json_null(w, key);
     }
+}
 
-    char *json_string = cJSON_Print(json);
-    cJSON_Delete(json);
+static void field_data_ready(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    if (s->a2_valid) {
+        daemon_json_bool(w, key, s->a2_parsed.data_ready);
+    } else {
+        daemon_json_null(w, key);
+    }
+}
 
-    return json_string;
+static void field_flags(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    if (s->a2_valid) {
+        daemon_json_uint(w, key, s->a2_parsed.flags);
+    } else {
+        daemon_json_null(w, key);
+    }
 }
 
-/* ============================================
- * Serializa Apenas Estado
- * ============================================ */
-char *daemon_socket_serialize_state(const sfp_daemon_state_data_t *state)
+static void field_vendor_name(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
 {
-    if (!state) {
-        return NULL;
+    char vendor_name[SFP_A0_LEN_VENDOR_NAME + 1] = {0};
+    if (s->a0_valid && sfp_a0_get_vendor_name(&s->a0_parsed, vendor_name)) {
+        daemon_json_string(w, key, vendor_name);
+    } else {
+        daemon_json_null(w, key);
+    }
+}
+
+static void field_vendor_pn(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    const char *vendor_pn = NULL;
+    if (s->a0_valid && sfp_a0_get_vendor_pn(&s->a0_parsed, &vendor_pn) && vendor_pn) {
+        daemon_json_string(w, key, vendor_pn);
+    } else {
+        daemon_json_null(w, key);
+    }
+}
+
+static void field_wavelength_nm(daemon_json_t *w, const char *key, const sfp_daemon_state_data_t *s)
+{
+    uint16_t wavelength = 0;
+    if (s->a0_valid && sfp_a0_get_wavelength_nm(&s->a0_parsed, &wavelength)) {
+        daemon_json_uint(w, key, wavelength);
+    } else {
+        daemon_json_null(w, key);
     }
+}
+
+typedef struct {
+    const char *name;
+    field_accessor_fn emit;
+} field_entry_t;
+
+/* Ordenada por nome (busca binária) */
+static const field_entry_t g_field_table[] = {
+    { "data_ready",    field_data_ready },
+    { "flags",         field_flags },
+    { "generation_id", field_generation_id },
+    { "last_a2_read",  field_last_a2_read },
+    { "rx_max_dbm",    field_rx_max_dbm },
+    { "rx_min_dbm",    field_rx_min_dbm },
+    { "rx_power_dbm",  field_rx_power_dbm },
+    { "rx_power_mw",   field_rx_power_mw },
+    { "rx_power_uw",   field_rx_power_uw },
+    { "rx_reference_dbm", field_rx_reference_dbm },
+    { "rx_rel_db",     field_rx_rel_db },
+    { "seq",           field_seq },
+    { "state",         field_state },
+    { "temp_c",        field_temp_c },
+    { "timestamp_ms",  field_timestamp_ms },
+    { "tx_bias_ma",    field_tx_bias_ma },
+    { "tx_power_dbm",  field_tx_power_dbm },
+    { "tx_power_mw",   field_tx_power_mw },
+    { "tx_power_uw",   field_tx_power_uw },
+    { "vendor_name",   field_vendor_name },
+    { "vendor_pn",     field_vendor_pn },
+    { "voltage_v",     field_voltage_v },
+    { "wavelength_nm", field_wavelength_nm },
+};
+
+#define FIELD_TABLE_SIZE (sizeof(g_field_table) / sizeof(g_field_table[0]))
+
+static const field_entry_t *field_lookup(const char *name, size_t len)
+{
+    size_t lo = 0;
+    size_t hi = FIELD_TABLE_SIZE;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = strncmp(name, g_field_table[mid].name, len);
+        if (cmp == 0 && g_field_table[mid].name[len] != '\0') {
+            cmp = -1;  /* name é prefixo do nome da tabela */
+        }
+        if (cmp == 0) {
+            return &g_field_table[mid];
+        }
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return NULL;
+}
 
-    cJSON *json = cJSON_CreateObject();
-    cJSON *timestamps = cJSON_CreateObject();
+size_t daemon_socket_serialize_fields(const sfp_daemon_state_data_t *state, const char *fields, char *buf, size_t cap, bool *bad_fields)
+{
+    const field_entry_t *selected[DAEMON_FIELDS_MAX];
+    size_t count = 0;
+
+    *bad_fields = false;
+    if (!state || !fields || !buf) {
+        return 0;
+    }
+
+    /* Resolve os nomes antes de tocar no estado */
+    const char *p = fields;
+    while (*p) {
+        while (*p == ' ' || *p == ',') p++;
+        if (!*p) break;
+
+        size_t len = strcspn(p, ", ");
+        const field_entry_t *entry = field_lookup(p, len);
+        if (!entry || count == DAEMON_FIELDS_MAX) {
+            *bad_fields = true;
+            return 0;
+        }
+        selected[count++] = entry;
+        p += len;
+    }
+    if (count == 0) {
+        *bad_fields = true;
+        return 0;
+    }
 
     /* Obtém cópia thread-safe */
     sfp_daemon_state_data_t state_copy;
     daemon_state_get_copy((sfp_daemon_state_data_t *)state, &state_copy);
 
-    cJSON_AddStringToObject(json, "state", daemon_fsm_state_to_string(state_copy.state));
-    cJSON_AddNumberToObject(json, "generation_id", (double)state_copy.generation_id);
+    daemon_json_t w;
+    daemon_json_init(&w, buf, cap);
+    daemon_json_object_begin(&w, NULL);
+    for (size_t i = 0; i < count; i++) {
+        selected[i]->emit(&w, selected[i]->name, &state_copy);
+    }
+    daemon_json_object_end(&w);
+
+    return daemon_json_finish(&w);
+}
+
+/* ============================================
+ * Serializa Apenas Estado
+ * ============================================ */
+size_t daemon_socket_serialize_state(const sfp_daemon_state_data_t *state, char *buf, size_t cap)
+{
+    if (!state || !buf) {
+        return 0;
+    }
 
-    cJSON_AddNumberToObject(timestamps, "first_detected", (double)state_copy.first_detected);
-    cJSON_AddNumberToObject(timestamps, "last_a0_read", (double)state_copy.last_a0_read);
-    cJSON_AddNumberToObject(timestamps, "last_a2_read", (double)state_copy.last_a2_read);
-    cJSON_AddItemToObject(json, "timestamps", timestamps);
+    /* Obtém cópia thread-safe */
+    sfp_daemon_state_data_t state_copy;
+    daemon_state_get_copy((sfp_daemon_state_data_t *)state, &state_copy);
 
-    char *json_string = cJSON_Print(json);
-    cJSON_Delete(json);
+    daemon_json_t w;
+    daemon_json_init(&w, buf, cap);
+    daemon_json_object_begin(&w, NULL);
+    daemon_json_string(&w, "state", daemon_fsm_state_to_string(state_copy.state));
+    daemon_json_uint(&w, "generation_id", state_copy.generation_id);
+    serialize_timestamps(&w, &state_copy);
+    daemon_json_object_end(&w);
 
-    return json_string;
+    return daemon_json_finish(&w);
 }
 
 /* ============================================
  * Serializa PING
  * ============================================ */
-char *daemon_socket_serialize_ping(time_t uptime_seconds)
+size_t daemon_socket_serialize_ping(time_t uptime_seconds, char *buf, size_t cap)
 {
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddStringToObject(json, "status", "ok");
-    cJSON_AddNumberToObject(json, "uptime", (double)uptime_seconds);
+    if (!buf) {
+        return 0;
+    }
 
-    char *json_string = cJSON_Print(json);
-    cJSON_Delete(json);
+    daemon_json_t w;
+    daemon_json_init(&w, buf, cap);
+    daemon_json_object_begin(&w, NULL);
+    daemon_json_string(&w, "status", "ok");
+    daemon_json_int(&w, "uptime", (int64_t)uptime_seconds);
+    daemon_json_object_end(&w);
 
-    return json_string;
+    return daemon_json_finish(&w);
 }
@@ -7,17 +7,53 @@
 #define DAEMON_SOCKET_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "daemon_state.h"
 #include "daemon_config.h"
+#include "daemon_outq.h"
 
 /* ============================================
  * Estrutura do Servidor Socket
  * ============================================ */
+/* Formato das respostas, negociado por conexão com FORMAT JSON|BINARY */
+typedef enum {
+    DAEMON_FORMAT_JSON,
+    DAEMON_FORMAT_BINARY    /* Frames de sfp_wire.h */
+} daemon_socket_format_t;
+
+typedef struct {
+    int fd;                                      /* -1 quando o slot está livre */
+    char rx_buf[DAEMON_CLIENT_RX_BUFFER_SIZE];   /* Bytes recebidos ainda sem '\n' */
+    size_t rx_len;
+    bool rx_discarding;                          /* Descartando linha longa demais até o próximo '\n' */
+    bool rx_closed;                              /* Cliente enviou EOF; fecha após esvaziar a fila */
+    daemon_outq_t tx;                            /* Respostas ainda não enviadas */
+    uint32_t events;                             /* Eventos epoll registrados */
+    bool evict;                                  /* Fila estourou: fechar na próxima oportunidade */
+    daemon_socket_format_t format;
+    bool length_framing;                         /* FRAMING LENGTH: tamanho do corpo no fim do cabeçalho */
+
+    /* SUBSCRIBE DYNAMIC: amostras empurradas pelo daemon */
+    bool subscribed;
+    uint32_t decimation;                         /* Envia 1 a cada N amostras */
+    uint32_t decimation_count;
+    bool delta;                                  /* Frames só com os campos que mudaram */
+    uint32_t pending_changed;                    /* SFP_A2_CHANGED_* ainda não entregues ao cliente */
+} daemon_socket_client_t;
+
 typedef struct {
     int server_fd;
-    int client_fds[DAEMON_MAX_CONNECTIONS];
+    int epoll_fd;
+    bool listen_armed;                           /* server_fd com EPOLLIN no epoll (false com a tabela cheia) */
+    daemon_socket_client_t clients[DAEMON_MAX_CONNECTIONS];
     int num_clients;
     char socket_path[256];
+
+    /* Último estado empurrado para assinantes */
+    uint64_t published_seq;
+    sfp_daemon_state_t published_state;
+    uint64_t published_generation_id;
+    uint64_t published_alarm_seq;                /* Último EVENT ALARM (daemon_alarm.h) */
 } daemon_socket_server_t;
 
 /* ============================================
@@ -46,16 +82,27 @@ void daemon_socket_cleanup(daemon_socket_server_t *server);
 bool daemon_socket_accept(daemon_socket_server_t *server);
 
 /**
- * @brief Processa comandos pendentes de clientes conectados
+ * @brief Aguarda eventos do socket por até timeout_ms, atendendo conexões,
+ *        comandos e envios pendentes (EPOLLOUT) durante a espera
  * @param server Ponteiro para estrutura do servidor
  * @param state Ponteiro para estado global
  * @param daemon_uptime Uptime do daemon em segundos
+ * @param timeout_ms Tempo máximo de espera (ms)
  * @return Número de comandos processados
  */
-int daemon_socket_process_commands(daemon_socket_server_t *server, sfp_daemon_state_data_t *state, time_t daemon_uptime);
+int daemon_socket_poll(daemon_socket_server_t *server, sfp_daemon_state_data_t *state, time_t daemon_uptime, uint32_t timeout_ms);
 
 /**
- * @brief Fecha conexões inativas
+ * @brief Envia aos assinantes (SUBSCRIBE DYNAMIC) as amostras A2h publicadas
+ *        e as transições da FSM ocorridas desde a última chamada
+ * @param server Ponteiro para estrutura do servidor
+ * @param state Ponteiro para estado global
+ */
+void daemon_socket_publish(daemon_socket_server_t *server, sfp_daemon_state_data_t *state);
+
+/**
+ * @brief Fecha conexões cuja fila de saída não anda há mais de
+ *        DAEMON_CLIENT_STALL_TIMEOUT_MS ou que estouraram o limite da fila
  * @param server Ponteiro para estrutura do servidor
  */
 void daemon_socket_close_inactive(daemon_socket_server_t *server);
@@ -67,37 +114,59 @@ void daemon_socket_close_inactive(daemon_socket_server_t *server);
 /**
  * @brief Serializa estado completo para JSON
  * @param state Ponteiro para estado
- * @return String JSON (deve ser liberada pelo caller usando free())
+ * @param buf Buffer de saída (JSON compacto, sem '\0')
+ * @param cap Capacidade do buffer
+ * @return Bytes escritos, ou 0 se não coube
  */
-char *daemon_socket_serialize_current(const sfp_daemon_state_data_t *state);
+size_t daemon_socket_serialize_current(const sfp_daemon_state_data_t *state, char *buf, size_t cap);
 
 /**
  * @brief Serializa apenas dados A0h para JSON
  * @param state Ponteiro para estado
- * @return String JSON (deve ser liberada pelo caller usando free())
+ * @param buf Buffer de saída (JSON compacto, sem '\0')
+ * @param cap Capacidade do buffer
+ * @return Bytes escritos, ou 0 se não coube
  */
-char *daemon_socket_serialize_static(const sfp_daemon_state_data_t *state);
+size_t daemon_socket_serialize_static(const sfp_daemon_state_data_t *state, char *buf, size_t cap);
 
 /**
  * @brief Serializa apenas dados A2h para JSON
  * @param state Ponteiro para estado
- * @return String JSON (deve ser liberada pelo caller usando free())
+ * @param buf Buffer de saída (JSON compacto, sem '\0')
+ * @param cap Capacidade do buffer
+ * @return Bytes escritos, ou 0 se não coube
  */
-char *daemon_socket_serialize_dynamic(const sfp_daemon_state_data_t *state);
+size_t daemon_socket_serialize_dynamic(const sfp_daemon_state_data_t *state, char *buf, size_t cap);
 
 /**
  * @brief Serializa apenas estado da FSM para JSON
  * @param state Ponteiro para estado
- * @return String JSON (deve ser liberada pelo caller usando free())
+ * @param buf Buffer de saída (JSON compacto, sem '\0')
+ * @param cap Capacidade do buffer
+ * @return Bytes escritos, ou 0 se não coube
+ */
+size_t daemon_socket_serialize_state(const sfp_daemon_state_data_t *state, char *buf, size_t cap);
+
+/**
+ * @brief Serializa só os campos pedidos do snapshot (GET FIELDS)
+ * @param state Ponteiro para estado
+ * @param fields Nomes separados por vírgula (ex.: "rx_power_dbm,temp_c")
+ * @param buf Buffer de saída (JSON compacto, sem '\0')
+ * @param cap Capacidade do buffer
+ * @param bad_fields Recebe true se a lista está vazia, tem nome
+ *                   desconhecido ou mais de DAEMON_FIELDS_MAX nomes
+ * @return Bytes escritos, ou 0 se não coube ou a lista é inválida
  */
-char *daemon_socket_serialize_state(const sfp_daemon_state_data_t *state);
+size_t daemon_socket_serialize_fields(const sfp_daemon_state_data_t *state, const char *fields, char *buf, size_t cap, bool *bad_fields);
 
 /**
  * @brief Serializa resposta PING para JSON
  * @param uptime_seconds Uptime do daemon em segundos
- * @return String JSON (deve ser liberada pelo caller usando free())
+ * @param buf Buffer de saída (JSON compacto, sem '\0')
+ * @param cap Capacidade do buffer
+ * @return Bytes escritos, ou 0 se não coube
  */
-char *daemon_socket_serialize_ping(time_t uptime_seconds);
+size_t daemon_socket_serialize_ping(time_t uptime_seconds, char *buf, size_t cap);
 
 #endif /* DAEMON_SOCKET_H */
 
@@ -3,7 +3,13 @@
  * @brief Implementação das funções de gerenciamento de estado
  */
 
+#define _DEFAULT_SOURCE
 #include "daemon_state.h"
+#include "daemon_stats.h"
+#include "daemon_alarm.h"
+#include "daemon_trend.h"
+#include "../sfp_dbm.h"
+#include "../sfp_probes.h"
 #include <string.h>
 #include <syslog.h>
 
@@ -25,6 +31,8 @@ bool daemon_state_init(sfp_daemon_state_data_t *state)
     state->a2_valid = false;
     state->i2c_error_count = 0;
     state->recovery_attempts = 0;
+    state->a2_cal_generation = UINT64_MAX;  /* Nenhuma calibração decodificada */
+    state->measure_generation = UINT64_MAX;
     
     /* Inicializa mutex */
     if (pthread_mutex_init(&state->mutex, NULL) != 0) {
@@ -62,6 +70,197 @@ void daemon_state_get_copy(sfp_daemon_state_data_t *state, sfp_daemon_state_data
     pthread_mutex_unlock(&state->mutex);
 }
 
+/* ============================================
+ * Publica A0h
+ * ============================================ */
+void daemon_state_publish_a0h(sfp_daemon_state_data_t *state, const uint8_t *a0_raw, time_t now)
+{
+    if (!state || !a0_raw) {
+        return;
+    }
+
+    pthread_mutex_lock(&state->mutex);
+
+    memcpy(state->a0_raw, a0_raw, SFP_A0_SIZE);
+    uint32_t new_hash = daemon_state_calculate_a0_hash(a0_raw, SFP_A0_SIZE);
+
+    /* Parse A0h */
+    sfp_parse_a0_base_identifier(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_ext_identifier(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_connector(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_compliance(state->a0_raw, &state->a0_parsed.cc);
+    sfp_parse_a0_base_encoding(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_nominal_rate(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_rate_identifier(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_smf_km(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_smf_m(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_om2(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_om1(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_om4_or_copper(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_om3_or_cable(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_vendor_name(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_ext_compliance(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_vendor_oui(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_vendor_pn(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_vendor_rev(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_media(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_fc_speed_2(state->a0_raw, &state->a0_parsed);
+    sfp_parse_a0_base_cc_base(state->a0_raw, &state->a0_parsed);
+    sfp_a0_decode_compliance(&state->a0_parsed.cc, &state->a0_parsed.dc);
+
+    /* Calibração de RX: wavelength e PN só mudam com o módulo */
+    state->rx_cal = daemon_rxcal_select(&state->a0_parsed);
+    state->rx_temp_comp = daemon_rxcal_select_temp_comp(&state->a0_parsed);
+
+    /* Parse Extended A0h (Byte 92 etc) */
+    sfp_parse_a0_extended_dmi(state->a0_raw, &state->a0_extended);
+    sfp_parse_a0_extended_change_addr_req(state->a0_raw, &state->a0_extended);
+    sfp_parse_a0_extended_calibration(state->a0_raw, &state->a0_extended);
+
+    state->a0_valid = true;
+    state->a0_hash = new_hash;
+    state->last_a0_read = now;
+
+    pthread_mutex_unlock(&state->mutex);
+}
+
+/* ============================================
+ * Publica Amostra A2h
+ * ============================================ */
+uint64_t daemon_state_publish_a2h(sfp_daemon_state_data_t *state, const uint8_t *a2_raw, time_t now)
+{
+    if (!state || !a2_raw) {
+        return 0;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t now_ms = (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+
+    pthread_mutex_lock(&state->mutex);
+
+    /* Compara registradores brutos: primeira amostra do módulo vai completa */
+    uint32_t changed = SFP_A2_CHANGED_ALL;
+    if (state->a2_valid) {
+        changed = 0;
+        if (memcmp(&state->a2_raw[A2_TEMP_CURR], &a2_raw[A2_TEMP_CURR], 2) != 0)
+            changed |= SFP_A2_CHANGED_TEMP;
+        if (memcmp(&state->a2_raw[A2_VCC_CURR], &a2_raw[A2_VCC_CURR], 2) != 0)
+            changed |= SFP_A2_CHANGED_VCC;
+        if (memcmp(&state->a2_raw[A2_TX_BIAS_CURR], &a2_raw[A2_TX_BIAS_CURR], 2) != 0)
+            changed |= SFP_A2_CHANGED_TX_BIAS;
+        if (memcmp(&state->a2_raw[A2_TX_POWER_CURR], &a2_raw[A2_TX_POWER_CURR], 2) != 0)
+            changed |= SFP_A2_CHANGED_TX_POWER;
+        if (memcmp(&state->a2_raw[A2_RX_POWER], &a2_raw[A2_RX_POWER], 2) != 0)
+            changed |= SFP_A2_CHANGED_RX_POWER;
+        if ((state->a2_raw[STATUS_CONTROL] ^ a2_raw[STATUS_CONTROL]) & (1 << SFP_A2_BIT_DATA_NOT_READY))
+            changed |= SFP_A2_CHANGED_DATA_READY;
+    }
+
+    memcpy(state->a2_raw, a2_raw, SFP_A2_SIZE);
+    uint32_t prev_flags = state->a2_parsed.flags;
+
+    /* Constantes de calibração e limiares: uma vez por módulo, as amostras
+     * seguintes só aplicam slope/offset e o polinômio já reduzido */
+    bool new_thresholds = false;
+    if (state->a2_cal_generation != state->generation_id) {
+        bool external = state->a0_valid
+            && sfp_a0_get_calibration(&state->a0_extended) == SFP_CAL_EXTERNAL;
+        sfp_parse_a2h_calibration(state->a2_raw, external, &state->a2_cal);
+        sfp_parse_a2h_thresholds(state->a2_raw, &state->a2_cal, &state->a2_parsed.thresholds);
+        state->a2_cal_generation = state->generation_id;
+        new_thresholds = true;
+        if (external) {
+            syslog(LOG_INFO, "External calibration loaded (generation %llu, Rx_PWR degree %u)",
+                   (unsigned long long)state->generation_id, state->a2_cal.rx_pwr_degree);
+        }
+    }
+
+    /* Parse tempo real A2h: temp, vcc, tx_bias, tx_power, rx_power */
+    sfp_parse_a2h_realtime(state->a2_raw, &state->a2_cal, &state->a2_parsed);
+    sfp_parse_a2h_data_ready(state->a2_raw, &state->a2_parsed);
+    sfp_parse_a2h_flags(state->a2_raw, &state->a2_parsed);
+    if (state->a2_valid && state->a2_parsed.flags != prev_flags) {
+        changed |= SFP_A2_CHANGED_FLAGS;
+    }
+    /* RX: temperatura da mesma amostra primeiro, depois a tabela rx_cal */
+    float prev_rx_dbm = state->rx_power_dbm;
+    float rx_dbm = daemon_rxcal_temp_comp_apply(state->rx_temp_comp, sfp_a2h_get_rx_power_dbm(&state->a2_parsed),
+                                                (float)state->a2_parsed.temp_realtime);
+    state->rx_power_dbm = daemon_rxcal_apply(state->rx_cal, rx_dbm);
+    /* Com compensação o valor publicado anda com a temperatura mesmo com os
+     * bytes de RX parados: o delta compara o que sai, não só o registrador */
+    if (state->a2_valid && state->rx_power_dbm != prev_rx_dbm) {
+        changed |= SFP_A2_CHANGED_RX_POWER;
+    }
+
+    /* Referência e hold só com dados válidos */
+    const sfp_a2h_t *a2 = &state->a2_parsed;
+    if (state->measure_generation != state->generation_id) {
+        daemon_measure_new_module(&state->measure, now_ms);
+        state->measure_generation = state->generation_id;
+    }
+    if (a2->data_ready && daemon_measure_add(&state->measure, state->rx_power_dbm)) {
+        changed |= SFP_A2_CHANGED_MEASURE;
+    }
+    /* Comando entre duas leituras: o delta pode não ter saído antes desta */
+    if (state->measure_pending) {
+        changed |= SFP_A2_CHANGED_MEASURE;
+        state->measure_pending = false;
+    }
+
+    /* Valores para as janelas de estatística e os alarmes (idem) */
+    bool sample_ready = a2->data_ready;
+    float stats_values[DAEMON_STATS_CH_COUNT] = {
+        [DAEMON_STATS_CH_TEMP_C] = (float)a2->temp_realtime,
+        [DAEMON_STATS_CH_VOLTAGE_V] = (float)a2->vcc_realtime,
+        [DAEMON_STATS_CH_TX_BIAS_MA] = (float)a2->tx_bias_realtime,
+        [DAEMON_STATS_CH_TX_POWER_UW] = (float)a2->tx_power_realtime,
+        [DAEMON_STATS_CH_TX_POWER_DBM] = sfp_dbm_from_uw(a2->tx_power_realtime),
+        [DAEMON_STATS_CH_RX_POWER_UW] = (float)a2->rx_power_realtime,
+        [DAEMON_STATS_CH_RX_POWER_DBM] = state->rx_power_dbm,
+    };
+    float alarm_values[DAEMON_ALARM_CH_COUNT] = {
+        [DAEMON_ALARM_CH_TEMP_C] = stats_values[DAEMON_STATS_CH_TEMP_C],
+        [DAEMON_ALARM_CH_VOLTAGE_V] = stats_values[DAEMON_STATS_CH_VOLTAGE_V],
+        [DAEMON_ALARM_CH_TX_BIAS_MA] = stats_values[DAEMON_STATS_CH_TX_BIAS_MA],
+        [DAEMON_ALARM_CH_TX_POWER_DBM] = stats_values[DAEMON_STATS_CH_TX_POWER_DBM],
+        [DAEMON_ALARM_CH_RX_POWER_DBM] = state->rx_power_dbm,
+    };
+    /* Limiares do módulo comparam com o RX sem rx_cal */
+    float alarm_module_values[DAEMON_ALARM_CH_COUNT];
+    memcpy(alarm_module_values, alarm_values, sizeof(alarm_values));
+    alarm_module_values[DAEMON_ALARM_CH_RX_POWER_DBM] = sfp_a2h_get_rx_power_dbm(a2);
+
+    sfp_a2h_thresholds_t thresholds = a2->thresholds;
+    bool dmi = state->a0_valid && sfp_a0_get_dmi(&state->a0_extended);
+    uint64_t generation_id = state->generation_id;
+
+    state->a2_valid = true;
+    state->last_a2_read = now;
+    state->last_a2_read_ms = now_ms;
+    state->a2_changed = changed;
+    state->i2c_error_count = 0;
+    uint64_t seq = ++state->sample_seq;
+
+    pthread_mutex_unlock(&state->mutex);
+
+    /* Fora do mutex do estado: daemon_stats, daemon_alarm e daemon_trend têm o seu */
+    if (new_thresholds) {
+        daemon_alarm_set_module(generation_id, now_ms, dmi ? &thresholds : NULL);
+    }
+    if (sample_ready) {
+        daemon_stats_add(generation_id, now_ms, stats_values);
+        daemon_alarm_evaluate(generation_id, now_ms, alarm_module_values, alarm_values);
+        daemon_trend_add(generation_id, now_ms, alarm_module_values);
+    }
+
+    /* USDT sfp:sample__publish(seq, máscara SFP_A2_CHANGED_*) */
+    SFP_PROBE2(sample__publish, seq, changed);
+
+    return seq;
+}
+
 /* ============================================
  * Calcula Hash do A0h
  * ============================================ */
@@ -96,3 +295,77 @@ bool daemon_state_sfp_changed(sfp_daemon_state_data_t *state, uint32_t new_hash)
     return changed;
 }
 
+/* ============================================
+ * Referência e Hold (comandos do socket)
+ * ============================================ */
+static uint64_t daemon_state_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+/* Nova versão da amostra só com os campos de medida (chamar com o mutex) */
+static void daemon_state_measure_changed(sfp_daemon_state_data_t *state)
+{
+    if (!state->a2_valid) {
+        return;
+    }
+    state->a2_changed = SFP_A2_CHANGED_MEASURE;
+    state->measure_pending = true;
+    state->sample_seq++;
+}
+
+uint32_t daemon_state_set_reference(sfp_daemon_state_data_t *state, const float *ref_dbm, float *out_ref)
+{
+    if (!state) {
+        return 0;
+    }
+
+    uint64_t now_ms = daemon_state_now_ms();
+    uint32_t samples = 1;
+
+    pthread_mutex_lock(&state->mutex);
+    if (ref_dbm) {
+        daemon_measure_set_reference_value(&state->measure, *ref_dbm, now_ms);
+    } else {
+        samples = daemon_measure_set_reference(&state->measure, now_ms);
+    }
+    if (samples > 0) {
+        daemon_state_measure_changed(state);
+    }
+    float ref = state->measure.ref_dbm;
+    pthread_mutex_unlock(&state->mutex);
+
+    if (out_ref) {
+        *out_ref = ref;
+    }
+    if (samples > 0) {
+        syslog(LOG_INFO, "RX reference set: %.2f dBm (%u samples)", ref, samples);
+    }
+    return samples;
+}
+
+void daemon_state_clear_reference(sfp_daemon_state_data_t *state)
+{
+    if (!state) {
+        return;
+    }
+    pthread_mutex_lock(&state->mutex);
+    daemon_measure_clear_reference(&state->measure);
+    daemon_state_measure_changed(state);
+    pthread_mutex_unlock(&state->mutex);
+}
+
+void daemon_state_reset_hold(sfp_daemon_state_data_t *state)
+{
+    if (!state) {
+        return;
+    }
+    uint64_t now_ms = daemon_state_now_ms();
+    pthread_mutex_lock(&state->mutex);
+    daemon_measure_reset_hold(&state->measure, now_ms);
+    daemon_state_measure_changed(state);
+    pthread_mutex_unlock(&state->mutex);
+}
+
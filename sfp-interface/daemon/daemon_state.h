@@ -13,6 +13,8 @@
 #include "../defs.h"
 #include "../a0h.h"
 #include "../a2h.h"
+#include "daemon_rxcal.h"
+#include "daemon_measure.h"
 
 /* ============================================
  * Estados da Máquina de Estados
@@ -24,6 +26,20 @@ typedef enum {
     SFP_STATE_ERROR      /* Erro temporário (tentando recuperar) */
 } sfp_daemon_state_t;
 
+/* ============================================
+ * Campos A2h Rastreados (push delta)
+ * ============================================ */
+/* Bit ligado = o registrador mudou em relação à amostra anterior */
+#define SFP_A2_CHANGED_TEMP        (1u << 0)
+#define SFP_A2_CHANGED_VCC         (1u << 1)
+#define SFP_A2_CHANGED_TX_BIAS     (1u << 2)
+#define SFP_A2_CHANGED_TX_POWER    (1u << 3)
+#define SFP_A2_CHANGED_RX_POWER    (1u << 4)
+#define SFP_A2_CHANGED_DATA_READY  (1u << 5)
+#define SFP_A2_CHANGED_MEASURE     (1u << 6)  /* Referência ou hold (daemon_measure.h) */
+#define SFP_A2_CHANGED_FLAGS       (1u << 7)  /* Status/alarmes/avisos (SFP_A2_FLAG_*) */
+#define SFP_A2_CHANGED_ALL         0xFFu
+
 /* ============================================
  * Estrutura de Estado Global
  * ============================================ */
@@ -53,6 +69,28 @@ typedef struct {
     uint8_t a2_raw[SFP_A2_SIZE];
     sfp_a2h_t a2_parsed;
 
+    /* Constantes de calibração do módulo atual (decodificadas na primeira
+     * amostra de cada generation_id) */
+    sfp_a2h_cal_t a2_cal;
+    uint64_t a2_cal_generation;
+
+    /* Tabela de calibração de RX e modelo de temperatura escolhidos na
+     * publicação do A0h (tabela NULL = só o offset fixo) e a potência RX da
+     * última amostra já corrigida */
+    const daemon_rxcal_table_t *rx_cal;
+    const daemon_rxcal_temp_comp_t *rx_temp_comp;   /* NULL = sem compensação */
+    float rx_power_dbm;
+
+    /* Referência de RX e min/max hold (recomeçam por generation_id) */
+    daemon_measure_t measure;
+    uint64_t measure_generation;
+    bool measure_pending;      /* Comando mudou referência/hold: próxima amostra leva SFP_A2_CHANGED_MEASURE */
+
+    /* Sequência da amostra A2h: incrementada a cada publicação, nunca volta */
+    uint64_t sample_seq;
+    uint64_t last_a2_read_ms;  /* Horário da última amostra (epoch, ms) */
+    uint32_t a2_changed;       /* SFP_A2_CHANGED_* da última amostra */
+
     /* Contadores de erro */
     uint32_t i2c_error_count;      /* Contador de erros I²C consecutivos */
     uint32_t recovery_attempts;     /* Tentativas de recuperação */
@@ -86,6 +124,26 @@ void daemon_state_cleanup(sfp_daemon_state_data_t *state);
  */
 void daemon_state_get_copy(sfp_daemon_state_data_t *state, sfp_daemon_state_data_t *out);
 
+/**
+ * @brief Publica o A0h lido na inserção: faz o parse completo (base e
+ *        estendido), calcula o hash e marca A0h como válido
+ * @param state Ponteiro para estrutura de estado
+ * @param a0_raw Dados brutos do A0h (SFP_A0_SIZE bytes)
+ * @param now Horário da leitura
+ */
+void daemon_state_publish_a0h(sfp_daemon_state_data_t *state, const uint8_t *a0_raw, time_t now);
+
+/**
+ * @brief Publica uma nova amostra A2h: faz o parse dos valores em tempo real
+ *        (com a calibração externa do módulo, se houver), registra os campos que mudaram (a2_changed), marca A2h como válido
+ *        e incrementa sample_seq
+ * @param state Ponteiro para estrutura de estado
+ * @param a2_raw Dados brutos do A2h (SFP_A2_SIZE bytes)
+ * @param now Horário da leitura
+ * @return Sequência atribuída à amostra
+ */
+uint64_t daemon_state_publish_a2h(sfp_daemon_state_data_t *state, const uint8_t *a2_raw, time_t now);
+
 /**
  * @brief Calcula hash simples do A0h para detecção de mudança
  * @param a0_raw Dados brutos do A0h
@@ -102,4 +160,29 @@ uint32_t daemon_state_calculate_a0_hash(const uint8_t *a0_raw, size_t size);
  */
 bool daemon_state_sfp_changed(sfp_daemon_state_data_t *state, uint32_t new_hash);
 
+/*
+ * SET REFERENCE, CLEAR REFERENCE e RESET HOLD mudam campos do objeto a2 sem
+ * leitura nova: com amostra válida incrementam sample_seq (a2_changed =
+ * SFP_A2_CHANGED_MEASURE) para invalidar o cache do GET DYNAMIC, responder
+ * IF-NEWER e empurrar o delta aos assinantes.
+ */
+
+/**
+ * @brief SET REFERENCE: referência de RX com valor explícito ou, com
+ *        ref_dbm NULL, pela média das últimas amostras
+ * @param out_ref Recebe a referência em vigor (pode ser NULL)
+ * @return Amostras usadas na média (1 para valor explícito; 0 = sem amostras)
+ */
+uint32_t daemon_state_set_reference(sfp_daemon_state_data_t *state, const float *ref_dbm, float *out_ref);
+
+/**
+ * @brief CLEAR REFERENCE
+ */
+void daemon_state_clear_reference(sfp_daemon_state_data_t *state);
+
+/**
+ * @brief RESET HOLD
+ */
+void daemon_state_reset_hold(sfp_daemon_state_data_t *state);
+
 #endif /* DAEMON_STATE_H */
@@ -0,0 +1,519 @@
+/**
+ * @file daemon_stats.c
+ * @brief Implementação das estatísticas por janela (Welford + P²)
+ */
+
+#define _DEFAULT_SOURCE
+#include "daemon_stats.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================
+ * Momentos (Welford) — fundíveis entre painéis
+ * ============================================ */
+typedef struct {
+    uint64_t n;
+    double mean;
+    double m2;        /* Soma dos quadrados dos desvios */
+    double min;
+    double max;
+} moments_t;
+
+static void moments_add(moments_t *m, double x)
+{
+    m->n++;
+    double delta = x - m->mean;
+    m->mean += delta / (double)m->n;
+    m->m2 += delta * (x - m->mean);
+    if (m->n == 1 || x < m->min) m->min = x;
+    if (m->n == 1 || x > m->max) m->max = x;
+}
+
+/* Chan et al.: combina dois acumuladores sem perder precisão */
+static void moments_merge(moments_t *into, const moments_t *m)
+{
+    if (m->n == 0) {
+        return;
+    }
+    if (into->n == 0) {
+        *into = *m;
+        return;
+    }
+    uint64_t n = into->n + m->n;
+    double delta = m->mean - into->mean;
+    into->mean += delta * (double)m->n / (double)n;
+    into->m2 += m->m2 + delta * delta * (double)into->n * (double)m->n / (double)n;
+    if (m->min < into->min) into->min = m->min;
+    if (m->max > into->max) into->max = m->max;
+    into->n = n;
+}
+
+/* ============================================
+ * Estimador P² de um quantil
+ * ============================================ */
+#define P2_MARKERS 5
+
+typedef struct {
+    uint64_t count;
+    double q[P2_MARKERS];    /* Alturas dos marcadores */
+    double pos[P2_MARKERS];  /* Posições atuais (1..count) */
+    double want[P2_MARKERS]; /* Posições desejadas */
+} p2_t;
+
+static const double k_quantiles[3] = { 0.01, 0.50, 0.99 };
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void p2_add(p2_t *e, double p, double x)
+{
+    /* As cinco primeiras observações viram os marcadores iniciais */
+    if (e->count < P2_MARKERS) {
+        e->q[e->count++] = x;
+        if (e->count == P2_MARKERS) {
+            qsort(e->q, P2_MARKERS, sizeof(double), compare_double);
+            for (int i = 0; i < P2_MARKERS; i++) {
+                e->pos[i] = i + 1;
+            }
+            e->want[0] = 1.0;
+            e->want[1] = 1.0 + 2.0 * p;
+            e->want[2] = 1.0 + 4.0 * p;
+            e->want[3] = 3.0 + 2.0 * p;
+            e->want[4] = 5.0;
+        }
+        return;
+    }
+
+    /* Célula k que contém x; os extremos acompanham min/max */
+    int k;
+    if (x < e->q[0]) {
+        e->q[0] = x;
+        k = 0;
+    } else if (x >= e->q[4]) {
+        e->q[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && x >= e->q[k + 1]) {
+            k++;
+        }
+    }
+
+    for (int i = k + 1; i < P2_MARKERS; i++) {
+        e->pos[i] += 1.0;
+    }
+    e->want[1] += p / 2.0;
+    e->want[2] += p;
+    e->want[3] += (1.0 + p) / 2.0;
+    e->want[4] += 1.0;
+    e->count++;
+
+    /* Ajusta os marcadores internos (parabólico, ou linear se sair do intervalo) */
+    for (int i = 1; i <= 3; i++) {
+        double d = e->want[i] - e->pos[i];
+        if ((d >= 1.0 && e->pos[i + 1] - e->pos[i] > 1.0) ||
+            (d <= -1.0 && e->pos[i - 1] - e->pos[i] < -1.0)) {
+            double s = d >= 0.0 ? 1.0 : -1.0;
+            double q = e->q[i] + s / (e->pos[i + 1] - e->pos[i - 1]) *
+                ((e->pos[i] - e->pos[i - 1] + s) * (e->q[i + 1] - e->q[i]) / (e->pos[i + 1] - e->pos[i]) +
+                 (e->pos[i + 1] - e->pos[i] - s) * (e->q[i] - e->q[i - 1]) / (e->pos[i] - e->pos[i - 1]));
+            if (e->q[i - 1] < q && q < e->q[i + 1]) {
+                e->q[i] = q;
+            } else {
+                int j = i + (int)s;
+                e->q[i] += s * (e->q[j] - e->q[i]) / (e->pos[j] - e->pos[i]);
+            }
+            e->pos[i] += s;
+        }
+    }
+}
+
+static double p2_value(const p2_t *e, double p)
+{
+    if (e->count >= P2_MARKERS) {
+        return e->q[2];
+    }
+    if (e->count == 0) {
+        return 0.0;
+    }
+
+    /* Poucas amostras: quantil exato por posto mais próximo */
+    double sorted[P2_MARKERS];
+    memcpy(sorted, e->q, (size_t)e->count * sizeof(double));
+    qsort(sorted, (size_t)e->count, sizeof(double), compare_double);
+    size_t rank = (size_t)ceil(p * (double)e->count);
+    return sorted[rank ? rank - 1 : 0];
+}
+
+/* p1, p50 e p99 de um canal */
+typedef struct {
+    p2_t q[3];
+} quantiles_t;
+
+static void quantiles_add(quantiles_t *qs, double x)
+{
+    for (int i = 0; i < 3; i++) {
+        p2_add(&qs->q[i], k_quantiles[i], x);
+    }
+}
+
+/* ============================================
+ * Janelas
+ * ============================================ */
+
+/* Conjunto de estimadores P² reiniciado a cada época */
+typedef struct {
+    int64_t epoch;
+    quantiles_t ch[DAEMON_STATS_CH_COUNT];
+} quantile_set_t;
+
+typedef struct {
+    daemon_stats_window_cfg_t cfg;
+    uint64_t window_ms;
+    uint64_t since_ms;        /* Primeira amostra desde o último reset (0 = nenhuma) */
+
+    /* Deslizante: painéis de window_ms / PANES e dois conjuntos P² defasados */
+    uint64_t pane_ms;
+    int64_t pane_idx[DAEMON_STATS_PANES];
+    moments_t panes[DAEMON_STATS_PANES][DAEMON_STATS_CH_COUNT];
+    quantile_set_t sets[2];
+
+    /* Tumbling: janela corrente e a última fechada */
+    uint64_t cur_start_ms;
+    uint64_t cur_last_ms;
+    moments_t cur[DAEMON_STATS_CH_COUNT];
+    quantiles_t cur_q[DAEMON_STATS_CH_COUNT];
+    bool have_done;
+    daemon_stats_result_t done;
+} window_t;
+
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static window_t g_windows[DAEMON_STATS_MAX_WINDOWS];
+static size_t g_window_count = 0;
+static uint64_t g_generation_id = 0;
+
+static const char *const k_channel_names[DAEMON_STATS_CH_COUNT] = {
+    "temp_c",
+    "voltage_v",
+    "tx_bias_ma",
+    "tx_power_uw",
+    "tx_power_dbm",
+    "rx_power_uw",
+    "rx_power_dbm",
+};
+
+const char *daemon_stats_channel_name(daemon_stats_channel_t channel)
+{
+    return (unsigned)channel < DAEMON_STATS_CH_COUNT ? k_channel_names[channel] : "unknown";
+}
+
+static void window_reset(window_t *w)
+{
+    daemon_stats_window_cfg_t cfg = w->cfg;
+    memset(w, 0, sizeof(*w));
+    w->cfg = cfg;
+    w->window_ms = (uint64_t)cfg.seconds * 1000u;
+    w->pane_ms = w->window_ms / DAEMON_STATS_PANES;
+    for (int i = 0; i < DAEMON_STATS_PANES; i++) {
+        w->pane_idx[i] = -1;
+    }
+    w->sets[0].epoch = -1;
+    w->sets[1].epoch = -1;
+}
+
+/* Época do conjunto P² `set`: o segundo é deslocado de meia janela */
+static int64_t set_epoch(const window_t *w, int set, uint64_t ts_ms)
+{
+    return (int64_t)((ts_ms + (uint64_t)set * (w->window_ms / 2)) / w->window_ms);
+}
+
+static void summary_fill(daemon_stats_summary_t *out, const moments_t *m, const quantiles_t *q)
+{
+    memset(out, 0, sizeof(*out));
+    out->n = m->n;
+    if (m->n == 0) {
+        return;
+    }
+    out->mean = m->mean;
+    out->stddev = m->n > 1 ? sqrt(m->m2 / (double)(m->n - 1)) : 0.0;
+    out->min = m->min;
+    out->max = m->max;
+    if (q) {
+        out->p1 = p2_value(&q->q[0], k_quantiles[0]);
+        out->p50 = p2_value(&q->q[1], k_quantiles[1]);
+        out->p99 = p2_value(&q->q[2], k_quantiles[2]);
+    }
+}
+
+/* Resultado da janela tumbling corrente */
+static void tumbling_result(const window_t *w, bool complete, daemon_stats_result_t *out)
+{
+    out->complete = complete;
+    out->from_ms = w->cur_start_ms;
+    out->to_ms = complete ? w->cur_start_ms + w->window_ms : w->cur_last_ms;
+    out->percentile_from_ms = w->cur_start_ms;
+    for (int c = 0; c < DAEMON_STATS_CH_COUNT; c++) {
+        summary_fill(&out->channels[c], &w->cur[c], &w->cur_q[c]);
+    }
+}
+
+static void window_add(window_t *w, uint64_t ts_ms, const float *values)
+{
+    if (w->since_ms == 0) {
+        w->since_ms = ts_ms;
+    }
+
+    if (w->cfg.mode == DAEMON_STATS_TUMBLING) {
+        uint64_t start = ts_ms - ts_ms % w->window_ms;
+        if (start != w->cur_start_ms) {
+            /* Fecha a janela anterior (se teve amostras) e recomeça */
+            if (w->cur[0].n > 0) {
+                tumbling_result(w, true, &w->done);
+                w->done.window = w->cfg;
+                w->have_done = true;
+            }
+            memset(w->cur, 0, sizeof(w->cur));
+            memset(w->cur_q, 0, sizeof(w->cur_q));
+            w->cur_start_ms = start;
+        }
+        w->cur_last_ms = ts_ms;
+        for (int c = 0; c < DAEMON_STATS_CH_COUNT; c++) {
+            moments_add(&w->cur[c], values[c]);
+            quantiles_add(&w->cur_q[c], values[c]);
+        }
+        return;
+    }
+
+    int64_t idx = (int64_t)(ts_ms / w->pane_ms);
+    int slot = (int)(idx % DAEMON_STATS_PANES);
+    if (w->pane_idx[slot] != idx) {
+        w->pane_idx[slot] = idx;
+        memset(w->panes[slot], 0, sizeof(w->panes[slot]));
+    }
+    for (int c = 0; c < DAEMON_STATS_CH_COUNT; c++) {
+        moments_add(&w->panes[slot][c], values[c]);
+    }
+
+    for (int s = 0; s < 2; s++) {
+        quantile_set_t *set = &w->sets[s];
+        int64_t epoch = set_epoch(w, s, ts_ms);
+        if (set->epoch != epoch) {
+            memset(set->ch, 0, sizeof(set->ch));
+            set->epoch = epoch;
+        }
+        for (int c = 0; c < DAEMON_STATS_CH_COUNT; c++) {
+            quantiles_add(&set->ch[c], values[c]);
+        }
+    }
+}
+
+/* ============================================
+ * Configuração
+ * ============================================ */
+bool daemon_stats_parse_windows(const char *spec, daemon_stats_window_cfg_t *out, uint32_t *count)
+{
+    if (!spec || !out || !count) {
+        return false;
+    }
+
+    daemon_stats_window_cfg_t windows[DAEMON_STATS_MAX_WINDOWS];
+    uint32_t n = 0;
+    const char *p = spec;
+
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        if (*p == '\0') {
+            break;
+        }
+        if (n == DAEMON_STATS_MAX_WINDOWS) {
+            return false;
+        }
+
+        char *end;
+        unsigned long seconds = strtoul(p, &end, 10);
+        if (end == p || seconds == 0 || seconds > DAEMON_STATS_MAX_WINDOW_SEC) {
+            return false;
+        }
+        p = end;
+
+        daemon_stats_mode_t mode = DAEMON_STATS_SLIDING;
+        if (*p == ':') {
+            p++;
+            size_t len = strcspn(p, ", \t");
+            if (len == 7 && strncmp(p, "sliding", 7) == 0) {
+                mode = DAEMON_STATS_SLIDING;
+            } else if (len == 8 && strncmp(p, "tumbling", 8) == 0) {
+                mode = DAEMON_STATS_TUMBLING;
+            } else {
+                return false;
+            }
+            p += len;
+        }
+        if (*p != '\0' && *p != ',' && *p != ' ' && *p != '\t') {
+            return false;
+        }
+
+        /* Uma duração só pode aparecer uma vez (é a chave da consulta) */
+        for (uint32_t i = 0; i < n; i++) {
+            if (windows[i].seconds == seconds) {
+                return false;
+            }
+        }
+        windows[n].seconds = (uint32_t)seconds;
+        windows[n].mode = mode;
+        n++;
+    }
+
+    memcpy(out, windows, n * sizeof(windows[0]));
+    *count = n;
+    return true;
+}
+
+void daemon_stats_init(const daemon_stats_window_cfg_t *windows, size_t count)
+{
+    pthread_mutex_lock(&g_mutex);
+    g_window_count = 0;
+    if (windows) {
+        for (size_t i = 0; i < count && i < DAEMON_STATS_MAX_WINDOWS; i++) {
+            g_windows[i].cfg = windows[i];
+            window_reset(&g_windows[i]);
+            g_window_count++;
+        }
+    }
+    pthread_mutex_unlock(&g_mutex);
+}
+
+size_t daemon_stats_get_windows(daemon_stats_window_cfg_t *out, size_t max)
+{
+    pthread_mutex_lock(&g_mutex);
+    size_t n = g_window_count < max ? g_window_count : max;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = g_windows[i].cfg;
+    }
+    pthread_mutex_unlock(&g_mutex);
+    return n;
+}
+
+/* ============================================
+ * Amostras
+ * ============================================ */
+void daemon_stats_add(uint64_t generation_id, uint64_t timestamp_ms, const float values[DAEMON_STATS_CH_COUNT])
+{
+    if (!values) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_mutex);
+    if (generation_id != g_generation_id) {
+        /* Outro módulo: nada do anterior entra nas janelas */
+        for (size_t i = 0; i < g_window_count; i++) {
+            window_reset(&g_windows[i]);
+        }
+        g_generation_id = generation_id;
+    }
+    for (size_t i = 0; i < g_window_count; i++) {
+        window_add(&g_windows[i], timestamp_ms, values);
+    }
+    pthread_mutex_unlock(&g_mutex);
+}
+
+/* ============================================
+ * Consulta
+ * ============================================ */
+static void sliding_result(const window_t *w, uint64_t now_ms, daemon_stats_result_t *out)
+{
+    int64_t now_idx = (int64_t)(now_ms / w->pane_ms);
+    moments_t merged[DAEMON_STATS_CH_COUNT];
+    memset(merged, 0, sizeof(merged));
+
+    for (int slot = 0; slot < DAEMON_STATS_PANES; slot++) {
+        int64_t idx = w->pane_idx[slot];
+        if (idx < 0 || idx > now_idx || idx <= now_idx - DAEMON_STATS_PANES) {
+            continue;
+        }
+        for (int c = 0; c < DAEMON_STATS_CH_COUNT; c++) {
+            moments_merge(&merged[c], &w->panes[slot][c]);
+        }
+    }
+
+    /* Percentis do conjunto P² mais antigo que ainda está na época */
+    const quantile_set_t *best = NULL;
+    int best_set = 0;
+    for (int s = 0; s < 2; s++) {
+        const quantile_set_t *set = &w->sets[s];
+        if (set->epoch != set_epoch(w, s, now_ms) || set->ch[0].q[0].count == 0) {
+            continue;
+        }
+        if (!best || set->ch[0].q[0].count > best->ch[0].q[0].count) {
+            best = set;
+            best_set = s;
+        }
+    }
+
+    /* Logo após o reset os painéis só têm o que chegou desde since_ms */
+    uint64_t from_ms = (uint64_t)(now_idx - DAEMON_STATS_PANES + 1) * w->pane_ms;
+    if (from_ms < w->since_ms) {
+        from_ms = w->since_ms;
+    }
+    out->complete = w->since_ms != 0 && now_ms >= w->since_ms + w->window_ms;
+    out->from_ms = from_ms;
+    out->to_ms = now_ms;
+    if (best) {
+        /* Inverso de set_epoch: início da época do conjunto usado */
+        uint64_t start = (uint64_t)best->epoch * w->window_ms - (uint64_t)best_set * (w->window_ms / 2);
+        out->percentile_from_ms = start > w->since_ms ? start : w->since_ms;
+    }
+    for (int c = 0; c < DAEMON_STATS_CH_COUNT; c++) {
+        summary_fill(&out->channels[c], &merged[c], best ? &best->ch[c] : NULL);
+    }
+}
+
+bool daemon_stats_query(uint32_t seconds, uint64_t now_ms, daemon_stats_result_t *out)
+{
+    if (!out) {
+        return false;
+    }
+
+    pthread_mutex_lock(&g_mutex);
+
+    const window_t *w = NULL;
+    for (size_t i = 0; i < g_window_count; i++) {
+        if (g_windows[i].cfg.seconds == seconds) {
+            w = &g_windows[i];
+            break;
+        }
+    }
+    if (!w) {
+        pthread_mutex_unlock(&g_mutex);
+        return false;
+    }
+
+    memset(out, 0, sizeof(*out));
+    if (w->cfg.mode == DAEMON_STATS_SLIDING) {
+        sliding_result(w, now_ms, out);
+    } else {
+        uint64_t now_start = now_ms - now_ms % w->window_ms;
+        if (w->cur[0].n > 0 && w->cur_start_ms + w->window_ms == now_start) {
+            /* A janela anterior acabou mas ainda não chegou amostra nova */
+            tumbling_result(w, true, out);
+        } else if (w->have_done && w->done.from_ms + w->window_ms == now_start) {
+            *out = w->done;
+        } else if (w->cur[0].n > 0 && w->cur_start_ms == now_start) {
+            tumbling_result(w, false, out);
+        } else {
+            out->from_ms = now_start;
+            out->to_ms = now_ms;
+        }
+    }
+    out->window = w->cfg;
+    out->generation_id = g_generation_id;
+
+    pthread_mutex_unlock(&g_mutex);
+    return true;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file daemon_stats.h
+ * @brief Estatísticas por janela de tempo das amostras A2h (GET STATS WINDOW)
+ *
+ * Cada janela configurada (stats_windows=) mantém, para cada canal, média e
+ * desvio padrão (Welford), mínimo/máximo e os percentis p1/p50/p99 (estimador
+ * P², Jain & Chlamtac 1985). Cada amostra custa O(1) por janela e canal;
+ * nada de histórico bruto é guardado.
+ *
+ * - Deslizante: a janela é dividida em DAEMON_STATS_PANES painéis; média,
+ *   σ e extremos vêm da fusão dos painéis dentro da janela (cobre de
+ *   W - W/PANES a W). P² não se funde, então os percentis vêm de dois
+ *   estimadores reiniciados a cada W, defasados de W/2: usa-se o mais
+ *   antigo, que cobre de W/2 a W (percentile_from_ms no resultado). Até
+ *   passar W desde a primeira amostra (início ou troca de módulo) a janela
+ *   é parcial: complete = false e from_ms na primeira amostra.
+ * - Tumbling: janelas alinhadas ao relógio (múltiplos de W); a consulta
+ *   devolve a última janela completa ou, antes da primeira, a parcial.
+ *
+ * Tudo recomeça quando o generation_id muda (outro módulo).
+ */
+
+#ifndef DAEMON_STATS_H
+#define DAEMON_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define DAEMON_STATS_MAX_WINDOWS 4
+#define DAEMON_STATS_PANES 10
+#define DAEMON_STATS_MAX_WINDOW_SEC 86400
+
+/* ============================================
+ * Canais
+ * ============================================ */
+typedef enum {
+    DAEMON_STATS_CH_TEMP_C,
+    DAEMON_STATS_CH_VOLTAGE_V,
+    DAEMON_STATS_CH_TX_BIAS_MA,
+    DAEMON_STATS_CH_TX_POWER_UW,
+    DAEMON_STATS_CH_TX_POWER_DBM,
+    DAEMON_STATS_CH_RX_POWER_UW,
+    DAEMON_STATS_CH_RX_POWER_DBM,
+    DAEMON_STATS_CH_COUNT
+} daemon_stats_channel_t;
+
+/* ============================================
+ * Janelas
+ * ============================================ */
+typedef enum {
+    DAEMON_STATS_SLIDING,
+    DAEMON_STATS_TUMBLING
+} daemon_stats_mode_t;
+
+typedef struct {
+    uint32_t seconds;
+    daemon_stats_mode_t mode;
+} daemon_stats_window_cfg_t;
+
+/* ============================================
+ * Resultado de uma Consulta
+ * ============================================ */
+typedef struct {
+    uint64_t n;
+    double mean;
+    double stddev;     /* Desvio padrão amostral (n - 1) */
+    double min;
+    double max;
+    double p1;
+    double p50;
+    double p99;
+} daemon_stats_summary_t;
+
+typedef struct {
+    daemon_stats_window_cfg_t window;
+    bool complete;             /* Tumbling: janela fechada; deslizante: W inteira desde o reset */
+    uint64_t generation_id;
+    uint64_t from_ms;          /* Início da janela (epoch, ms) */
+    uint64_t to_ms;            /* Fim da janela, ou última amostra se parcial */
+    uint64_t percentile_from_ms;   /* Início do trecho dos percentis (0 = sem amostras) */
+    daemon_stats_summary_t channels[DAEMON_STATS_CH_COUNT];
+} daemon_stats_result_t;
+
+/* ============================================
+ * Funções
+ * ============================================ */
+
+/**
+ * @brief Faz o parse de stats_windows= ("60,300,900:tumbling")
+ * @return false se a lista for inválida (out não é alterado)
+ */
+bool daemon_stats_parse_windows(const char *spec, daemon_stats_window_cfg_t *out, uint32_t *count);
+
+/**
+ * @brief Configura as janelas (descarta o que havia acumulado)
+ */
+void daemon_stats_init(const daemon_stats_window_cfg_t *windows, size_t count);
+
+/**
+ * @brief Janelas configuradas
+ * @return Quantidade copiada para out (até max)
+ */
+size_t daemon_stats_get_windows(daemon_stats_window_cfg_t *out, size_t max);
+
+/**
+ * @brief Acrescenta uma amostra a todas as janelas
+ * @param values Um valor por canal (daemon_stats_channel_t)
+ */
+void daemon_stats_add(uint64_t generation_id, uint64_t timestamp_ms, const float values[DAEMON_STATS_CH_COUNT]);
+
+/**
+ * @brief Estatísticas da janela de `seconds` no instante now_ms
+ * @return false se não houver janela configurada com essa duração
+ */
+bool daemon_stats_query(uint32_t seconds, uint64_t now_ms, daemon_stats_result_t *out);
+
+/**
+ * @brief Nome do canal nas respostas JSON (mesmo de GET FIELDS)
+ */
+const char *daemon_stats_channel_name(daemon_stats_channel_t channel);
+
+#endif /* DAEMON_STATS_H */
@@ -0,0 +1,337 @@
+/**
+ * @file daemon_trend.c
+ * @brief Implementação da tendência por camada (rollup + mínimos quadrados)
+ */
+
+#define _DEFAULT_SOURCE
+#include "daemon_trend.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MS_PER_DAY 86400000.0
+
+/* ============================================
+ * Somas do Ajuste — t em dias desde origin_ms
+ * ============================================ */
+typedef struct {
+    double n;
+    double st;
+    double stt;
+    double sy[DAEMON_ALARM_CH_COUNT];
+    double syy[DAEMON_ALARM_CH_COUNT];
+    double sty[DAEMON_ALARM_CH_COUNT];
+} sums_t;
+
+/* Balde fechado: média de cada canal */
+typedef struct {
+    uint64_t start_ms;
+    float mean[DAEMON_ALARM_CH_COUNT];
+} point_t;
+
+typedef struct {
+    daemon_trend_tier_cfg_t cfg;
+    uint64_t bucket_ms;
+    uint64_t span_ms;
+
+    /* Balde aberto */
+    uint64_t cur_start_ms;
+    uint32_t cur_n;
+    double cur_sum[DAEMON_ALARM_CH_COUNT];
+
+    /* Baldes fechados, do mais antigo (head) para o mais novo */
+    point_t ring[DAEMON_TREND_MAX_BUCKETS];
+    uint32_t head;
+    uint32_t count;
+    uint32_t closes;           /* Baldes fechados desde o último recálculo */
+    uint64_t origin_ms;
+    sums_t sums;
+} tier_t;
+
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static tier_t g_tiers[DAEMON_TREND_MAX_TIERS];
+static size_t g_tier_count = 0;
+static uint64_t g_generation_id = 0;
+
+static void tier_reset(tier_t *t)
+{
+    daemon_trend_tier_cfg_t cfg = t->cfg;
+    memset(t, 0, sizeof(*t));
+    t->cfg = cfg;
+    t->bucket_ms = (uint64_t)cfg.bucket_seconds * 1000u;
+    t->span_ms = t->bucket_ms * cfg.buckets;
+}
+
+/* t do ponto: meio do balde */
+static double point_t_days(const tier_t *t, const point_t *p)
+{
+    return ((double)p->start_ms + (double)t->bucket_ms / 2.0 - (double)t->origin_ms) / MS_PER_DAY;
+}
+
+static void sums_apply(tier_t *t, const point_t *p, double sign)
+{
+    sums_t *s = &t->sums;
+    double x = point_t_days(t, p);
+    s->n += sign;
+    s->st += sign * x;
+    s->stt += sign * x * x;
+    for (int c = 0; c < DAEMON_ALARM_CH_COUNT; c++) {
+        double y = p->mean[c];
+        s->sy[c] += sign * y;
+        s->syy[c] += sign * y * y;
+        s->sty[c] += sign * x * y;
+    }
+}
+
+/* Somas exatas a partir do anel, com a origem no ponto mais antigo */
+static void sums_rebuild(tier_t *t)
+{
+    memset(&t->sums, 0, sizeof(t->sums));
+    t->closes = 0;
+    if (t->count == 0) {
+        return;
+    }
+    t->origin_ms = t->ring[t->head].start_ms;
+    for (uint32_t i = 0; i < t->count; i++) {
+        sums_apply(t, &t->ring[(t->head + i) % t->cfg.buckets], 1.0);
+    }
+}
+
+static void tier_close(tier_t *t)
+{
+    if (t->cur_n == 0) {
+        return;
+    }
+
+    point_t p;
+    p.start_ms = t->cur_start_ms;
+    for (int c = 0; c < DAEMON_ALARM_CH_COUNT; c++) {
+        p.mean[c] = (float)(t->cur_sum[c] / t->cur_n);
+    }
+
+    /* Sai o mais antigo com o anel cheio ou fora do span (lacunas) */
+    while (t->count > 0
+           && (t->count == t->cfg.buckets || t->ring[t->head].start_ms + t->span_ms <= p.start_ms)) {
+        sums_apply(t, &t->ring[t->head], -1.0);
+        t->head = (t->head + 1) % t->cfg.buckets;
+        t->count--;
+    }
+
+    t->ring[(t->head + t->count) % t->cfg.buckets] = p;
+    t->count++;
+    if (t->count == 1 || ++t->closes >= t->cfg.buckets) {
+        sums_rebuild(t);
+    } else {
+        sums_apply(t, &p, 1.0);
+    }
+}
+
+static void tier_add(tier_t *t, uint64_t ts_ms, const float *values)
+{
+    uint64_t start = ts_ms - ts_ms % t->bucket_ms;
+    if (start != t->cur_start_ms) {
+        tier_close(t);
+        t->cur_start_ms = start;
+        t->cur_n = 0;
+        memset(t->cur_sum, 0, sizeof(t->cur_sum));
+    }
+    t->cur_n++;
+    for (int c = 0; c < DAEMON_ALARM_CH_COUNT; c++) {
+        t->cur_sum[c] += values[c];
+    }
+}
+
+/* ============================================
+ * Configuração
+ * ============================================ */
+bool daemon_trend_parse_tiers(const char *spec, daemon_trend_tier_cfg_t *out, uint32_t *count)
+{
+    if (!spec || !out || !count) {
+        return false;
+    }
+
+    daemon_trend_tier_cfg_t tiers[DAEMON_TREND_MAX_TIERS];
+    uint32_t n = 0;
+    const char *p = spec;
+
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        if (*p == '\0') {
+            break;
+        }
+        if (n == DAEMON_TREND_MAX_TIERS) {
+            return false;
+        }
+
+        char *end;
+        unsigned long bucket = strtoul(p, &end, 10);
+        if (end == p || bucket == 0 || *end != 'x') {
+            return false;
+        }
+        p = end + 1;
+        unsigned long buckets = strtoul(p, &end, 10);
+        if (end == p || buckets < DAEMON_TREND_MIN_POINTS || buckets > DAEMON_TREND_MAX_BUCKETS
+            || bucket > DAEMON_TREND_MAX_SPAN_SEC / buckets) {
+            return false;
+        }
+        p = end;
+        if (*p != '\0' && *p != ',' && *p != ' ' && *p != '\t') {
+            return false;
+        }
+
+        /* O span é a chave da consulta: não pode repetir */
+        for (uint32_t i = 0; i < n; i++) {
+            if ((uint64_t)tiers[i].bucket_seconds * tiers[i].buckets == (uint64_t)bucket * buckets) {
+                return false;
+            }
+        }
+        tiers[n].bucket_seconds = (uint32_t)bucket;
+        tiers[n].buckets = (uint32_t)buckets;
+        n++;
+    }
+
+    memcpy(out, tiers, n * sizeof(tiers[0]));
+    *count = n;
+    return true;
+}
+
+void daemon_trend_init(const daemon_trend_tier_cfg_t *tiers, size_t count)
+{
+    pthread_mutex_lock(&g_mutex);
+    g_tier_count = 0;
+    if (tiers) {
+        for (size_t i = 0; i < count && i < DAEMON_TREND_MAX_TIERS; i++) {
+            g_tiers[i].cfg = tiers[i];
+            tier_reset(&g_tiers[i]);
+            g_tier_count++;
+        }
+    }
+    pthread_mutex_unlock(&g_mutex);
+}
+
+size_t daemon_trend_get_tiers(daemon_trend_tier_cfg_t *out, size_t max)
+{
+    pthread_mutex_lock(&g_mutex);
+    size_t n = g_tier_count < max ? g_tier_count : max;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = g_tiers[i].cfg;
+    }
+    pthread_mutex_unlock(&g_mutex);
+    return n;
+}
+
+/* ============================================
+ * Amostras
+ * ============================================ */
+void daemon_trend_add(uint64_t generation_id, uint64_t timestamp_ms, const float values[DAEMON_ALARM_CH_COUNT])
+{
+    if (!values) {
+        return;
+    }
+    /* Um NaN contaminaria as somas até o próximo recálculo */
+    for (int c = 0; c < DAEMON_ALARM_CH_COUNT; c++) {
+        if (!isfinite(values[c])) {
+            return;
+        }
+    }
+
+    pthread_mutex_lock(&g_mutex);
+    if (generation_id != g_generation_id) {
+        for (size_t i = 0; i < g_tier_count; i++) {
+            tier_reset(&g_tiers[i]);
+        }
+        g_generation_id = generation_id;
+    }
+    for (size_t i = 0; i < g_tier_count; i++) {
+        tier_add(&g_tiers[i], timestamp_ms, values);
+    }
+    pthread_mutex_unlock(&g_mutex);
+}
+
+/* ============================================
+ * Consulta
+ * ============================================ */
+static void fit_channel(const tier_t *t, int c, uint64_t now_ms, daemon_trend_channel_result_t *out)
+{
+    const sums_t *s = &t->sums;
+    memset(out, 0, sizeof(*out));
+    out->points = t->count;
+    if (t->count < DAEMON_TREND_MIN_POINTS) {
+        return;
+    }
+
+    double n = s->n;
+    double stt = n * s->stt - s->st * s->st;
+    double sty = n * s->sty[c] - s->st * s->sy[c];
+    double syy = n * s->syy[c] - s->sy[c] * s->sy[c];
+    if (stt <= 0.0) {
+        return;
+    }
+
+    double slope = sty / stt;
+    double intercept = (s->sy[c] - slope * s->st) / n;
+    double now_t = ((double)now_ms - (double)t->origin_ms) / MS_PER_DAY;
+
+    out->valid = true;
+    out->slope_per_day = slope;
+    out->fitted = intercept + slope * now_t;
+    if (syy > 0.0) {
+        double r2 = (sty * sty) / (stt * syy);
+        out->r2 = r2 > 1.0 ? 1.0 : r2;
+    }
+}
+
+bool daemon_trend_query(uint32_t seconds, uint64_t now_ms, daemon_trend_result_t *out)
+{
+    if (!out) {
+        return false;
+    }
+
+    pthread_mutex_lock(&g_mutex);
+
+    const tier_t *t = NULL;
+    for (size_t i = 0; i < g_tier_count; i++) {
+        if ((uint64_t)g_tiers[i].cfg.bucket_seconds * g_tiers[i].cfg.buckets == seconds) {
+            t = &g_tiers[i];
+            break;
+        }
+    }
+    if (!t) {
+        pthread_mutex_unlock(&g_mutex);
+        return false;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->tier = t->cfg;
+    out->generation_id = g_generation_id;
+    if (t->count > 0) {
+        out->from_ms = t->ring[t->head].start_ms;
+        out->to_ms = t->ring[(t->head + t->count - 1) % t->cfg.buckets].start_ms + t->bucket_ms;
+    }
+    for (int c = 0; c < DAEMON_ALARM_CH_COUNT; c++) {
+        fit_channel(t, c, now_ms, &out->channels[c]);
+    }
+
+    pthread_mutex_unlock(&g_mutex);
+
+    /* Limiar do módulo na direção da inclinação (daemon_alarm tem o seu mutex) */
+    for (int c = 0; c < DAEMON_ALARM_CH_COUNT; c++) {
+        daemon_trend_channel_result_t *r = &out->channels[c];
+        if (!r->valid || r->slope_per_day == 0.0) {
+            continue;
+        }
+        bool rising = r->slope_per_day > 0.0;
+        daemon_alarm_condition_t cond = rising ? DAEMON_ALARM_HIGH_ALARM : DAEMON_ALARM_LOW_ALARM;
+        float threshold;
+        if (!daemon_alarm_module_threshold((daemon_alarm_channel_t)c, cond, &threshold)) {
+            continue;
+        }
+        double days = (threshold - r->fitted) / r->slope_per_day;
+        r->has_threshold = true;
+        r->condition = cond;
+        r->threshold = threshold;
+        r->days_to_threshold = days > 0.0 ? days : 0.0;
+    }
+    return true;
+}
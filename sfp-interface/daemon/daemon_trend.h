@@ -0,0 +1,102 @@
+/**
+ * @file daemon_trend.h
+ * @brief Tendência (mínimos quadrados) por canal sobre camadas de rollup
+ *
+ * Cada camada (trend_tiers=) agrega as amostras A2h válidas em baldes de
+ * largura fixa alinhados ao relógio e guarda a média de cada balde fechado
+ * num anel com os últimos N baldes. A reta y = a + b·t é ajustada sobre esses
+ * pontos com somas mantidas incrementalmente (entra o balde novo, sai o mais
+ * antigo): cada amostra custa O(1) por camada e canal, e a consulta também.
+ * As somas são refeitas a partir do anel a cada volta completa, com a origem
+ * de t no ponto mais antigo, para não acumular erro de arredondamento.
+ *
+ * A consulta devolve a inclinação por dia (°C/dia, V/dia, mA/dia, dB/dia),
+ * o valor ajustado agora, r² e, contra os limiares de alarme do próprio
+ * módulo (daemon_alarm_module_threshold), quantos dias faltam para a reta
+ * cruzar o limiar na direção em que está andando.
+ *
+ * Os canais são os de daemon_alarm, com os valores na calibração do módulo
+ * (RX sem rx_cal), os mesmos comparados com os limiares do módulo.
+ * Tudo recomeça quando o generation_id muda (outro módulo).
+ */
+
+#ifndef DAEMON_TREND_H
+#define DAEMON_TREND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "daemon_alarm.h"
+
+#define DAEMON_TREND_MAX_TIERS 4
+#define DAEMON_TREND_MAX_BUCKETS 256
+#define DAEMON_TREND_MIN_POINTS 3     /* Pontos (baldes) mínimos para haver reta */
+#define DAEMON_TREND_MAX_SPAN_SEC (400u * 86400u)
+
+/* ============================================
+ * Camadas
+ * ============================================ */
+typedef struct {
+    uint32_t bucket_seconds;   /* Largura do balde */
+    uint32_t buckets;          /* Baldes no anel (span = bucket_seconds * buckets) */
+} daemon_trend_tier_cfg_t;
+
+/* ============================================
+ * Resultado de uma Consulta
+ * ============================================ */
+typedef struct {
+    uint32_t points;           /* Baldes no ajuste */
+    bool valid;                /* points >= DAEMON_TREND_MIN_POINTS e t variou */
+    double slope_per_day;
+    double fitted;             /* Valor da reta em now_ms */
+    double r2;
+    bool has_threshold;        /* Há limiar do módulo na direção da inclinação */
+    daemon_alarm_condition_t condition;   /* HIGH_ALARM ou LOW_ALARM */
+    double threshold;
+    double days_to_threshold;  /* 0 se a reta já passou do limiar */
+} daemon_trend_channel_result_t;
+
+typedef struct {
+    daemon_trend_tier_cfg_t tier;
+    uint64_t generation_id;
+    uint64_t from_ms;          /* Início do balde mais antigo no ajuste */
+    uint64_t to_ms;            /* Fim do balde mais novo no ajuste */
+    daemon_trend_channel_result_t channels[DAEMON_ALARM_CH_COUNT];
+} daemon_trend_result_t;
+
+/* ============================================
+ * Funções
+ * ============================================ */
+
+/**
+ * @brief Faz o parse de trend_tiers= ("60x60,900x96,21600x120": largura do
+ *        balde em segundos x quantidade de baldes)
+ * @return false se a lista for inválida (out não é alterado)
+ */
+bool daemon_trend_parse_tiers(const char *spec, daemon_trend_tier_cfg_t *out, uint32_t *count);
+
+/**
+ * @brief Configura as camadas (descarta o que havia acumulado)
+ */
+void daemon_trend_init(const daemon_trend_tier_cfg_t *tiers, size_t count);
+
+/**
+ * @brief Camadas configuradas
+ * @return Quantidade copiada para out (até max)
+ */
+size_t daemon_trend_get_tiers(daemon_trend_tier_cfg_t *out, size_t max);
+
+/**
+ * @brief Acrescenta uma amostra a todas as camadas
+ * @param values Um valor por canal (daemon_alarm_channel_t), na calibração
+ *        do módulo
+ */
+void daemon_trend_add(uint64_t generation_id, uint64_t timestamp_ms, const float values[DAEMON_ALARM_CH_COUNT]);
+
+/**
+ * @brief Tendência da camada de span `seconds` no instante now_ms
+ * @return false se não houver camada configurada com esse span
+ */
+bool daemon_trend_query(uint32_t seconds, uint64_t now_ms, daemon_trend_result_t *out);
+
+#endif /* DAEMON_TREND_H */
@@ -104,6 +104,21 @@ typedef enum {
     A2_CAL_CONST_OR_ENHANCED = 56, /* Constantes ou Recursos Melhorados */
     A2_MAX_PWR_CONSUMPTION   = 66, /* Consumo máximo (LSB=0.1W) se bit A0.64.6=1 */
 
+    /* Calibração Externa (A0h Byte 92 bit 4) [Table 9-6] */
+    A2_EXT_CAL_RX_PWR_4      = 56, /* Rx_PWR(4): float IEEE-754 big-endian */
+    A2_EXT_CAL_RX_PWR_3      = 60, /* Rx_PWR(3) */
+    A2_EXT_CAL_RX_PWR_2      = 64, /* Rx_PWR(2) */
+    A2_EXT_CAL_RX_PWR_1      = 68, /* Rx_PWR(1) */
+    A2_EXT_CAL_RX_PWR_0      = 72, /* Rx_PWR(0) */
+    A2_EXT_CAL_TX_I_SLOPE    = 76, /* Slope: unsigned 8.8 */
+    A2_EXT_CAL_TX_I_OFFSET   = 78, /* Offset: signed 16 bits */
+    A2_EXT_CAL_TX_PWR_SLOPE  = 80,
+    A2_EXT_CAL_TX_PWR_OFFSET = 82,
+    A2_EXT_CAL_T_SLOPE       = 84,
+    A2_EXT_CAL_T_OFFSET      = 86,
+    A2_EXT_CAL_V_SLOPE       = 88,
+    A2_EXT_CAL_V_OFFSET      = 90,
+
     A2_CC_DMI                = 95, /* Checksum bytes 0-94  */
 
     /* Dados em Tempo Real (96-109) [38, 39] */
@@ -1,5 +1,7 @@
 #include "i2c.h"
+#include "sfp_probes.h"
 #include <stdint.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <signal.h>
 #include <stdio.h>
@@ -51,36 +53,57 @@ void sfp_i2c_close(int fd)
 }
 
 /**
- * @brief Lê um bloco de bytes da EEPROM do SFP
+ * @brief Lê um bloco de bytes da EEPROM do SFP, sem mensagens de erro
  */
-bool sfp_read_block(int fd, uint8_t dev_addr, uint8_t start_offset, uint8_t *buffer, uint8_t length)
+static ssize_t read_block(int fd, uint8_t dev_addr, uint8_t start_offset, uint8_t *buffer, uint8_t length)
 {
-    if (fd < 0 || !buffer || length == 0) {
-        return false;
-    }
-
     /* Configura o endereço do dispositivo I2C slave */
     if (ioctl(fd, I2C_SLAVE, dev_addr) < 0) {
-        perror("Erro ao configurar endereço I2C");
-        return false;
+        return -errno;
     }
 
-    /* Escreve o offset inicial */
-    if (write(fd, &start_offset, 1) != 1) {
-        perror("Erro ao escrever offset I2C");
-        return false;
+    /* Escreve o offset inicial (sem ACK: EREMOTEIO) */
+    ssize_t written = write(fd, &start_offset, 1);
+    if (written != 1) {
+        return written < 0 ? -errno : -EIO;
     }
 
     /* Lê os dados */
     ssize_t bytes_read = read(fd, buffer, length);
-    if (bytes_read != length) {
-        if (bytes_read < 0) {
-            perror("Erro ao ler dados I2C");
-        } else {
-            fprintf(stderr, "Erro: lidos %zd bytes, esperados %d\n", bytes_read, length);
-        }
-        return false;
+    if (bytes_read < 0) {
+        return -errno;
+    }
+    return bytes_read;
+}
+
+ssize_t sfp_read_block_n(int fd, uint8_t dev_addr, uint8_t start_offset, uint8_t *buffer, uint8_t length)
+{
+    if (fd < 0 || !buffer || length == 0) {
+        return -EINVAL;
     }
 
-    return true;
+    /* USDT sfp:i2c__start / sfp:i2c__done (result = bytes lidos ou -errno) */
+    SFP_PROBE3(i2c__start, dev_addr, start_offset, length);
+    ssize_t result = read_block(fd, dev_addr, start_offset, buffer, length);
+    SFP_PROBE3(i2c__done, dev_addr, length, result);
+    return result;
+}
+
+/**
+ * @brief Lê um bloco de bytes da EEPROM do SFP
+ */
+bool sfp_read_block(int fd, uint8_t dev_addr, uint8_t start_offset, uint8_t *buffer, uint8_t length)
+{
+    ssize_t bytes_read = sfp_read_block_n(fd, dev_addr, start_offset, buffer, length);
+    if (bytes_read == length) {
+        return true;
+    }
+
+    if (bytes_read < 0) {
+        errno = (int)-bytes_read;
+        perror("Erro ao ler dados I2C");
+    } else {
+        fprintf(stderr, "Erro: lidos %zd bytes, esperados %d\n", bytes_read, length);
+    }
+    return false;
 }
@@ -42,4 +42,14 @@ void sfp_i2c_close(int fd);
  */
 bool sfp_read_block(int fd, uint8_t dev_addr, uint8_t start_offset, uint8_t *buffer, uint8_t length);
 
+/**
+ * @brief Como sfp_read_block(), mas devolve o resultado cru e não imprime nada
+ *
+ * Usada pelo daemon para classificar falhas (NACK, timeout, leitura curta).
+ *
+ * @return Bytes lidos (pode ser menos que length: leitura curta) ou -errno
+ *         (-EREMOTEIO quando o dispositivo não dá ACK, -ETIMEDOUT...)
+ */
+ssize_t sfp_read_block_n(int fd, uint8_t dev_addr, uint8_t start_offset, uint8_t *buffer, uint8_t length);
+
 #endif
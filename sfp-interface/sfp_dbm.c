@@ -0,0 +1,83 @@
+/**
+ * @file sfp_dbm.c
+ * @brief Tabela de conversão µW → dBm
+ */
+
+#include "sfp_dbm.h"
+#include "defs.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/* ============================================
+ * Tabela
+ * ============================================ */
+static float g_dbm[UINT16_MAX + 1];
+static atomic_bool g_ready;
+static pthread_once_t g_once = PTHREAD_ONCE_INIT;
+
+/* A expressão de referência: qualquer mudança aqui muda a tabela junto */
+static float dbm_reference(float power_uw)
+{
+    if (power_uw <= 0.0f) {
+        return SFP_DBM_FLOOR;
+    }
+    return 10.0f * log10f(power_uw / 1000.0f);
+}
+
+static void dbm_fill(void)
+{
+    for (uint32_t raw = 0; raw <= UINT16_MAX; raw++) {
+        g_dbm[raw] = dbm_reference(POWER_TO_UW(raw));
+    }
+    atomic_store_explicit(&g_ready, true, memory_order_release);
+}
+
+void sfp_dbm_init(void)
+{
+    pthread_once(&g_once, dbm_fill);
+}
+
+/* ============================================
+ * Conversão
+ * ============================================ */
+float sfp_dbm_from_raw(uint16_t raw)
+{
+    if (atomic_load_explicit(&g_ready, memory_order_acquire)) {
+        return g_dbm[raw];
+    }
+    return dbm_reference(POWER_TO_UW(raw));
+}
+
+float sfp_dbm_from_uw(double uw)
+{
+    float power_uw = (float)uw;
+
+    /* Só usa a tabela se o valor for exatamente o de algum bruto */
+    if (power_uw > 0.0f && power_uw <= POWER_TO_UW(UINT16_MAX)
+        && atomic_load_explicit(&g_ready, memory_order_acquire)) {
+        uint16_t raw = (uint16_t)lrintf(power_uw * 10.0f);
+        if (POWER_TO_UW(raw) == power_uw) {
+            return g_dbm[raw];
+        }
+    }
+    return dbm_reference(power_uw);
+}
+
+void sfp_dbm_from_raw_array(const uint16_t *raw, float *dbm, size_t count)
+{
+    if (!raw || !dbm) {
+        return;
+    }
+
+    if (!atomic_load_explicit(&g_ready, memory_order_acquire)) {
+        for (size_t i = 0; i < count; i++) {
+            dbm[i] = dbm_reference(POWER_TO_UW(raw[i]));
+        }
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        dbm[i] = g_dbm[raw[i]];
+    }
+}
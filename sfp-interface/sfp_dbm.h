@@ -0,0 +1,45 @@
+/**
+ * @file sfp_dbm.h
+ * @brief Conversão µW → dBm por tabela (valores brutos de 16 bits, LSB 0.1 µW)
+ *
+ * TX e RX power (A2h bytes 102–105) são inteiros de 16 bits em 0.1 µW, então
+ * há só 65536 valores possíveis de dBm com calibração interna. sfp_dbm_init()
+ * preenche uma tabela de 256 KiB com a mesma expressão em float usada antes
+ * (10 * log10f(µW / 1000)), de modo que o resultado é idêntico bit a bit ao
+ * log10f da libm da máquina; a conversão por amostra vira uma leitura.
+ *
+ * Valores que não caem na grade de 0.1 µW (calibração externa) e chamadas
+ * antes de sfp_dbm_init() usam log10f diretamente, com o mesmo resultado.
+ */
+
+#ifndef SFP_DBM_H
+#define SFP_DBM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Potência zero ou negativa: piso condizente com a sensibilidade do módulo */
+#define SFP_DBM_FLOOR (-40.0f)
+
+/**
+ * @brief Preenche a tabela (idempotente, thread-safe; ~1 ms)
+ */
+void sfp_dbm_init(void);
+
+/**
+ * @brief dBm de um valor bruto de potência (0.1 µW/LSB)
+ */
+float sfp_dbm_from_raw(uint16_t raw);
+
+/**
+ * @brief dBm de uma potência em µW; tabela quando o valor é um múltiplo
+ *        exato de POWER_TO_UW, log10f caso contrário
+ */
+float sfp_dbm_from_uw(double uw);
+
+/**
+ * @brief Converte um bloco de valores brutos (buffers de burst)
+ */
+void sfp_dbm_from_raw_array(const uint16_t *raw, float *dbm, size_t count);
+
+#endif /* SFP_DBM_H */
@@ -0,0 +1,38 @@
+/**
+ * @file sfp_probes.h
+ * @brief Pontos de rastreamento estáticos (USDT) do provider "sfp"
+ *
+ * Com <sys/sdt.h> disponível (pacote systemtap-sdt-dev), cada SFP_PROBEn
+ * vira um NOP mais uma nota .note.stapsdt no binário; bpftrace/perf ativam o
+ * ponto em tempo de execução sem rebuild. Sem o header, ou com
+ * -DSFP_NO_PROBES, as macros somem e os argumentos nem são avaliados.
+ *
+ * Pontos (ver README, "Tracing"):
+ *   i2c__start(addr, offset, len)        i2c__done(addr, len, result)
+ *   fsm__transition(from, to)            sample__publish(seq, changed)
+ *   command__receive(fd, command)        command__respond(fd, type, elapsed_ns)
+ */
+
+#ifndef SFP_PROBES_H
+#define SFP_PROBES_H
+
+#if !defined(SFP_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define SFP_HAVE_PROBES 1
+#endif
+#endif
+
+#ifdef SFP_HAVE_PROBES
+#define SFP_PROBE0(name)                     DTRACE_PROBE(sfp, name)
+#define SFP_PROBE1(name, a)                  DTRACE_PROBE1(sfp, name, a)
+#define SFP_PROBE2(name, a, b)               DTRACE_PROBE2(sfp, name, a, b)
+#define SFP_PROBE3(name, a, b, c)            DTRACE_PROBE3(sfp, name, a, b, c)
+#else
+#define SFP_PROBE0(name)                     do { } while (0)
+#define SFP_PROBE1(name, a)                  do { } while (0)
+#define SFP_PROBE2(name, a, b)               do { } while (0)
+#define SFP_PROBE3(name, a, b, c)            do { } while (0)
+#endif
+
+#endif /* SFP_PROBES_H */
@@ -0,0 +1,226 @@
+/**
+ * @file sfp_wire.c
+ * @brief Encode/decode do protocolo binário (little-endian, independente do host)
+ */
+
+#include "sfp_wire.h"
+#include <string.h>
+
+/* ============================================
+ * Primitivas Little-Endian
+ * ============================================ */
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void put_u64(uint8_t *p, uint64_t v)
+{
+    put_u32(p, (uint32_t)v);
+    put_u32(p + 4, (uint32_t)(v >> 32));
+}
+
+static void put_f32(uint8_t *p, float v)
+{
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    put_u32(p, bits);
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const uint8_t *p)
+{
+    return (uint64_t)get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+static float get_f32(const uint8_t *p)
+{
+    uint32_t bits = get_u32(p);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+/* ============================================
+ * Cabeçalho
+ * ============================================ */
+void sfp_wire_encode_header(uint8_t *buf, const sfp_wire_header_t *hdr)
+{
+    put_u32(buf + 0, SFP_WIRE_MAGIC);
+    buf[4] = SFP_WIRE_VERSION;
+    buf[5] = hdr->type;
+    put_u16(buf + 6, hdr->flags);
+    put_u32(buf + 8, hdr->payload_len);
+    put_u32(buf + 12, hdr->count);
+    put_u64(buf + 16, hdr->seq);
+}
+
+bool sfp_wire_decode_header(const uint8_t *buf, size_t len, sfp_wire_header_t *hdr)
+{
+    if (!buf || !hdr || len < SFP_WIRE_HEADER_SIZE) {
+        return false;
+    }
+    if (get_u32(buf) != SFP_WIRE_MAGIC || buf[4] != SFP_WIRE_VERSION) {
+        return false;
+    }
+
+    hdr->version = buf[4];
+    hdr->type = buf[5];
+    hdr->flags = get_u16(buf + 6);
+    hdr->payload_len = get_u32(buf + 8);
+    hdr->count = get_u32(buf + 12);
+    hdr->seq = get_u64(buf + 16);
+    return true;
+}
+
+/* ============================================
+ * Amostra Dinâmica
+ * ============================================ */
+void sfp_wire_encode_sample(uint8_t *buf, const sfp_wire_sample_t *sample)
+{
+    put_u64(buf + 0, sample->generation_id);
+    put_u64(buf + 8, sample->timestamp_ms);
+    put_f32(buf + 16, sample->temp_c);
+    put_f32(buf + 20, sample->vcc_v);
+    put_f32(buf + 24, sample->tx_bias_ma);
+    put_f32(buf + 28, sample->tx_power_uw);
+    put_f32(buf + 32, sample->tx_power_dbm);
+    put_f32(buf + 36, sample->rx_power_uw);
+    put_f32(buf + 40, sample->rx_power_dbm);
+    buf[44] = sample->flags;
+    buf[45] = sample->changed;
+    put_u16(buf + 46, sample->status);
+}
+
+void sfp_wire_decode_sample(const uint8_t *buf, sfp_wire_sample_t *sample)
+{
+    sample->generation_id = get_u64(buf + 0);
+    sample->timestamp_ms = get_u64(buf + 8);
+    sample->temp_c = get_f32(buf + 16);
+    sample->vcc_v = get_f32(buf + 20);
+    sample->tx_bias_ma = get_f32(buf + 24);
+    sample->tx_power_uw = get_f32(buf + 28);
+    sample->tx_power_dbm = get_f32(buf + 32);
+    sample->rx_power_uw = get_f32(buf + 36);
+    sample->rx_power_dbm = get_f32(buf + 40);
+    sample->flags = buf[44];
+    sample->changed = buf[45];
+    sample->status = get_u16(buf + 46);
+}
+
+/* ============================================
+ * Estado
+ * ============================================ */
+void sfp_wire_encode_state(uint8_t *buf, const sfp_wire_state_t *state)
+{
+    put_u64(buf + 0, state->generation_id);
+    put_u64(buf + 8, (uint64_t)state->first_detected);
+    put_u64(buf + 16, (uint64_t)state->last_a0_read);
+    put_u64(buf + 24, (uint64_t)state->last_a2_read);
+    buf[32] = state->state;
+    buf[33] = 0;
+    buf[34] = 0;
+    buf[35] = 0;
+    put_u32(buf + 36, state->i2c_error_count);
+}
+
+void sfp_wire_decode_state(const uint8_t *buf, sfp_wire_state_t *state)
+{
+    state->generation_id = get_u64(buf + 0);
+    state->first_detected = (int64_t)get_u64(buf + 8);
+    state->last_a0_read = (int64_t)get_u64(buf + 16);
+    state->last_a2_read = (int64_t)get_u64(buf + 24);
+    state->state = buf[32];
+    state->i2c_error_count = get_u32(buf + 36);
+}
+
+/* ============================================
+ * Histórico
+ * ============================================ */
+void sfp_wire_encode_history_point(uint8_t *buf, const sfp_wire_history_point_t *point)
+{
+    put_u64(buf + 0, point->timestamp_ms);
+    put_u32(buf + 8, point->duration_ms);
+    put_u32(buf + 12, point->samples);
+    put_f32(buf + 16, point->min);
+    put_f32(buf + 20, point->max);
+    put_f32(buf + 24, point->mean);
+    put_u16(buf + 28, point->channel);
+    put_u16(buf + 30, 0);
+}
+
+void sfp_wire_decode_history_point(const uint8_t *buf, sfp_wire_history_point_t *point)
+{
+    point->timestamp_ms = get_u64(buf + 0);
+    point->duration_ms = get_u32(buf + 8);
+    point->samples = get_u32(buf + 12);
+    point->min = get_f32(buf + 16);
+    point->max = get_f32(buf + 20);
+    point->mean = get_f32(buf + 24);
+    point->channel = get_u16(buf + 28);
+}
+
+/* ============================================
+ * Burst
+ * ============================================ */
+void sfp_wire_encode_burst_info(uint8_t *buf, const sfp_wire_burst_info_t *info)
+{
+    put_u64(buf + 0, info->start_us);
+    put_u32(buf + 8, info->interval_us);
+    put_u16(buf + 12, info->channel);
+    put_u16(buf + 14, 0);
+}
+
+void sfp_wire_decode_burst_info(const uint8_t *buf, sfp_wire_burst_info_t *info)
+{
+    info->start_us = get_u64(buf + 0);
+    info->interval_us = get_u32(buf + 8);
+    info->channel = get_u16(buf + 12);
+}
+
+/* ============================================
+ * Frames Completos
+ * ============================================ */
+size_t sfp_wire_frame_sample(uint8_t *buf, uint64_t seq, const sfp_wire_sample_t *sample)
+{
+    sfp_wire_header_t hdr = {
+        .type = SFP_WIRE_TYPE_SAMPLE,
+        .payload_len = SFP_WIRE_SAMPLE_SIZE,
+        .count = 1,
+        .seq = seq,
+    };
+    sfp_wire_encode_header(buf, &hdr);
+    sfp_wire_encode_sample(buf + SFP_WIRE_HEADER_SIZE, sample);
+    return SFP_WIRE_HEADER_SIZE + SFP_WIRE_SAMPLE_SIZE;
+}
+
+size_t sfp_wire_frame_state(uint8_t *buf, uint64_t seq, const sfp_wire_state_t *state)
+{
+    sfp_wire_header_t hdr = {
+        .type = SFP_WIRE_TYPE_STATE,
+        .payload_len = SFP_WIRE_STATE_SIZE,
+        .count = 1,
+        .seq = seq,
+    };
+    sfp_wire_encode_header(buf, &hdr);
+    sfp_wire_encode_state(buf + SFP_WIRE_HEADER_SIZE, state);
+    return SFP_WIRE_HEADER_SIZE + SFP_WIRE_STATE_SIZE;
+}
@@ -0,0 +1,222 @@
+/**
+ * @file sfp_wire.h
+ * @brief Protocolo binário compacto do daemon SFP (alternativa ao JSON)
+ *
+ * Negociado por conexão com o comando `FORMAT BINARY` no socket do daemon.
+ * Todo frame começa com o mesmo cabeçalho de tamanho fixo, seguido de
+ * `payload_len` bytes. Todos os campos são little-endian; floats são
+ * IEEE-754 binary32. Os offsets abaixo são o contrato do protocolo; as
+ * structs C são só a representação em memória (use as funções de
+ * encode/decode, nunca memcpy da struct).
+ */
+
+#ifndef SFP_WIRE_H
+#define SFP_WIRE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* ============================================
+ * Versão e Tamanhos
+ * ============================================ */
+#define SFP_WIRE_MAGIC 0x57504653u     /* "SFPW" nos bytes 0-3 */
+#define SFP_WIRE_VERSION 1
+
+#define SFP_WIRE_HEADER_SIZE 24
+#define SFP_WIRE_SAMPLE_SIZE 48
+#define SFP_WIRE_STATE_SIZE 40
+#define SFP_WIRE_HISTORY_POINT_SIZE 32
+#define SFP_WIRE_BURST_INFO_SIZE 16
+
+/* ============================================
+ * Tipos de Frame
+ * ============================================ */
+typedef enum {
+    SFP_WIRE_TYPE_TEXT    = 0,  /* Resposta textual embrulhada: "STATUS ...\n" + JSON + "\n" */
+    SFP_WIRE_TYPE_SAMPLE  = 1,  /* count = 1 registro sfp_wire_sample_t */
+    SFP_WIRE_TYPE_STATE   = 2,  /* count = 1 registro sfp_wire_state_t */
+    SFP_WIRE_TYPE_HISTORY = 3,  /* count = N registros sfp_wire_history_point_t */
+    SFP_WIRE_TYPE_BURST   = 4   /* sfp_wire_burst_info_t + count valores float32 */
+} sfp_wire_type_t;
+
+/* ============================================
+ * Canais (histórico e burst)
+ * ============================================ */
+typedef enum {
+    SFP_WIRE_CH_TEMP_C       = 0,
+    SFP_WIRE_CH_VCC_V        = 1,
+    SFP_WIRE_CH_TX_BIAS_MA   = 2,
+    SFP_WIRE_CH_TX_POWER_UW  = 3,
+    SFP_WIRE_CH_TX_POWER_DBM = 4,
+    SFP_WIRE_CH_RX_POWER_UW  = 5,
+    SFP_WIRE_CH_RX_POWER_DBM = 6
+} sfp_wire_channel_t;
+
+/* ============================================
+ * Cabeçalho (24 bytes)
+ * ============================================
+ *  0  u32  magic        SFP_WIRE_MAGIC
+ *  4  u8   version      SFP_WIRE_VERSION
+ *  5  u8   type         sfp_wire_type_t
+ *  6  u16  flags        reservado (0)
+ *  8  u32  payload_len  bytes após o cabeçalho
+ * 12  u32  count        registros no payload
+ * 16  u64  seq          SAMPLE/STATE: sample_seq do daemon; HISTORY/BURST:
+ *                       sequência do lote; TEXT: 0
+ */
+typedef struct {
+    uint8_t version;
+    uint8_t type;
+    uint16_t flags;
+    uint32_t payload_len;
+    uint32_t count;
+    uint64_t seq;
+} sfp_wire_header_t;
+
+/* ============================================
+ * Amostra Dinâmica A2h (48 bytes)
+ * ============================================
+ *  0  u64  generation_id
+ *  8  u64  timestamp_ms   epoch, ms
+ * 16  f32  temp_c
+ * 20  f32  vcc_v
+ * 24  f32  tx_bias_ma
+ * 28  f32  tx_power_uw
+ * 32  f32  tx_power_dbm
+ * 36  f32  rx_power_uw
+ * 40  f32  rx_power_dbm
+ * 44  u8   flags          SFP_WIRE_SAMPLE_*
+ * 45  u8   changed        campos alterados desde a amostra anterior (SFP_A2_CHANGED_*)
+ * 46  u16  status         bits 0-7: A2h Byte 110; SFP_WIRE_STATUS_* (a máscara
+ *                         completa de alarmes/avisos está no campo JSON "flags")
+ */
+#define SFP_WIRE_SAMPLE_VALID       (1u << 0)
+#define SFP_WIRE_SAMPLE_DATA_READY  (1u << 1)
+
+#define SFP_WIRE_STATUS_ALARM       (1u << 8)   /* Algum flag de alarme (Bytes 112-113) */
+#define SFP_WIRE_STATUS_WARNING     (1u << 9)   /* Algum flag de aviso (Bytes 116-117) */
+
+typedef struct {
+    uint64_t generation_id;
+    uint64_t timestamp_ms;
+    float temp_c;
+    float vcc_v;
+    float tx_bias_ma;
+    float tx_power_uw;
+    float tx_power_dbm;
+    float rx_power_uw;
+    float rx_power_dbm;
+    uint8_t flags;
+    uint8_t changed;
+    uint16_t status;
+} sfp_wire_sample_t;
+
+/* ============================================
+ * Estado da FSM (40 bytes)
+ * ============================================
+ *  0  u64  generation_id
+ *  8  i64  first_detected   epoch, s
+ * 16  i64  last_a0_read     epoch, s
+ * 24  i64  last_a2_read     epoch, s
+ * 32  u8   state            0=INIT 1=ABSENT 2=PRESENT 3=ERROR
+ * 33  u8   reservado[3] (0)
+ * 36  u32  i2c_error_count
+ */
+typedef struct {
+    uint64_t generation_id;
+    int64_t first_detected;
+    int64_t last_a0_read;
+    int64_t last_a2_read;
+    uint8_t state;
+    uint32_t i2c_error_count;
+} sfp_wire_state_t;
+
+/* ============================================
+ * Ponto de Histórico (32 bytes por registro)
+ * ============================================
+ *  0  u64  timestamp_ms   início do intervalo, epoch ms
+ *  8  u32  duration_ms    largura do intervalo
+ * 12  u32  samples        amostras agregadas
+ * 16  f32  min
+ * 20  f32  max
+ * 24  f32  mean
+ * 28  u16  channel        sfp_wire_channel_t
+ * 30  u16  reservado (0)
+ */
+typedef struct {
+    uint64_t timestamp_ms;
+    uint32_t duration_ms;
+    uint32_t samples;
+    float min;
+    float max;
+    float mean;
+    uint16_t channel;
+} sfp_wire_history_point_t;
+
+/* ============================================
+ * Burst (16 bytes + count * 4 bytes)
+ * ============================================
+ *  0  u64  start_us       epoch, µs da primeira leitura
+ *  8  u32  interval_us    espaçamento entre leituras
+ * 12  u16  channel        sfp_wire_channel_t
+ * 14  u16  reservado (0)
+ * 16  f32  valores[count]
+ */
+typedef struct {
+    uint64_t start_us;
+    uint32_t interval_us;
+    uint16_t channel;
+} sfp_wire_burst_info_t;
+
+/* ============================================
+ * Encode / Decode
+ * ============================================ */
+
+/**
+ * @brief Escreve cabeçalho (magic e versão preenchidos automaticamente)
+ * @param buf Destino (SFP_WIRE_HEADER_SIZE bytes)
+ * @param hdr Cabeçalho (version é ignorado)
+ */
+void sfp_wire_encode_header(uint8_t *buf, const sfp_wire_header_t *hdr);
+
+/**
+ * @brief Lê e valida cabeçalho
+ * @param buf Origem
+ * @param len Bytes disponíveis em buf
+ * @param hdr Saída
+ * @return true se há um cabeçalho completo com magic e versão reconhecidos
+ */
+bool sfp_wire_decode_header(const uint8_t *buf, size_t len, sfp_wire_header_t *hdr);
+
+void sfp_wire_encode_sample(uint8_t *buf, const sfp_wire_sample_t *sample);
+void sfp_wire_decode_sample(const uint8_t *buf, sfp_wire_sample_t *sample);
+
+void sfp_wire_encode_state(uint8_t *buf, const sfp_wire_state_t *state);
+void sfp_wire_decode_state(const uint8_t *buf, sfp_wire_state_t *state);
+
+void sfp_wire_encode_history_point(uint8_t *buf, const sfp_wire_history_point_t *point);
+void sfp_wire_decode_history_point(const uint8_t *buf, sfp_wire_history_point_t *point);
+
+void sfp_wire_encode_burst_info(uint8_t *buf, const sfp_wire_burst_info_t *info);
+void sfp_wire_decode_burst_info(const uint8_t *buf, sfp_wire_burst_info_t *info);
+
+/**
+ * @brief Monta frame SAMPLE completo (cabeçalho + registro)
+ * @param buf Destino (SFP_WIRE_HEADER_SIZE + SFP_WIRE_SAMPLE_SIZE bytes)
+ * @param seq Sequência da amostra
+ * @param sample Amostra
+ * @return Tamanho do frame
+ */
+size_t sfp_wire_frame_sample(uint8_t *buf, uint64_t seq, const sfp_wire_sample_t *sample);
+
+/**
+ * @brief Monta frame STATE completo (cabeçalho + registro)
+ * @param buf Destino (SFP_WIRE_HEADER_SIZE + SFP_WIRE_STATE_SIZE bytes)
+ * @param seq Sequência da última amostra
+ * @param state Estado
+ * @return Tamanho do frame
+ */
+size_t sfp_wire_frame_state(uint8_t *buf, uint64_t seq, const sfp_wire_state_t *state);
+
+#endif /* SFP_WIRE_H */
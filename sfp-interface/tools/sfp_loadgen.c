@@ -0,0 +1,602 @@
+/**
+ * @file sfp_loadgen.c
+ * @brief Gerador de carga para o socket do sfp-daemon
+ *
+ * Abre N clientes Unix socket não bloqueantes num único loop epoll e
+ * dispara uma mistura configurável de comandos a uma taxa alvo, mais K
+ * clientes em SUBSCRIBE DYNAMIC. Todos usam FRAMING LENGTH, então cada
+ * resposta tem tamanho conhecido: corpo incompleto ao fechar a conexão ou
+ * que não termina em "}\n" conta como truncado.
+ *
+ * Com taxa alvo, o próximo envio de cada cliente segue um agendamento fixo
+ * (intervalo = clientes / taxa) e a latência é medida a partir do instante
+ * agendado, não do envio real: se o daemon atrasa, a espera entra na conta
+ * (sem "coordinated omission"). Sem taxa (-r 0), cada cliente manda o
+ * próximo comando assim que recebe a resposta.
+ *
+ * Saída: uma linha JSON por comando, uma com o total e uma com os
+ * assinantes.
+ *
+ * Uso: sfp-loadgen [-S socket] [-c clientes] [-r req/s] [-d segundos]
+ *                  [-m current=1,static=1,dynamic=1,state=1,fields=1,ping=1]
+ *                  [-s assinantes] [-t timeout_ms]
+ */
+
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define LOADGEN_DEFAULT_SOCKET "/run/sfp-daemon/sfp.sock"
+#define LOADGEN_MAX_CLIENTS 256
+#define LOADGEN_RX_SIZE (128 * 1024)
+
+/* ============================================
+ * Comandos
+ * ============================================ */
+typedef enum {
+    CMD_CURRENT,
+    CMD_STATIC,
+    CMD_DYNAMIC,
+    CMD_STATE,
+    CMD_FIELDS,
+    CMD_PING,
+    CMD_COUNT
+} command_t;
+
+static const struct {
+    const char *name;
+    const char *line;
+} k_commands[CMD_COUNT] = {
+    [CMD_CURRENT] = { "current", "GET CURRENT\n" },
+    [CMD_STATIC]  = { "static",  "GET STATIC\n" },
+    [CMD_DYNAMIC] = { "dynamic", "GET DYNAMIC\n" },
+    [CMD_STATE]   = { "state",   "GET STATE\n" },
+    [CMD_FIELDS]  = { "fields",  "GET FIELDS rx_power_dbm,temp_c\n" },
+    [CMD_PING]    = { "ping",    "PING\n" },
+};
+
+/* ============================================
+ * Estatísticas
+ * ============================================ */
+typedef struct {
+    uint64_t *data;
+    size_t len;
+    size_t cap;
+} samples_t;
+
+typedef struct {
+    uint64_t sent;
+    uint64_t ok;                /* STATUS 2xx/304 */
+    uint64_t errors;            /* Outros STATUS */
+    uint64_t timeouts;
+    uint64_t truncated;
+    uint64_t bytes;
+    samples_t latency_ns;
+} command_stats_t;
+
+typedef struct {
+    uint64_t events;
+    uint64_t seq_gaps;          /* Amostras puladas (seq não consecutivo) */
+    uint64_t truncated;
+    uint64_t bytes;
+} subscribe_stats_t;
+
+static command_stats_t g_stats[CMD_COUNT];
+static subscribe_stats_t g_sub;
+static uint64_t g_connect_errors;
+static uint64_t g_disconnects;
+
+static void samples_add(samples_t *s, uint64_t v)
+{
+    if (s->len == s->cap) {
+        size_t cap = s->cap ? s->cap * 2 : 4096;
+        uint64_t *data = realloc(s->data, cap * sizeof(uint64_t));
+        if (!data) {
+            return;
+        }
+        s->data = data;
+        s->cap = cap;
+    }
+    s->data[s->len++] = v;
+}
+
+/* ============================================
+ * Clientes
+ * ============================================ */
+typedef enum {
+    CLIENT_DEAD,
+    CLIENT_SETUP,               /* Esperando confirmação de FRAMING/SUBSCRIBE */
+    CLIENT_READY
+} client_phase_t;
+
+typedef struct {
+    int fd;
+    client_phase_t phase;
+    bool subscriber;
+    unsigned setup_pending;     /* Respostas de configuração ainda por vir */
+    bool pending;               /* Requisição em voo */
+    command_t command;
+    uint64_t sched_ns;          /* Instante agendado (base da latência) */
+    uint64_t sent_ns;
+    uint64_t next_ns;           /* Próximo envio agendado */
+    uint64_t last_seq;
+    size_t rx_len;
+    char rx[LOADGEN_RX_SIZE];
+} client_t;
+
+static client_t *g_clients;
+static unsigned g_num_clients;
+static int g_epoll_fd;
+static const char *g_socket_path = LOADGEN_DEFAULT_SOCKET;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static bool send_all(int fd, const char *data, size_t len)
+{
+    /* Comandos são curtos: cabem no buffer do socket numa chamada */
+    return send(fd, data, len, MSG_NOSIGNAL) == (ssize_t)len;
+}
+
+static void client_close(client_t *c)
+{
+    if (c->fd >= 0) {
+        epoll_ctl(g_epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+        close(c->fd);
+    }
+    c->fd = -1;
+    c->phase = CLIENT_DEAD;
+    c->pending = false;
+    c->rx_len = 0;
+}
+
+static bool client_open(client_t *c, uint64_t now)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    size_t path_len = strlen(g_socket_path);
+    if (path_len >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    memcpy(addr.sun_path, g_socket_path, path_len);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        return false;
+    }
+    /* Backlog cheio (daemon no limite de conexões) dá EAGAIN */
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        g_connect_errors++;
+        return false;
+    }
+
+    struct epoll_event ev = { .events = EPOLLIN | EPOLLRDHUP, .data.ptr = c };
+    if (epoll_ctl(g_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        close(fd);
+        return false;
+    }
+
+    c->fd = fd;
+    c->phase = CLIENT_SETUP;
+    c->pending = false;
+    c->rx_len = 0;
+    c->last_seq = 0;
+    c->next_ns = now;
+
+    const char *setup = c->subscriber ? "FRAMING LENGTH\nSUBSCRIBE DYNAMIC\n" : "FRAMING LENGTH\n";
+    c->setup_pending = c->subscriber ? 2 : 1;
+    if (!send_all(fd, setup, strlen(setup))) {
+        client_close(c);
+        return false;
+    }
+    c->sent_ns = now;
+    return true;
+}
+
+/* ============================================
+ * Mistura de Comandos
+ * ============================================ */
+static unsigned g_weights[CMD_COUNT] = { 1, 1, 1, 1, 1, 1 };
+static unsigned g_weight_total = CMD_COUNT;
+static uint64_t g_rng = 0x9E3779B97F4A7C15ull;
+
+static uint64_t rng_next(void)
+{
+    /* xorshift64 */
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 7;
+    g_rng ^= g_rng << 17;
+    return g_rng;
+}
+
+static command_t pick_command(void)
+{
+    unsigned r = (unsigned)(rng_next() % g_weight_total);
+    for (int i = 0; i < CMD_COUNT; i++) {
+        if (r < g_weights[i]) {
+            return (command_t)i;
+        }
+        r -= g_weights[i];
+    }
+    return CMD_PING;
+}
+
+/* "current=4,ping=1": comandos ausentes ficam com peso 0 */
+static bool parse_mix(const char *spec)
+{
+    unsigned weights[CMD_COUNT] = { 0 };
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", spec);
+
+    for (char *save = NULL, *tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        char *eq = strchr(tok, '=');
+        unsigned weight = 1;
+        if (eq) {
+            *eq = '\0';
+            weight = (unsigned)strtoul(eq + 1, NULL, 10);
+        }
+        int found = -1;
+        for (int i = 0; i < CMD_COUNT; i++) {
+            if (strcmp(tok, k_commands[i].name) == 0) {
+                found = i;
+            }
+        }
+        if (found < 0) {
+            fprintf(stderr, "sfp-loadgen: unknown command '%s' in mix\n", tok);
+            return false;
+        }
+        weights[found] = weight;
+    }
+
+    unsigned total = 0;
+    for (int i = 0; i < CMD_COUNT; i++) {
+        total += weights[i];
+    }
+    if (total == 0) {
+        fprintf(stderr, "sfp-loadgen: empty command mix\n");
+        return false;
+    }
+    memcpy(g_weights, weights, sizeof(g_weights));
+    g_weight_total = total;
+    return true;
+}
+
+/* ============================================
+ * Recepção
+ * ============================================ */
+
+/* Corpo de uma resposta completa deve ser JSON terminado em "}\n" */
+static bool body_complete(const char *body, size_t len)
+{
+    return len >= 2 && body[len - 1] == '\n' && body[len - 2] == '}';
+}
+
+static void handle_frame(client_t *c, const char *head, size_t head_len, const char *body, size_t body_len, uint64_t now)
+{
+    bool complete = body_complete(body, body_len);
+
+    if (head_len > 6 && strncmp(head, "EVENT ", 6) == 0) {
+        g_sub.events++;
+        g_sub.bytes += head_len + 1 + body_len;
+        if (!complete) {
+            g_sub.truncated++;
+        }
+        /* EVENT SAMPLE <seq> <len> */
+        unsigned long long seq;
+        if (sscanf(head, "EVENT SAMPLE %llu", &seq) == 1) {
+            if (c->last_seq != 0 && seq > c->last_seq + 1) {
+                g_sub.seq_gaps += seq - c->last_seq - 1;
+            }
+            c->last_seq = seq;
+        }
+        return;
+    }
+
+    if (c->setup_pending > 0) {
+        c->setup_pending--;
+        if (c->setup_pending == 0) {
+            c->phase = CLIENT_READY;
+        }
+        return;
+    }
+
+    if (!c->pending) {
+        return;
+    }
+    command_stats_t *st = &g_stats[c->command];
+    int code = 0;
+    sscanf(head, "STATUS %d", &code);
+    if (!complete) {
+        st->truncated++;
+    } else if ((code >= 200 && code < 300) || code == 304) {
+        st->ok++;
+    } else {
+        st->errors++;
+    }
+    st->bytes += head_len + 1 + body_len;
+    samples_add(&st->latency_ns, now - c->sched_ns);
+    c->pending = false;
+}
+
+static void client_read(client_t *c, uint64_t now)
+{
+    for (;;) {
+        if (c->rx_len == sizeof(c->rx)) {
+            /* Frame maior que o buffer: trata como truncado */
+            if (c->pending) {
+                g_stats[c->command].truncated++;
+            }
+            client_close(c);
+            return;
+        }
+        ssize_t n = recv(c->fd, c->rx + c->rx_len, sizeof(c->rx) - c->rx_len, 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (n <= 0) {
+            /* Fechou no meio de um frame ou com requisição em voo */
+            if (c->rx_len > 0) {
+                if (c->subscriber && !c->pending) {
+                    g_sub.truncated++;
+                } else if (c->pending) {
+                    g_stats[c->command].truncated++;
+                }
+            }
+            g_disconnects++;
+            client_close(c);
+            return;
+        }
+        c->rx_len += (size_t)n;
+    }
+
+    /* Consome os frames completos: "<cabeçalho> <tamanho>\n" + corpo */
+    size_t off = 0;
+    while (off < c->rx_len) {
+        char *nl = memchr(c->rx + off, '\n', c->rx_len - off);
+        if (!nl) {
+            break;
+        }
+        size_t head_len = (size_t)(nl - (c->rx + off));
+        char *space = NULL;
+        for (char *p = nl; p > c->rx + off; p--) {
+            if (p[-1] == ' ') {
+                space = p;
+                break;
+            }
+        }
+        size_t body_len = space ? (size_t)strtoul(space, NULL, 10) : 0;
+        if (off + head_len + 1 + body_len > c->rx_len) {
+            break;
+        }
+        *nl = '\0';
+        handle_frame(c, c->rx + off, head_len, nl + 1, body_len, now);
+        off += head_len + 1 + body_len;
+    }
+    memmove(c->rx, c->rx + off, c->rx_len - off);
+    c->rx_len -= off;
+}
+
+/* ============================================
+ * Relatório
+ * ============================================ */
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_us(const samples_t *s, double pct)
+{
+    if (s->len == 0) {
+        return 0.0;
+    }
+    size_t rank = (size_t)(pct / 100.0 * (double)s->len + 0.999999);
+    return (double)s->data[rank ? rank - 1 : 0] / 1000.0;
+}
+
+static void report(const char *name, command_stats_t *st, double seconds)
+{
+    qsort(st->latency_ns.data, st->latency_ns.len, sizeof(uint64_t), compare_u64);
+    printf("{\"command\":\"%s\",\"sent\":%llu,\"ok\":%llu,\"errors\":%llu,\"timeouts\":%llu,"
+           "\"truncated\":%llu,\"req_per_s\":%.1f,\"bytes\":%llu,"
+           "\"p50_us\":%.1f,\"p90_us\":%.1f,\"p99_us\":%.1f,\"p999_us\":%.1f,\"max_us\":%.1f}\n",
+           name, (unsigned long long)st->sent, (unsigned long long)st->ok,
+           (unsigned long long)st->errors, (unsigned long long)st->timeouts,
+           (unsigned long long)st->truncated, (double)st->latency_ns.len / seconds,
+           (unsigned long long)st->bytes,
+           percentile_us(&st->latency_ns, 50), percentile_us(&st->latency_ns, 90),
+           percentile_us(&st->latency_ns, 99), percentile_us(&st->latency_ns, 99.9),
+           percentile_us(&st->latency_ns, 100));
+}
+
+/* ============================================
+ * Main
+ * ============================================ */
+static void usage(void)
+{
+    fprintf(stderr,
+            "Usage: sfp-loadgen [-S socket] [-c clients] [-r req/s] [-d seconds]\n"
+            "                   [-m current=1,static=1,dynamic=1,state=1,fields=1,ping=1]\n"
+            "                   [-s subscribers] [-t timeout_ms]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned clients = 4;
+    unsigned subscribers = 0;
+    double rate = 0.0;
+    double duration = 10.0;
+    unsigned timeout_ms = 2000;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "S:c:r:d:m:s:t:h")) != -1) {
+        switch (opt) {
+            case 'S': g_socket_path = optarg; break;
+            case 'c': clients = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 'r': rate = strtod(optarg, NULL); break;
+            case 'd': duration = strtod(optarg, NULL); break;
+            case 'm':
+                if (!parse_mix(optarg)) {
+                    return 2;
+                }
+                break;
+            case 's': subscribers = (unsigned)strtoul(optarg, NULL, 10); break;
+            case 't': timeout_ms = (unsigned)strtoul(optarg, NULL, 10); break;
+            default: usage(); return 2;
+        }
+    }
+    if (clients + subscribers == 0 || clients + subscribers > LOADGEN_MAX_CLIENTS || duration <= 0) {
+        usage();
+        return 2;
+    }
+
+    g_num_clients = clients + subscribers;
+    g_clients = calloc(g_num_clients, sizeof(client_t));
+    g_epoll_fd = epoll_create1(0);
+    if (!g_clients || g_epoll_fd < 0) {
+        perror("sfp-loadgen");
+        return 1;
+    }
+
+    /* Intervalo entre envios de um mesmo cliente (0: sem pausa) */
+    uint64_t interval_ns = rate > 0 && clients > 0 ? (uint64_t)((double)clients * 1e9 / rate) : 0;
+
+    uint64_t start = now_ns();
+    for (unsigned i = 0; i < g_num_clients; i++) {
+        client_t *c = &g_clients[i];
+        c->fd = -1;
+        c->subscriber = i >= clients;
+        /* Espalha o primeiro envio para não sair tudo junto */
+        client_open(c, start);
+        c->next_ns = start + (clients ? interval_ns * i / clients : 0);
+    }
+
+    uint64_t end = start + (uint64_t)(duration * 1e9);
+    uint64_t timeout_ns = (uint64_t)timeout_ms * 1000000u;
+    struct epoll_event events[64];
+
+    for (;;) {
+        uint64_t now = now_ns();
+        if (now >= end) {
+            break;
+        }
+
+        /* Envios devidos, timeouts e reconexões */
+        uint64_t wake = end;
+        for (unsigned i = 0; i < g_num_clients; i++) {
+            client_t *c = &g_clients[i];
+            if (c->phase == CLIENT_DEAD) {
+                /* Reconecta a cada 100 ms */
+                if (now >= c->next_ns) {
+                    if (!client_open(c, now)) {
+                        c->next_ns = now + 100000000u;
+                    }
+                }
+                if (c->next_ns < wake) {
+                    wake = c->next_ns;
+                }
+                continue;
+            }
+
+            uint64_t waiting_since = c->pending ? c->sent_ns : c->phase == CLIENT_SETUP ? c->sent_ns : 0;
+            if (waiting_since && now - waiting_since > timeout_ns) {
+                if (c->pending) {
+                    g_stats[c->command].timeouts++;
+                }
+                client_close(c);
+                c->next_ns = now;
+                continue;
+            }
+            if (waiting_since && waiting_since + timeout_ns < wake) {
+                wake = waiting_since + timeout_ns;
+            }
+
+            if (c->phase != CLIENT_READY || c->subscriber || c->pending) {
+                continue;
+            }
+            if (now >= c->next_ns) {
+                c->command = pick_command();
+                c->sched_ns = interval_ns ? c->next_ns : now;
+                c->sent_ns = now;
+                c->pending = true;
+                c->next_ns += interval_ns;
+                if (!interval_ns) {
+                    c->next_ns = now;
+                }
+                g_stats[c->command].sent++;
+                const char *line = k_commands[c->command].line;
+                if (!send_all(c->fd, line, strlen(line))) {
+                    g_stats[c->command].errors++;
+                    g_disconnects++;
+                    client_close(c);
+                    c->next_ns = now;
+                }
+            } else if (c->next_ns < wake) {
+                wake = c->next_ns;
+            }
+        }
+
+        /* Arredonda para baixo: o resto abaixo de 1 ms é esperado em espera ativa,
+         * senão cada envio agendado sairia até 1 ms atrasado */
+        int wait_ms = wake > now ? (int)((wake - now) / 1000000) : 0;
+        int n = epoll_wait(g_epoll_fd, events, 64, wait_ms);
+        now = now_ns();
+        for (int i = 0; i < n; i++) {
+            client_t *c = events[i].data.ptr;
+            if (c->fd >= 0) {
+                client_read(c, now);
+            }
+        }
+    }
+
+    double seconds = (double)(now_ns() - start) / 1e9;
+
+    command_stats_t total = { 0 };
+    for (int i = 0; i < CMD_COUNT; i++) {
+        command_stats_t *st = &g_stats[i];
+        total.sent += st->sent;
+        total.ok += st->ok;
+        total.errors += st->errors;
+        total.timeouts += st->timeouts;
+        total.truncated += st->truncated;
+        total.bytes += st->bytes;
+        for (size_t j = 0; j < st->latency_ns.len; j++) {
+            samples_add(&total.latency_ns, st->latency_ns.data[j]);
+        }
+        if (st->sent) {
+            report(k_commands[i].name, st, seconds);
+        }
+    }
+    report("total", &total, seconds);
+
+    printf("{\"subscribe\":{\"clients\":%u,\"events\":%llu,\"events_per_s\":%.1f,\"seq_gaps\":%llu,"
+           "\"truncated\":%llu,\"bytes\":%llu},\"clients\":%u,\"target_rate\":%.1f,\"seconds\":%.3f,"
+           "\"connect_errors\":%llu,\"disconnects\":%llu}\n",
+           subscribers, (unsigned long long)g_sub.events, (double)g_sub.events / seconds,
+           (unsigned long long)g_sub.seq_gaps, (unsigned long long)g_sub.truncated,
+           (unsigned long long)g_sub.bytes, clients, rate, seconds,
+           (unsigned long long)g_connect_errors, (unsigned long long)g_disconnects);
+
+    for (unsigned i = 0; i < g_num_clients; i++) {
+        client_close(&g_clients[i]);
+    }
+    close(g_epoll_fd);
+    return 0;
+}
@@ -0,0 +1,385 @@
+/**
+ * @file sfp_tcomp_fit.c
+ * @brief Ajusta o modelo de compensação de temperatura do RX (rx_temp_comp=)
+ *
+ * Lê uma gravação de um módulo com potência óptica de entrada constante
+ * (ou com a potência de referência medida ao lado) enquanto a temperatura
+ * varia, e ajusta por mínimos quadrados
+ *
+ *   y = a + c1·x + c2·x² + c3·x³,  x = T - t_ref
+ *
+ * onde y é o RX lido pelo módulo em dBm (menos a referência, se houver).
+ * O termo a é a potência de entrada (ou o offset fixo, que é trabalho da
+ * tabela rx_cal) e fica fora do modelo: d(t_ref) = 0.
+ *
+ * Formatos de entrada, detectados por linha:
+ * - JSON do daemon (GET CURRENT/GET DYNAMIC ou SUBSCRIBE DYNAMIC, com ou
+ *   sem DELTA): usa "temp_c" e "rx_power_uw" (o valor do módulo, sem
+ *   rx_cal nem compensação); em DELTA vale o último valor visto de cada
+ *   campo. "vendor_pn" de GET CURRENT dispensa -p.
+ * - Colunas numéricas (vírgula, ponto e vírgula ou espaço):
+ *   temp_c rx_dbm [ref_dbm]. Linhas com '#' ou cabeçalho são ignoradas.
+ *
+ * Saída: a linha rx_temp_comp= pronta para o arquivo de configuração
+ * (stdout) e um resumo JSON do ajuste (stderr).
+ *
+ * Uso: sfp-tcomp-fit [-p vendor_pn] [-d grau 1-3] [-t t_ref] [arquivo]
+ */
+
+#define _DEFAULT_SOURCE
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TCOMP_MAX_DEGREE 3
+#define TCOMP_PN_SIZE 17
+#define TCOMP_MIN_SPAN_C 2.0
+
+typedef struct {
+    double temp_c;
+    double y_db;
+} point_t;
+
+static point_t *g_points = NULL;
+static size_t g_count = 0;
+static size_t g_cap = 0;
+
+static bool point_add(double temp_c, double y_db)
+{
+    if (!isfinite(temp_c) || !isfinite(y_db)) {
+        return true;
+    }
+    if (g_count == g_cap) {
+        size_t cap = g_cap ? g_cap * 2 : 4096;
+        point_t *p = realloc(g_points, cap * sizeof(*p));
+        if (!p) {
+            return false;
+        }
+        g_points = p;
+        g_cap = cap;
+    }
+    g_points[g_count].temp_c = temp_c;
+    g_points[g_count].y_db = y_db;
+    g_count++;
+    return true;
+}
+
+/* ============================================
+ * Leitura da Gravação
+ * ============================================ */
+
+/* Valor numérico de "key": na linha JSON */
+static bool json_number(const char *line, const char *key, double *out)
+{
+    const char *p = strstr(line, key);
+    if (!p) {
+        return false;
+    }
+    p += strlen(key);
+    char *end;
+    double v = strtod(p, &end);
+    if (end == p) {
+        return false;
+    }
+    *out = v;
+    return true;
+}
+
+static void json_string(const char *line, const char *key, char *out, size_t cap)
+{
+    const char *p = strstr(line, key);
+    if (!p) {
+        return;
+    }
+    p += strlen(key);
+    size_t len = strcspn(p, "\"");
+    if (p[len] != '"' || len == 0 || len >= cap) {
+        return;
+    }
+    memcpy(out, p, len);
+    out[len] = '\0';
+}
+
+typedef struct {
+    bool have_temp;
+    bool have_rx;
+    double temp_c;
+    double rx_uw;
+    bool has_ref;      /* Alguma linha de colunas trouxe ref_dbm */
+    char pn[TCOMP_PN_SIZE];
+} reader_t;
+
+static bool read_line(reader_t *r, const char *line)
+{
+    if (strchr(line, '{')) {
+        bool temp = json_number(line, "\"temp_c\":", &r->temp_c);
+        bool rx = json_number(line, "\"rx_power_uw\":", &r->rx_uw);
+        r->have_temp |= temp;
+        r->have_rx |= rx;
+        json_string(line, "\"vendor_pn\":\"", r->pn, sizeof(r->pn));
+
+        /* Sem luz não há o que compensar */
+        if ((temp || rx) && r->have_temp && r->have_rx && r->rx_uw > 0.0) {
+            return point_add(r->temp_c, 10.0 * log10(r->rx_uw / 1000.0));
+        }
+        return true;
+    }
+
+    const char *p = line;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p == '#' || *p == '\0' || *p == '\n' || *p == '\r') {
+        return true;
+    }
+
+    double v[3];
+    int n = 0;
+    while (n < 3) {
+        while (*p == ' ' || *p == '\t' || *p == ',' || *p == ';') p++;
+        char *end;
+        double x = strtod(p, &end);
+        if (end == p) {
+            break;
+        }
+        v[n++] = x;
+        p = end;
+    }
+    if (n < 2) {
+        return true;   /* Cabeçalho ou linha sem dados */
+    }
+    if (n == 3) {
+        r->has_ref = true;
+        return point_add(v[0], v[1] - v[2]);
+    }
+    return point_add(v[0], v[1]);
+}
+
+/* ============================================
+ * Ajuste
+ * ============================================ */
+
+/* Resolve A·b = rhs (eliminação de Gauss com pivoteamento parcial) */
+static bool solve(int n, double a[TCOMP_MAX_DEGREE + 1][TCOMP_MAX_DEGREE + 1],
+                  double rhs[TCOMP_MAX_DEGREE + 1], double b[TCOMP_MAX_DEGREE + 1])
+{
+    for (int col = 0; col < n; col++) {
+        int pivot = col;
+        for (int row = col + 1; row < n; row++) {
+            if (fabs(a[row][col]) > fabs(a[pivot][col])) {
+                pivot = row;
+            }
+        }
+        if (fabs(a[pivot][col]) < 1e-12) {
+            return false;
+        }
+        if (pivot != col) {
+            for (int k = 0; k < n; k++) {
+                double t = a[col][k];
+                a[col][k] = a[pivot][k];
+                a[pivot][k] = t;
+            }
+            double t = rhs[col];
+            rhs[col] = rhs[pivot];
+            rhs[pivot] = t;
+        }
+        for (int row = col + 1; row < n; row++) {
+            double f = a[row][col] / a[col][col];
+            for (int k = col; k < n; k++) {
+                a[row][k] -= f * a[col][k];
+            }
+            rhs[row] -= f * rhs[col];
+        }
+    }
+    for (int row = n - 1; row >= 0; row--) {
+        double s = rhs[row];
+        for (int k = row + 1; k < n; k++) {
+            s -= a[row][k] * b[k];
+        }
+        b[row] = s / a[row][row];
+    }
+    return true;
+}
+
+/*
+ * Ajusta a + c1·x + … + cd·x^d. x é escalado para |u| <= 1 antes das
+ * equações normais (x^6 em °C mal condiciona o sistema) e os coeficientes
+ * voltam para a escala de °C no fim.
+ */
+static bool fit(int degree, double t_ref, double *intercept, double coef[TCOMP_MAX_DEGREE])
+{
+    double scale = 0.0;
+    for (size_t i = 0; i < g_count; i++) {
+        double ax = fabs(g_points[i].temp_c - t_ref);
+        if (ax > scale) {
+            scale = ax;
+        }
+    }
+    if (scale <= 0.0) {
+        return false;
+    }
+
+    int n = degree + 1;
+    double a[TCOMP_MAX_DEGREE + 1][TCOMP_MAX_DEGREE + 1] = {{0}};
+    double rhs[TCOMP_MAX_DEGREE + 1] = {0};
+    for (size_t i = 0; i < g_count; i++) {
+        double u = (g_points[i].temp_c - t_ref) / scale;
+        double pw[2 * TCOMP_MAX_DEGREE + 1];
+        pw[0] = 1.0;
+        for (int k = 1; k <= 2 * degree; k++) {
+            pw[k] = pw[k - 1] * u;
+        }
+        for (int r = 0; r < n; r++) {
+            for (int c = 0; c < n; c++) {
+                a[r][c] += pw[r + c];
+            }
+            rhs[r] += pw[r] * g_points[i].y_db;
+        }
+    }
+
+    double b[TCOMP_MAX_DEGREE + 1];
+    if (!solve(n, a, rhs, b)) {
+        return false;
+    }
+    *intercept = b[0];
+    double s = 1.0;
+    for (int k = 1; k <= degree; k++) {
+        s *= scale;
+        coef[k - 1] = b[k] / s;
+    }
+    return true;
+}
+
+static double model(int degree, const double coef[TCOMP_MAX_DEGREE], double x)
+{
+    double d = 0.0;
+    for (int k = degree - 1; k >= 0; k--) {
+        d = (d + coef[k]) * x;
+    }
+    return d;
+}
+
+/* ============================================
+ * Main
+ * ============================================ */
+static void usage(void)
+{
+    fprintf(stderr,
+            "Usage: sfp-tcomp-fit [-p vendor_pn] [-d degree 1-3] [-t t_ref_c] [trace]\n"
+            "  trace: daemon JSON (temp_c, rx_power_uw) or columns temp_c rx_dbm [ref_dbm]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const char *pn = NULL;
+    int degree = 2;
+    bool have_t_ref = false;
+    double t_ref = 0.0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "p:d:t:h")) != -1) {
+        switch (opt) {
+            case 'p': pn = optarg; break;
+            case 'd': degree = atoi(optarg); break;
+            case 't': t_ref = strtod(optarg, NULL); have_t_ref = true; break;
+            default: usage(); return 2;
+        }
+    }
+    if (degree < 1 || degree > TCOMP_MAX_DEGREE || optind + 1 < argc) {
+        usage();
+        return 2;
+    }
+
+    FILE *fp = stdin;
+    if (optind < argc && strcmp(argv[optind], "-") != 0) {
+        fp = fopen(argv[optind], "r");
+        if (!fp) {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+
+    reader_t reader = {0};
+    char line[8192];
+    while (fgets(line, sizeof(line), fp)) {
+        if (!read_line(&reader, line)) {
+            fprintf(stderr, "sfp-tcomp-fit: out of memory\n");
+            return 1;
+        }
+    }
+    if (fp != stdin) {
+        fclose(fp);
+    }
+
+    if (!pn) {
+        pn = reader.pn[0] ? reader.pn : NULL;
+    }
+    if (!pn || strlen(pn) >= TCOMP_PN_SIZE || strpbrk(pn, " \t")) {
+        fprintf(stderr, "sfp-tcomp-fit: vendor PN missing or invalid (use -p; max 16 chars, no spaces)\n");
+        return 2;
+    }
+    if (g_count < (size_t)degree + 2) {
+        fprintf(stderr, "sfp-tcomp-fit: %zu samples, need at least %d\n", g_count, degree + 2);
+        return 1;
+    }
+
+    double t_min = g_points[0].temp_c;
+    double t_max = g_points[0].temp_c;
+    double t_sum = 0.0;
+    double y_sum = 0.0;
+    for (size_t i = 0; i < g_count; i++) {
+        double t = g_points[i].temp_c;
+        if (t < t_min) t_min = t;
+        if (t > t_max) t_max = t;
+        t_sum += t;
+        y_sum += g_points[i].y_db;
+    }
+    if (t_max - t_min < TCOMP_MIN_SPAN_C) {
+        fprintf(stderr, "sfp-tcomp-fit: temperature range %.2f..%.2f C too narrow (need %.0f C)\n",
+                t_min, t_max, TCOMP_MIN_SPAN_C);
+        return 1;
+    }
+    if (!have_t_ref) {
+        t_ref = t_sum / (double)g_count;
+    }
+
+    double intercept;
+    double coef[TCOMP_MAX_DEGREE] = {0};
+    if (!fit(degree, t_ref, &intercept, coef)) {
+        fprintf(stderr, "sfp-tcomp-fit: singular fit (degree %d too high for this trace?)\n", degree);
+        return 1;
+    }
+
+    /* Espalhamento antes e depois: mesmas unidades que o daemon corrige */
+    double y_mean = y_sum / (double)g_count;
+    double ss_before = 0.0;
+    double ss_after = 0.0;
+    double max_correction = 0.0;
+    for (size_t i = 0; i < g_count; i++) {
+        double x = g_points[i].temp_c - t_ref;
+        double d = model(degree, coef, x);
+        double y = g_points[i].y_db;
+        ss_before += (y - y_mean) * (y - y_mean);
+        ss_after += (y - intercept - d) * (y - intercept - d);
+        if (fabs(d) > max_correction) {
+            max_correction = fabs(d);
+        }
+    }
+
+    printf("rx_temp_comp=%s %.2f %.1f:%.1f", pn, t_ref, floor(t_min * 10.0) / 10.0, ceil(t_max * 10.0) / 10.0);
+    for (int k = 0; k < degree; k++) {
+        printf(" %.6g", coef[k]);
+    }
+    printf("\n");
+
+    fprintf(stderr,
+            "{\"samples\":%zu,\"degree\":%d,\"t_ref_c\":%.2f,\"t_min_c\":%.2f,\"t_max_c\":%.2f,"
+            "\"%s\":%.3f,\"rms_before_db\":%.4f,\"rms_after_db\":%.4f,\"max_correction_db\":%.3f}\n",
+            g_count, degree, t_ref, t_min, t_max,
+            reader.has_ref ? "offset_db" : "rx_dbm_at_ref", intercept,
+            sqrt(ss_before / (double)g_count), sqrt(ss_after / (double)g_count), max_correction);
+
+    free(g_points);
+    return 0;
+}